@@ -0,0 +1,75 @@
+#include <stdint.h> // for SIZE_MAX
+#include <stdlib.h> // for malloc, free
+#include <string.h> // for memset
+
+#include "arena.h"
+#include "error.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT  16
+
+static size_t AlignUp(size_t n) {
+  return (n + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaBlock *NewArenaBlock(ArenaBlock *prev, size_t at_least) {
+  size_t capacity = (at_least > ARENA_BLOCK_SIZE) ? at_least : ARENA_BLOCK_SIZE;
+
+  ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+  if (block == NULL) COMPILER_ERROR("NewArenaBlock(): Out of memory");
+
+  block->prev = prev;
+  block->used = 0;
+  block->capacity = capacity;
+
+  return block;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size) {
+  size = AlignUp((size == 0) ? 1 : size);
+
+  ArenaBlock *block = arena->current;
+  if (block == NULL || block->capacity - block->used < size) {
+    block = NewArenaBlock(block, size);
+    arena->current = block;
+  }
+
+  void *result = block->data + block->used;
+  block->used += size;
+
+  return result;
+}
+
+void *ArenaCalloc(Arena *arena, size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    COMPILER_ERROR("ArenaCalloc(): Allocation size overflows");
+  }
+
+  void *result = ArenaAlloc(arena, count * size);
+  memset(result, 0, count * size);
+
+  return result;
+}
+
+ArenaMark GetArenaMark(Arena *arena) {
+  return (ArenaMark){
+    .block = arena->current,
+    .used = (arena->current != NULL) ? arena->current->used : 0,
+  };
+}
+
+void ResetArenaTo(Arena *arena, ArenaMark mark) {
+  while (arena->current != mark.block) {
+    if (arena->current == NULL) COMPILER_ERROR("ResetArenaTo(): Mark doesn't belong to this arena");
+
+    ArenaBlock *prev = arena->current->prev;
+    free(arena->current);
+    arena->current = prev;
+  }
+
+  if (arena->current != NULL) arena->current->used = mark.used;
+}
+
+void FreeArena(Arena *arena) {
+  ResetArenaTo(arena, (ArenaMark){0});
+}
@@ -0,0 +1,36 @@
+/* Region allocator for values that don't outlive a function call.
+ *
+ * Allocations are bumped out of a chain of blocks. A caller takes an
+ * ArenaMark before running a function body and resets the arena to it
+ * afterwards, which releases everything allocated in between at once.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h> // for size_t
+
+typedef struct ArenaBlock {
+  struct ArenaBlock *prev;
+  size_t used;
+  size_t capacity;
+  unsigned char data[];
+} ArenaBlock;
+
+typedef struct {
+  ArenaBlock *current;
+} Arena;
+
+typedef struct {
+  ArenaBlock *block;
+  size_t used;
+} ArenaMark;
+
+void *ArenaAlloc(Arena *arena, size_t size);
+void *ArenaCalloc(Arena *arena, size_t count, size_t size);
+
+ArenaMark GetArenaMark(Arena *arena);
+void ResetArenaTo(Arena *arena, ArenaMark mark);
+void FreeArena(Arena *arena);
+
+#endif
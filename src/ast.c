@@ -1,9 +1,14 @@
-#include <stdlib.h> // for calloc
+#include <stdlib.h> // for calloc, free
 
 #include "ast.h"
 #include "common.h"
+#include "dynamic_array.h"
 #include "error.h"
 
+typedef AST_Node* NodePtr;
+
+USE_DYNAMIC_ARRAY(NodePtr)
+
 static const char* const _NodeTypeTranslation[] =
 {
   [UNTYPED_NODE] = "UNTYPED",
@@ -25,6 +30,7 @@ static const char* const _NodeTypeTranslation[] =
   [ENUM_ASSIGNMENT_NODE] = "Enum Assignment",
 
   [ARRAY_SUBSCRIPT_NODE] = "Array Subscript",
+  [ARRAY_SLICE_NODE] = "Array Slice",
   [ARRAY_INITIALIZER_LIST_NODE] = "Array Initializer List",
 
   [IF_NODE] = "If",
@@ -40,6 +46,7 @@ static const char* const _NodeTypeTranslation[] =
   [FUNCTION_BODY_NODE] = "Fn Body",
   [FUNCTION_CALL_NODE] = "Fn Call",
   [FUNCTION_ARGUMENT_NODE] = "Fn Argument",
+  [BUILTIN_CALL_NODE] = "Builtin Call",
 
   [UNARY_OP_NODE] = "Unary",
   [BINARY_LOGICAL_NODE] = "Binary (Logical)",
@@ -98,10 +105,82 @@ AST_Node *NewNodeFromSymbol(NodeType node_type, AST_Node *left, AST_Node *middle
   return n;
 }
 
+/* Frees the node and everything under it. Values held by nodes are
+ * interned literals or constant data, which outlive the AST, and
+ * types share their parameter and member lists with the symbol table,
+ * so only the nodes themselves are freed. Like VisitNodes(), it keeps
+ * its own stack rather than recursing down a long statement chain */
+void FreeAST(AST_Node *root) {
+  DA(NodePtr) stack;
+  DA_INIT(NodePtr, stack);
+  if (root != NULL) DA_ADD(NodePtr, stack, root);
+
+  while (stack.count > 0) {
+    AST_Node *n = stack.data[--stack.count];
+
+    if (n->right != NULL)  DA_ADD(NodePtr, stack, n->right);
+    if (n->middle != NULL) DA_ADD(NodePtr, stack, n->middle);
+    if (n->left != NULL)   DA_ADD(NodePtr, stack, n->left);
+
+    free(n);
+  }
+
+  DA_FREE(NodePtr, stack);
+}
+
+/* A program is a chain of statements down the right, as deep as it is
+ * long, so this keeps its own stack instead of recursing */
+void VisitNodes(AST_Node *root, NodeVisitor visit, void *context) {
+  DA(NodePtr) stack;
+  DA_INIT(NodePtr, stack);
+  if (root != NULL) DA_ADD(NodePtr, stack, root);
+
+  while (stack.count > 0) {
+    AST_Node *n = stack.data[--stack.count];
+    visit(n, context);
+
+    // Pushed last, popped first
+    if (n->right != NULL)  DA_ADD(NodePtr, stack, n->right);
+    if (n->middle != NULL) DA_ADD(NodePtr, stack, n->middle);
+    if (n->left != NULL)   DA_ADD(NodePtr, stack, n->left);
+  }
+
+  DA_FREE(NodePtr, stack);
+}
+
+static void Number(AST_Node *n, void *next) {
+  n->slot = (*(int *)next)++;
+}
+
+int NumberNodes(AST_Node *root, int first) {
+  VisitNodes(root, Number, &first);
+  return first;
+}
+
+// Numbering is preorder, so the last node is down the rightmost path
+int EndSlot(AST_Node *root) {
+  for (;;) {
+    AST_Node *last = (root->right != NULL)  ? root->right
+                   : (root->middle != NULL) ? root->middle
+                                            : root->left;
+    if (last == NULL) return root->slot + 1;
+
+    root = last;
+  }
+}
+
 void SetNodeDataType(AST_Node *node, Type t) {
   node->data_type = t;
 }
 
+void AddNodeFact(AST_Node *node, NodeFact f) {
+  node->facts |= f;
+}
+
+bool NodeHasFact(AST_Node *node, NodeFact f) {
+  return (node->facts & f) != 0;
+}
+
 static void PrintASTRecurse(AST_Node *node, int depth, int unindent) {
   #define NUM_INDENT_SPACES 4
 
@@ -216,6 +295,10 @@ bool NodeIs_ArraySubscript(AST_Node *n) {
   return n->node_type == ARRAY_SUBSCRIPT_NODE;
 }
 
+bool NodeIs_ArraySlice(AST_Node *n) {
+  return n->node_type == ARRAY_SLICE_NODE;
+}
+
 bool NodeIs_ArrayInitializerList(AST_Node *n) {
   return n->node_type == ARRAY_INITIALIZER_LIST_NODE;
 }
@@ -260,6 +343,10 @@ bool NodeIs_Function(AST_Node *n) {
   return n->node_type == FUNCTION_NODE;
 }
 
+bool NodeIs_BuiltinCall(AST_Node *n) {
+  return n->node_type == BUILTIN_CALL_NODE;
+}
+
 bool NodeIs_Return(AST_Node *n) {
   return n->node_type == RETURN_NODE;
 }
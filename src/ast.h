@@ -2,6 +2,7 @@
 #define AST_H
 
 #include <stdbool.h>
+#include <stdint.h> // for int64_t
 
 #include "error.h"
 #include "symbol_table.h"
@@ -31,6 +32,7 @@ typedef enum {
   ENUM_ASSIGNMENT_NODE, // e.g. Monday = 5
 
   ARRAY_SUBSCRIPT_NODE,
+  ARRAY_SLICE_NODE, // 'a[lo..hi]', the bounds are subscript nodes, NULL when left out
   ARRAY_INITIALIZER_LIST_NODE,
 
   IF_NODE,
@@ -47,6 +49,7 @@ typedef enum {
   FUNCTION_BODY_NODE,
   FUNCTION_CALL_NODE,
   FUNCTION_ARGUMENT_NODE,
+  BUILTIN_CALL_NODE, // sum(), min(), max(), see builtins.c
 
   UNARY_OP_NODE,
   BINARY_LOGICAL_NODE,
@@ -61,11 +64,30 @@ typedef enum {
   NODE_TYPE_COUNT
 } NodeType;
 
+/* Facts established about a node by analysis passes, see range_analysis.c,
+ * escape_analysis.c and constant_data.c */
+typedef enum {
+  FACT_IN_BOUNDS     = 1 << 0, // Array subscript can't fall outside the array
+  FACT_NO_OVERFLOW   = 1 << 1, // Integer operation can't overflow its type
+  FACT_NO_ESCAPE     = 1 << 2, // Value can't outlive its function call
+  FACT_CONSTANT_DATA = 1 << 3, // Value was computed at compile time
+} NodeFact;
+
+typedef struct {
+  bool known;
+  int64_t min;
+  int64_t max;
+} ValueRange;
+
 typedef struct AST_Node {
   NodeType node_type;
   Token token;
   Type  data_type;
-  Value value;
+  Value value; // what compiling computed, see isolate.h for runtime values
+
+  ValueRange range;
+  unsigned int facts;
+  int slot; // where an isolate keeps this node's runtime value
 
   struct AST_Node *left;
   struct AST_Node *middle;
@@ -75,8 +97,20 @@ typedef struct AST_Node {
 AST_Node *NewNode(NodeType node_type, AST_Node *left, AST_Node *middle, AST_Node *right, Type type);
 AST_Node *NewNodeFromToken(NodeType node_type, AST_Node *left, AST_Node *middle, AST_Node *right, Token token, Type type);
 AST_Node *NewNodeFromSymbol(NodeType node_type, AST_Node *left, AST_Node *middle, AST_Node *right, Symbol symbol);
+void FreeAST(AST_Node *root);
+
+// Calls 'visit' on every node under 'root', in preorder
+typedef void (*NodeVisitor)(AST_Node *n, void *context);
+void VisitNodes(AST_Node *root, NodeVisitor visit, void *context);
+
+// Gives every node under 'root' a slot, counting up from 'first'.
+// Returns the next free slot
+int NumberNodes(AST_Node *root, int first);
+int EndSlot(AST_Node *root); // one past the last slot under 'root'
 
 void SetNodeDataType(AST_Node *node, Type t);
+void AddNodeFact(AST_Node *node, NodeFact f);
+bool NodeHasFact(AST_Node *node, NodeFact f);
 
 const char *NodeTypeTranslation(NodeType t);
 
@@ -88,6 +122,7 @@ bool NodeIs_Untyped(AST_Node *n);
 bool NodeIs_Start(AST_Node *n);
 bool NodeIs_Chain(AST_Node *n);
 bool NodeIs_ArraySubscript(AST_Node *n);
+bool NodeIs_ArraySlice(AST_Node *n);
 bool NodeIs_ArrayInitializerList(AST_Node *n);
 bool NodeIs_Identifier(AST_Node *n);
 bool NodeIs_TerseAssignment(AST_Node *n);
@@ -100,6 +135,7 @@ bool NodeIs_If(AST_Node *n);
 bool NodeIs_For(AST_Node *n);
 bool NodeIs_While(AST_Node *n);
 bool NodeIs_Function(AST_Node *n);
+bool NodeIs_BuiltinCall(AST_Node *n);
 bool NodeIs_Return(AST_Node *n);
 bool NodeIs_PrefixIncrement(AST_Node *n);
 bool NodeIs_PrefixDecrement(AST_Node *n);
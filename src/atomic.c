@@ -0,0 +1,115 @@
+#include <stdbool.h>
+#include <string.h> // for strncmp
+
+#include "atomic.h"
+#include "error.h"
+
+/* === Bits === */
+static bool Is64(const AtomicValue *a) {
+  return a->type == T_I64 || a->type == T_U64;
+}
+
+static uint64_t ToBits(const AtomicValue *a, Value v) {
+  switch (a->type) {
+    case T_I32:  return (uint32_t)(int32_t)v.as.integer;
+    case T_U32:  return (uint32_t)v.as.uinteger;
+    case T_BOOL: return v.as.boolean ? 1 : 0;
+    case T_I64:  return (uint64_t)v.as.integer;
+    default:     return v.as.uinteger;
+  }
+}
+
+static Value FromBits(const AtomicValue *a, uint64_t bits) {
+  Value v;
+  switch (a->type) {
+    case T_I32:  v = NewIntValue((int32_t)(uint32_t)bits); break;
+    case T_I64:  v = NewIntValue((int64_t)bits);           break;
+    case T_BOOL: v = NewBoolValue(bits != 0);              break;
+    default:     v = NewUintValue(bits);                   break;
+  }
+
+  v.type.specifier = a->type;
+  return v;
+}
+
+// A failed compare_exchange only loads, so it can't have release semantics
+static memory_order FailureOrder(memory_order order) {
+  if (order == memory_order_release) return memory_order_relaxed;
+  if (order == memory_order_acq_rel) return memory_order_acquire;
+  return order;
+}
+
+/* === Atomics === */
+AtomicValue *NewAtomicValue(Type atomic_type) {
+  AtomicValue *a = NewHeapObject(HEAP_ATOMIC, sizeof(AtomicValue));
+  a->type = atomic_type.value_specifier;
+
+  if (Is64(a)) {
+    atomic_init(&a->as.bits64, 0);
+  } else {
+    atomic_init(&a->as.bits32, 0);
+  }
+
+  return a;
+}
+
+memory_order MemoryOrderOf(Token order) {
+  static const struct {
+    const char *name;
+    memory_order order;
+  } orders[] = {
+    { "relaxed", memory_order_relaxed },
+    { "acquire", memory_order_acquire },
+    { "release", memory_order_release },
+    { "seq_cst", memory_order_seq_cst },
+  };
+
+  for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); i++) {
+    if (strlen(orders[i].name) == (size_t)order.length &&
+        strncmp(orders[i].name, order.position_in_source, order.length) == 0) {
+      return orders[i].order;
+    }
+  }
+
+  COMPILER_ERROR_FMTMSG("MemoryOrderOf(): '%.*s' is not a memory order", order.length, order.position_in_source);
+  return memory_order_seq_cst;
+}
+
+Value AtomicLoad(AtomicValue *a, memory_order order) {
+  uint64_t bits = (Is64(a)) ? atomic_load_explicit(&a->as.bits64, order)
+                            : atomic_load_explicit(&a->as.bits32, order);
+  return FromBits(a, bits);
+}
+
+void AtomicStore(AtomicValue *a, Value v, memory_order order) {
+  if (Is64(a)) {
+    atomic_store_explicit(&a->as.bits64, ToBits(a, v), order);
+  } else {
+    atomic_store_explicit(&a->as.bits32, (uint32_t)ToBits(a, v), order);
+  }
+}
+
+// Unsigned addition wraps the same way two's complement signed addition does
+Value AtomicFetchAdd(AtomicValue *a, Value v, memory_order order) {
+  uint64_t bits = (Is64(a)) ? atomic_fetch_add_explicit(&a->as.bits64, ToBits(a, v), order)
+                            : atomic_fetch_add_explicit(&a->as.bits32, (uint32_t)ToBits(a, v), order);
+  return FromBits(a, bits);
+}
+
+Value AtomicFetchOr(AtomicValue *a, Value v, memory_order order) {
+  uint64_t bits = (Is64(a)) ? atomic_fetch_or_explicit(&a->as.bits64, ToBits(a, v), order)
+                            : atomic_fetch_or_explicit(&a->as.bits32, (uint32_t)ToBits(a, v), order);
+  return FromBits(a, bits);
+}
+
+Value AtomicCompareExchange(AtomicValue *a, Value expected, Value desired, memory_order order) {
+  if (Is64(a)) {
+    uint64_t found = ToBits(a, expected);
+    atomic_compare_exchange_strong_explicit(&a->as.bits64, &found, ToBits(a, desired), order, FailureOrder(order));
+    return FromBits(a, found);
+  }
+
+  uint32_t found = (uint32_t)ToBits(a, expected);
+  atomic_compare_exchange_strong_explicit(&a->as.bits32, &found, (uint32_t)ToBits(a, desired), order, FailureOrder(order));
+  return FromBits(a, found);
+}
@@ -0,0 +1,50 @@
+/* Runtime values of 'atomic<T>', for i32, i64, u32, u64 and bool.
+ *
+ * Every operation goes through C11 <stdatomic.h> with the memory
+ * order the program asked for, so each one lowers to the machine's
+ * own atomic instruction (a plain load or store, 'lock xadd', 'lock
+ * cmpxchg', ...). 32-bit types and bools are kept in 32 bits, the
+ * rest in 64; a bool only ever holds 0 or 1.
+ *
+ * An atomic variable is given its AtomicValue when it is declared,
+ * so everything that shares it sees the same one from the start. It
+ * can't be copied or assigned, only reached through the builtins or a
+ * ref parameter, see AtomicBuiltin() in type_checker.c.
+ */
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "heap.h"
+#include "token.h"
+#include "value.h"
+
+typedef struct AtomicValue {
+  HeapObject header;
+  enum TypeSpecifier type;
+  union {
+    _Atomic uint32_t bits32;
+    _Atomic uint64_t bits64;
+  } as;
+} AtomicValue;
+
+AtomicValue *NewAtomicValue(Type atomic_type);
+
+// 'relaxed', 'acquire', 'release' or 'seq_cst'
+memory_order MemoryOrderOf(Token order);
+
+Value AtomicLoad(AtomicValue *a, memory_order order);
+void AtomicStore(AtomicValue *a, Value v, memory_order order);
+
+// These return the value from before the operation
+Value AtomicFetchAdd(AtomicValue *a, Value v, memory_order order);
+Value AtomicFetchOr(AtomicValue *a, Value v, memory_order order);
+
+// Stores 'desired' if the value is 'expected'. Either way, returns
+// the value it found, so it succeeded if that equals 'expected'
+Value AtomicCompareExchange(AtomicValue *a, Value expected, Value desired, memory_order order);
+
+#endif
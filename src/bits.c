@@ -0,0 +1,208 @@
+#include <pthread.h>   // for pthread_once
+#include <stdatomic.h> // for atomic_bool
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bits.h"
+#include "error.h"
+
+#if defined(__x86_64__)
+  #include <immintrin.h> // for _pext_u64, _pdep_u64
+  #define HAVE_X86_BIT_INSTRUCTIONS 1
+#else
+  #define HAVE_X86_BIT_INSTRUCTIONS 0
+#endif
+
+typedef uint64_t (*BitCount)(uint64_t x);
+typedef uint64_t (*BitScatter)(uint64_t x, uint64_t mask);
+
+typedef struct {
+  BitCount popcount;
+  BitCount leading_zeros;  // only called with x != 0
+  BitCount trailing_zeros; // only called with x != 0
+  BitScatter extract;
+  BitScatter deposit;
+} BitFunctions;
+
+/* === Portable Versions === */
+static uint64_t PopCount_Portable(uint64_t x) {
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (x * 0x0101010101010101ULL) >> 56;
+}
+
+static uint64_t LeadingZeros_Portable(uint64_t x) {
+  uint64_t n = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if ((x >> (64 - shift)) == 0) {
+      n += shift;
+      x <<= shift;
+    }
+  }
+
+  return n;
+}
+
+static uint64_t TrailingZeros_Portable(uint64_t x) {
+  return PopCount_Portable((x & -x) - 1);
+}
+
+static uint64_t Extract_Portable(uint64_t x, uint64_t mask) {
+  uint64_t result = 0;
+  for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+    uint64_t lowest = mask & -mask;
+    if (x & lowest) result |= bit;
+    mask ^= lowest;
+  }
+
+  return result;
+}
+
+static uint64_t Deposit_Portable(uint64_t x, uint64_t mask) {
+  uint64_t result = 0;
+  for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+    uint64_t lowest = mask & -mask;
+    if (x & bit) result |= lowest;
+    mask ^= lowest;
+  }
+
+  return result;
+}
+
+/* === Hardware Versions === */
+#if HAVE_X86_BIT_INSTRUCTIONS
+__attribute__((target("popcnt")))
+static uint64_t PopCount_POPCNT(uint64_t x) {
+  return __builtin_popcountll(x);
+}
+
+__attribute__((target("lzcnt")))
+static uint64_t LeadingZeros_LZCNT(uint64_t x) {
+  return __builtin_clzll(x);
+}
+
+__attribute__((target("bmi")))
+static uint64_t TrailingZeros_TZCNT(uint64_t x) {
+  return __builtin_ctzll(x);
+}
+
+__attribute__((target("bmi2")))
+static uint64_t Extract_PEXT(uint64_t x, uint64_t mask) {
+  return _pext_u64(x, mask);
+}
+
+__attribute__((target("bmi2")))
+static uint64_t Deposit_PDEP(uint64_t x, uint64_t mask) {
+  return _pdep_u64(x, mask);
+}
+#endif
+
+/* === Dispatch === */
+static const BitFunctions portable_functions = {
+  .popcount       = PopCount_Portable,
+  .leading_zeros  = LeadingZeros_Portable,
+  .trailing_zeros = TrailingZeros_Portable,
+  .extract        = Extract_Portable,
+  .deposit        = Deposit_Portable,
+};
+
+// Filled in once by whichever thread gets there first
+static BitFunctions native_functions;
+static pthread_once_t detection = PTHREAD_ONCE_INIT;
+static atomic_bool use_portable;
+
+static void DetectBitInstructions() {
+  native_functions = portable_functions;
+
+#if HAVE_X86_BIT_INSTRUCTIONS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt")) native_functions.popcount       = PopCount_POPCNT;
+  if (__builtin_cpu_supports("abm"))    native_functions.leading_zeros  = LeadingZeros_LZCNT;
+  if (__builtin_cpu_supports("bmi"))    native_functions.trailing_zeros = TrailingZeros_TZCNT;
+  if (__builtin_cpu_supports("bmi2")) {
+    native_functions.extract = Extract_PEXT;
+    native_functions.deposit = Deposit_PDEP;
+  }
+#endif
+}
+
+static const BitFunctions *Functions() {
+  if (atomic_load(&use_portable)) return &portable_functions;
+
+  pthread_once(&detection, DetectBitInstructions);
+  return &native_functions;
+}
+
+void UsePortableBitIntrinsics(bool portable) {
+  atomic_store(&use_portable, portable);
+}
+
+/* === Intrinsics === */
+bool IsBitIntrinsic(Builtin b) {
+  switch (b) {
+    case BUILTIN_POPCOUNT:
+    case BUILTIN_CLZ:
+    case BUILTIN_CTZ:
+    case BUILTIN_BSWAP:
+    case BUILTIN_PARITY:
+    case BUILTIN_ROTL:
+    case BUILTIN_ROTR:
+    case BUILTIN_PEXT:
+    case BUILTIN_PDEP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static int Width(Type t) {
+  switch (t.specifier) {
+    case T_U8:  return 8;
+    case T_U16: return 16;
+    case T_U32: return 32;
+    default:    return 64;
+  }
+}
+
+static uint64_t RotateLeft(uint64_t x, uint64_t n, int width) {
+  n %= width;
+  if (n == 0) return x;
+
+  return (x << n) | (x >> (width - n));
+}
+
+static uint64_t ByteSwap(uint64_t x, int width) {
+  switch (width) {
+    case 8:  return x;
+    case 16: return __builtin_bswap16((uint16_t)x);
+    case 32: return __builtin_bswap32((uint32_t)x);
+    default: return __builtin_bswap64(x);
+  }
+}
+
+Value ApplyBitIntrinsic(Builtin b, Type operand_type, uint64_t x, uint64_t y) {
+  const BitFunctions *bits = Functions();
+
+  int width = Width(operand_type);
+  uint64_t mask = (width == 64) ? UINT64_MAX : (1ULL << width) - 1;
+  x &= mask;
+
+  uint64_t result = 0;
+  switch (b) {
+    case BUILTIN_POPCOUNT: result = bits->popcount(x); break;
+    case BUILTIN_CLZ:      result = (x == 0) ? (uint64_t)width : bits->leading_zeros(x) - (64 - width); break;
+    case BUILTIN_CTZ:      result = (x == 0) ? (uint64_t)width : bits->trailing_zeros(x); break;
+    case BUILTIN_BSWAP:    result = ByteSwap(x, width); break;
+    case BUILTIN_ROTL:     result = RotateLeft(x, y, width); break;
+    case BUILTIN_ROTR:     result = RotateLeft(x, width - (y % width), width); break;
+    case BUILTIN_PEXT:     result = bits->extract(x, y & mask); break;
+    case BUILTIN_PDEP:     result = bits->deposit(x, y & mask); break;
+    case BUILTIN_PARITY:   return NewBoolValue(bits->popcount(x) & 1);
+    default: COMPILER_ERROR("ApplyBitIntrinsic(): Not a bit intrinsic");
+  }
+
+  Value v = NewUintValue(result & mask);
+  v.type = operand_type;
+  return v;
+}
@@ -0,0 +1,39 @@
+/* Bit manipulation builtins: popcount(), clz(), ctz(), bswap(),
+ * parity(), rotl(), rotr(), pext() and pdep().
+ *
+ * Each one works on an unsigned integer of the argument's width, so
+ * clz() of a u8 counts from bit 7 and bswap() of a u16 swaps two
+ * bytes. pext() and pdep() take a mask of the same type as the value,
+ * and the rotates an unsigned amount of any width. Integer literal
+ * arguments are taken as u64, except next to a pext() or pdep()
+ * argument of another type, which they take instead.
+ *
+ * Counting and pext()/pdep() use POPCNT, LZCNT, TZCNT, PEXT and PDEP
+ * when the running CPU has them, and plain C otherwise. The CPU is
+ * checked once, by the first thread to need it. bswap() and the
+ * rotates compile to BSWAP and ROL/ROR everywhere, so they need no
+ * dispatch.
+ *
+ * Calls whose arguments are all literals are folded by the type
+ * checker and never run.
+ */
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "builtins.h"
+#include "value.h"
+
+bool IsBitIntrinsic(Builtin b);
+
+// 'x' and 'y' are the arguments as raw bits of the operand type. The
+// result has the operand type, except for parity(), which is a bool
+Value ApplyBitIntrinsic(Builtin b, Type operand_type, uint64_t x, uint64_t y);
+
+// For testing the portable versions on a CPU that has the instructions
+void UsePortableBitIntrinsics(bool portable);
+
+#endif
@@ -0,0 +1,106 @@
+#include <string.h> // for strlen, strncmp
+
+#include "builtins.h"
+
+static const struct {
+  const char *name;
+  int arity;
+} Builtins[] = {
+  [BUILTIN_NONE] = { "",    0 },
+
+  [BUILTIN_SUM]  = { "sum", 1 },
+  [BUILTIN_MIN]  = { "min", 1 },
+  [BUILTIN_MAX]  = { "max", 1 },
+
+  [BUILTIN_FIND]     = { "find",     2 },
+  [BUILTIN_CONTAINS] = { "contains", 2 },
+
+  [BUILTIN_INCLUDE_BYTES] = { "include_bytes", 1 },
+
+  [BUILTIN_POPCOUNT] = { "popcount", 1 },
+  [BUILTIN_CLZ]      = { "clz",      1 },
+  [BUILTIN_CTZ]      = { "ctz",      1 },
+  [BUILTIN_BSWAP]    = { "bswap",    1 },
+  [BUILTIN_PARITY]   = { "parity",   1 },
+  [BUILTIN_ROTL]     = { "rotl",     2 },
+  [BUILTIN_ROTR]     = { "rotr",     2 },
+  [BUILTIN_PEXT]     = { "pext",     2 },
+  [BUILTIN_PDEP]     = { "pdep",     2 },
+
+  [BUILTIN_SHUFFLE] = { "shuffle", 2 },
+  [BUILTIN_LOAD]    = { "load",    3 },
+  [BUILTIN_STORE]   = { "store",   3 },
+
+  [BUILTIN_INSERT]        = { "insert",   3 },
+  [BUILTIN_GET]           = { "get",      2 },
+  [BUILTIN_REMOVE]        = { "remove",   2 },
+  [BUILTIN_RESERVE]       = { "reserve",  2 },
+  [BUILTIN_ELEMENT_COUNT] = { "count",    1 },
+  [BUILTIN_KEY_AT]        = { "key_at",   2 },
+  [BUILTIN_VALUE_AT]      = { "value_at", 2 },
+
+  [BUILTIN_PUSH]     = { "push",     2 },
+  [BUILTIN_POP]      = { "pop",      1 },
+  [BUILTIN_SHRINK]   = { "shrink",   1 },
+  [BUILTIN_CAPACITY] = { "capacity", 1 },
+  [BUILTIN_TO_VEC]   = { "to_vec",   1 },
+  [BUILTIN_TO_ARRAY] = { "to_array", 2 },
+
+  [BUILTIN_FETCH_ADD]        = { "fetch_add",        3 },
+  [BUILTIN_FETCH_OR]         = { "fetch_or",         3 },
+  [BUILTIN_COMPARE_EXCHANGE] = { "compare_exchange", 4 },
+
+  [BUILTIN_SEND]       = { "send",       2 },
+  [BUILTIN_TRY_SEND]   = { "try_send",   2 },
+  [BUILTIN_RECV]       = { "recv",       2 },
+  [BUILTIN_TRY_RECV]   = { "try_recv",   2 },
+  [BUILTIN_CLOSE]      = { "close",      1 },
+  [BUILTIN_SEND_BATCH] = { "send_batch", 2 },
+  [BUILTIN_RECV_BATCH] = { "recv_batch", 2 },
+};
+
+Builtin LookupBuiltin(Token name) {
+  if (name.type != IDENTIFIER) return BUILTIN_NONE;
+
+  for (int b = BUILTIN_NONE + 1; b < BUILTIN_COUNT; b++) {
+    if (strlen(Builtins[b].name) == (size_t)name.length &&
+        strncmp(Builtins[b].name, name.position_in_source, name.length) == 0) {
+      return (Builtin)b;
+    }
+  }
+
+  return BUILTIN_NONE;
+}
+
+const char *BuiltinName(Builtin b) {
+  if (b <= BUILTIN_NONE || b >= BUILTIN_COUNT) return "Out of bounds";
+  return Builtins[b].name;
+}
+
+int BuiltinArity(Builtin b) {
+  if (b <= BUILTIN_NONE || b >= BUILTIN_COUNT) return 0;
+  return Builtins[b].arity;
+}
+
+bool BuiltinKeepsArguments(Builtin b) {
+  return b == BUILTIN_INSERT || b == BUILTIN_PUSH || b == BUILTIN_TO_VEC;
+}
+
+int BuiltinWrittenArgument(Builtin b) {
+  switch (b) {
+    case BUILTIN_STORE:
+    case BUILTIN_INSERT:
+    case BUILTIN_REMOVE:
+    case BUILTIN_RESERVE:
+    case BUILTIN_PUSH:
+    case BUILTIN_POP:
+    case BUILTIN_SHRINK:
+      return 0;
+    case BUILTIN_RECV:
+    case BUILTIN_TRY_RECV:
+    case BUILTIN_RECV_BATCH:
+      return 1;
+    default:
+      return -1;
+  }
+}
@@ -0,0 +1,97 @@
+/* Functions that are part of the language rather than defined in a
+ * source file. A builtin name is only recognized when no user-defined
+ * symbol of the same name is in scope. */
+
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <stdbool.h>
+
+#include "token.h"
+
+typedef enum {
+  BUILTIN_NONE,
+
+  // Reductions over a numeric array or vector, returning its element type
+  BUILTIN_SUM,
+  BUILTIN_MIN,
+  BUILTIN_MAX,
+
+  // Substring search, returning an index (-1 if absent) or a bool.
+  // contains() also takes a map and a key
+  BUILTIN_FIND,
+  BUILTIN_CONTAINS,
+
+  // A file's contents as a constant u8 array, read at compile time
+  BUILTIN_INCLUDE_BYTES,
+
+  // Bit manipulation on an unsigned integer, see bits.h
+  BUILTIN_POPCOUNT,
+  BUILTIN_CLZ,
+  BUILTIN_CTZ,
+  BUILTIN_BSWAP,
+  BUILTIN_PARITY,
+  BUILTIN_ROTL,
+  BUILTIN_ROTR,
+  BUILTIN_PEXT,
+  BUILTIN_PDEP,
+
+  // Vectors: reordering lanes, and moving lanes in and out of an array.
+  // load() and store() also take an atomic, see below
+  BUILTIN_SHUFFLE,
+  BUILTIN_LOAD,
+  BUILTIN_STORE,
+
+  // Maps, see map.h. The map is the first argument; insert(), remove()
+  // and reserve() write back to the variable. reserve() and count()
+  // also take a vec
+  BUILTIN_INSERT,
+  BUILTIN_GET,
+  BUILTIN_REMOVE,
+  BUILTIN_RESERVE,
+  BUILTIN_ELEMENT_COUNT,
+  BUILTIN_KEY_AT,
+  BUILTIN_VALUE_AT,
+
+  // Vecs, see vec.h. push(), pop() and shrink() write back to the
+  // variable; to_vec() and to_array() convert without copying
+  BUILTIN_PUSH,
+  BUILTIN_POP,
+  BUILTIN_SHRINK,
+  BUILTIN_CAPACITY,
+  BUILTIN_TO_VEC,
+  BUILTIN_TO_ARRAY,
+
+  // Atomics, see atomic.h. The atomic is the first argument and a
+  // memory order the last: 'load(a, acquire)', 'store(a, v, release)'
+  BUILTIN_FETCH_ADD,
+  BUILTIN_FETCH_OR,
+  BUILTIN_COMPARE_EXCHANGE,
+
+  // Chans, see chan.h. recv() and try_recv() write the element to the
+  // variable they're given and return whether they got one; recv_batch()
+  // fills an array from the front and returns how many it got
+  BUILTIN_SEND,
+  BUILTIN_TRY_SEND,
+  BUILTIN_RECV,
+  BUILTIN_TRY_RECV,
+  BUILTIN_CLOSE,
+  BUILTIN_SEND_BATCH,
+  BUILTIN_RECV_BATCH,
+
+  BUILTIN_COUNT
+} Builtin;
+
+Builtin LookupBuiltin(Token name);
+const char *BuiltinName(Builtin b);
+int BuiltinArity(Builtin b);
+
+// Whether the builtin stores its arguments somewhere that outlives
+// the call, like insert() into a map
+bool BuiltinKeepsArguments(Builtin b);
+
+// Which argument, counting from 0, names a variable the builtin writes
+// a new value to, like the element recv() takes. -1 for none
+int BuiltinWrittenArgument(Builtin b);
+
+#endif
@@ -0,0 +1,240 @@
+#include <sched.h>  // for sched_yield
+#include <string.h> // for memcpy
+
+#include "chan.h"
+#include "error.h"
+
+#define CHAN_MIN_CAPACITY 2
+#define CHAN_SPINS 64
+
+/* === Ring === */
+static uint64_t RoundUpToPowerOfTwo(int64_t n) {
+  uint64_t capacity = CHAN_MIN_CAPACITY;
+  while ((int64_t)capacity < n) capacity <<= 1;
+
+  return capacity;
+}
+
+static unsigned char *Slot(ChanValue *c, uint64_t position) {
+  return c->elements->elements + (position & c->mask) * c->elements->element_size;
+}
+
+/* Claims up to 'want' consecutive positions from 'position' with one
+ * compare-and-swap, as many as are ready in a row. The slot at
+ * position p is a sender's when its sequence is p, a receiver's when
+ * it's p + 1, so 'turn' is 0 or 1. Returns how many it claimed, 0 if
+ * the ring is full (or empty), and the first of them in 'first' */
+static int64_t Claim(ChanValue *c, _Atomic uint64_t *position, uint64_t turn, int64_t want, uint64_t *first) {
+  uint64_t at = atomic_load_explicit(position, memory_order_relaxed);
+
+  for (;;) {
+    int64_t ready = 0;
+    uint64_t sequence = 0;
+
+    while (ready < want) {
+      sequence = atomic_load_explicit(&c->sequences[(at + ready) & c->mask], memory_order_acquire);
+      if (sequence != at + ready + turn) break;
+      ready++;
+    }
+
+    if (ready > 0) {
+      // On failure 'at' is reloaded, so the next pass starts from where the others got to
+      if (atomic_compare_exchange_weak_explicit(position, &at, at + ready, memory_order_relaxed, memory_order_relaxed)) {
+        *first = at;
+        return ready;
+      }
+      continue;
+    }
+
+    // Behind: the slot is a lap back, still waiting on the other side
+    if ((int64_t)(sequence - (at + turn)) < 0) return 0;
+
+    // Ahead: someone else claimed this position first
+    at = atomic_load_explicit(position, memory_order_relaxed);
+  }
+}
+
+// Hands slots over to receivers once they hold their elements
+static void PublishSent(ChanValue *c, uint64_t first, int64_t count) {
+  for (int64_t i = 0; i < count; i++) {
+    atomic_store_explicit(&c->sequences[(first + i) & c->mask], first + i + 1, memory_order_release);
+  }
+}
+
+// Hands slots back to senders, a lap ahead
+static void PublishReceived(ChanValue *c, uint64_t first, int64_t count) {
+  for (int64_t i = 0; i < count; i++) {
+    atomic_store_explicit(&c->sequences[(first + i) & c->mask], first + i + c->mask + 1, memory_order_release);
+  }
+}
+
+/* An empty ring is only reported closed after a second look. Reading
+ * 'closed' synchronizes with close(), so anything sent before it is
+ * visible by then */
+static int64_t ClaimToRecv(ChanValue *c, int64_t want, uint64_t *first, ChanStatus *status) {
+  int64_t claimed = Claim(c, &c->recv_position, 1, want, first);
+  if (claimed > 0) {
+    *status = CHAN_OK;
+    return claimed;
+  }
+
+  if (!atomic_load_explicit(&c->closed, memory_order_acquire)) {
+    *status = CHAN_EMPTY;
+    return 0;
+  }
+
+  claimed = Claim(c, &c->recv_position, 1, want, first);
+  *status = (claimed > 0) ? CHAN_OK : CHAN_CLOSED;
+  return claimed;
+}
+
+// Copies elements between the ring and an array, split where the ring wraps around
+static void CopyOut(ChanValue *c, uint64_t first, unsigned char *to, int64_t count) {
+  int64_t size = c->elements->element_size;
+  int64_t until_wrap = (int64_t)(c->mask + 1 - (first & c->mask));
+  int64_t head = (count < until_wrap) ? count : until_wrap;
+
+  memcpy(to, Slot(c, first), head * size);
+  memcpy(to + head * size, Slot(c, 0), (count - head) * size);
+}
+
+static void CopyIn(ChanValue *c, uint64_t first, const unsigned char *from, int64_t count) {
+  int64_t size = c->elements->element_size;
+  int64_t until_wrap = (int64_t)(c->mask + 1 - (first & c->mask));
+  int64_t head = (count < until_wrap) ? count : until_wrap;
+
+  memcpy(Slot(c, first), from, head * size);
+  memcpy(Slot(c, 0), from + head * size, (count - head) * size);
+}
+
+static void Backoff(int *attempts) {
+  if ((*attempts)++ < CHAN_SPINS) return;
+  sched_yield();
+}
+
+static bool IsClosed(ChanValue *c) {
+  return atomic_load_explicit(&c->closed, memory_order_acquire);
+}
+
+/* === Chans === */
+ChanValue *NewChanValue(Type chan_type) {
+  ChanValue *c = NewHeapObject(HEAP_CHAN, sizeof(ChanValue));
+  uint64_t capacity = RoundUpToPowerOfTwo(chan_type.array_size);
+
+  c->element_type = chan_type.value_specifier;
+  c->mask = capacity - 1;
+
+  c->sequences = HeapAlloc(capacity * sizeof(c->sequences[0]));
+  for (uint64_t i = 0; i < capacity; i++) {
+    atomic_init(&c->sequences[i], i);
+  }
+
+  c->elements = NewArrayValue(c->element_type, (int64_t)capacity);
+  Retain(&c->elements->header);
+
+  atomic_init(&c->send_position, 0);
+  atomic_init(&c->recv_position, 0);
+  atomic_init(&c->closed, false);
+
+  return c;
+}
+
+void DropChanValue(ChanValue *c) {
+  HeapFree((void *)c->sequences, (c->mask + 1) * sizeof(c->sequences[0]));
+  Release(&c->elements->header);
+}
+
+int64_t ChanCapacity(const ChanValue *c) {
+  return (int64_t)(c->mask + 1);
+}
+
+void ChanClose(ChanValue *c) {
+  atomic_store_explicit(&c->closed, true, memory_order_release);
+}
+
+ChanStatus ChanTrySend(ChanValue *c, Value element) {
+  if (IsClosed(c)) return CHAN_CLOSED;
+
+  uint64_t first;
+  if (Claim(c, &c->send_position, 0, 1, &first) == 0) return CHAN_FULL;
+
+  ArraySet(c->elements, (int64_t)(first & c->mask), element);
+  PublishSent(c, first, 1);
+  return CHAN_OK;
+}
+
+ChanStatus ChanTryRecv(ChanValue *c, Value *element) {
+  uint64_t first;
+  ChanStatus status;
+  if (ClaimToRecv(c, 1, &first, &status) == 0) return status;
+
+  *element = ArrayGet(c->elements, (int64_t)(first & c->mask));
+  PublishReceived(c, first, 1);
+  return CHAN_OK;
+}
+
+void ChanSend(ChanValue *c, Value element) {
+  int attempts = 0;
+
+  for (;;) {
+    switch (ChanTrySend(c, element)) {
+      case CHAN_OK: return;
+      case CHAN_CLOSED: INTERPRETER_ERROR("send() on a closed chan"); return;
+      default: Backoff(&attempts); break;
+    }
+  }
+}
+
+bool ChanRecv(ChanValue *c, Value *element) {
+  int attempts = 0;
+
+  for (;;) {
+    switch (ChanTryRecv(c, element)) {
+      case CHAN_OK: return true;
+      case CHAN_CLOSED: return false;
+      default: Backoff(&attempts); break;
+    }
+  }
+}
+
+void ChanSendBatch(ChanValue *c, ArrayValue *from, int64_t offset, int64_t count) {
+  int attempts = 0;
+
+  while (count > 0) {
+    if (IsClosed(c)) INTERPRETER_ERROR("send_batch() on a closed chan");
+
+    uint64_t first;
+    int64_t claimed = Claim(c, &c->send_position, 0, count, &first);
+    if (claimed == 0) {
+      Backoff(&attempts);
+      continue;
+    }
+
+    CopyIn(c, first, from->elements + offset * from->element_size, claimed);
+    PublishSent(c, first, claimed);
+
+    offset += claimed;
+    count -= claimed;
+  }
+}
+
+int64_t ChanRecvBatch(ChanValue *c, ArrayValue *into, int64_t count) {
+  if (count <= 0) return 0;
+  int attempts = 0;
+
+  for (;;) {
+    uint64_t first;
+    ChanStatus status;
+    int64_t claimed = ClaimToRecv(c, count, &first, &status);
+
+    if (status == CHAN_CLOSED) return 0;
+    if (claimed == 0) {
+      Backoff(&attempts);
+      continue;
+    }
+
+    CopyOut(c, first, into->elements, claimed);
+    PublishReceived(c, first, claimed);
+    return claimed;
+  }
+}
@@ -0,0 +1,82 @@
+/* Runtime values of 'chan<T, N>', a bounded channel between threads.
+ *
+ * The channel is a lock-free multi-producer multi-consumer ring of N
+ * slots (rounded up to a power of two). Each slot has a sequence
+ * number that says whose turn it is: a sender may fill slot 'i' when
+ * its sequence is the send position, a receiver may empty it when the
+ * sequence is one past that. Senders and receivers claim positions
+ * with a compare-and-swap on their own counter, which sit on separate
+ * cache lines, and never take a lock.
+ *
+ * Elements are scalars, stored unboxed at native width in an ordinary
+ * ArrayValue (see value.h), so a batch moves with one memcpy per
+ * wraparound. A batch claims as many ready slots as it can with a
+ * single compare-and-swap.
+ *
+ * The blocking calls spin briefly and then yield the CPU while the
+ * ring is full or empty. Once closed, a channel refuses sends; every
+ * element sent before close() can still be received, after which
+ * receives report that it's closed.
+ *
+ * A chan variable is given its ChanValue when it is declared, like an
+ * atomic (see atomic.h).
+ */
+
+#ifndef CHAN_H
+#define CHAN_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "heap.h"
+#include "value.h"
+
+#define CHAN_CACHE_LINE 64
+#define CHAN_MAX_CAPACITY (1 << 24)
+
+typedef enum {
+  CHAN_OK,
+  CHAN_FULL,
+  CHAN_EMPTY,
+  CHAN_CLOSED,
+} ChanStatus;
+
+typedef struct ChanValue {
+  HeapObject header;
+  enum TypeSpecifier element_type;
+  uint64_t mask; // capacity - 1
+  _Atomic uint64_t *sequences;
+  ArrayValue *elements; // holds a reference
+
+  char pad0[CHAN_CACHE_LINE];
+  _Atomic uint64_t send_position;
+  char pad1[CHAN_CACHE_LINE - sizeof(uint64_t)];
+  _Atomic uint64_t recv_position;
+  char pad2[CHAN_CACHE_LINE - sizeof(uint64_t)];
+  _Atomic bool closed;
+} ChanValue;
+
+ChanValue *NewChanValue(Type chan_type);
+void DropChanValue(ChanValue *c);
+
+int64_t ChanCapacity(const ChanValue *c);
+void ChanClose(ChanValue *c);
+
+ChanStatus ChanTrySend(ChanValue *c, Value element);
+ChanStatus ChanTryRecv(ChanValue *c, Value *element);
+
+// Waits while the ring is full; sending on a closed channel is an error
+void ChanSend(ChanValue *c, Value element);
+
+// Waits while the ring is empty. False once it's closed and drained
+bool ChanRecv(ChanValue *c, Value *element);
+
+// Sends all 'count' elements from 'from[offset]' on, waiting for room as needed
+void ChanSendBatch(ChanValue *c, ArrayValue *from, int64_t offset, int64_t count);
+
+// Waits for at least one element, then takes up to 'count' into
+// 'into' from the front. Returns how many, 0 once closed and drained
+int64_t ChanRecvBatch(ChanValue *c, ArrayValue *into, int64_t count);
+
+#endif
@@ -6,7 +6,7 @@
 #include <stddef.h> // for NULL
 #include <stdio.h>
 #include <stdlib.h> // for strtoll and friends
-#include <string.h> // for strlen
+#include <string.h> // for strlen, memcpy
 
 #include "common.h"
 #include "error.h"
@@ -127,17 +127,78 @@ char *CopyStringL(const char *s, int length) {
   return new_s;
 }
 
-char *Concat(char *a, char *b) {
-  int a_len = strlen(a) + ROOM_FOR_NULL_BYTE;
-  int b_len = strlen(b) + ROOM_FOR_NULL_BYTE;
-  int total_len = a_len + b_len;
+/* === StringBuilder ===
+ *
+ * The buffer at least doubles whenever it runs out of room, so
+ * appending n bytes one piece at a time costs O(n) copying overall
+ * instead of the O(n^2) of repeated Concat() calls.
+ */
+#define STRING_BUILDER_MIN_CAPACITY 64
+
+StringBuilder NewStringBuilder(int capacity) {
+  if (capacity < STRING_BUILDER_MIN_CAPACITY) capacity = STRING_BUILDER_MIN_CAPACITY;
+
+  StringBuilder sb = {
+    .data = NewString(capacity),
+    .length = 0,
+    .capacity = capacity,
+  };
+  if (sb.data == NULL) COMPILER_ERROR("NewStringBuilder(): Out of memory");
+
+  sb.data[0] = '\0';
+  return sb;
+}
+
+static void Reserve(StringBuilder *sb, int additional) {
+  int needed = sb->length + additional + ROOM_FOR_NULL_BYTE;
+  if (needed <= sb->capacity) return;
+
+  int new_capacity = sb->capacity * 2;
+  if (new_capacity < needed) new_capacity = needed;
+
+  sb->data = realloc(sb->data, new_capacity);
+  if (sb->data == NULL) COMPILER_ERROR("StringBuilder: Out of memory");
+
+  sb->capacity = new_capacity;
+}
+
+void AppendStringL(StringBuilder *sb, const char *s, int length) {
+  Reserve(sb, length);
+
+  memcpy(sb->data + sb->length, s, length);
+  sb->length += length;
+  sb->data[sb->length] = '\0';
+}
+
+void AppendString(StringBuilder *sb, const char *s) {
+  AppendStringL(sb, s, strlen(s));
+}
+
+void AppendChar(StringBuilder *sb, char c) {
+  AppendStringL(sb, &c, 1);
+}
+
+char *BuildString(StringBuilder *sb) {
+  char *result = sb->data;
+  *sb = (StringBuilder){0};
+
+  return result;
+}
+
+void FreeStringBuilder(StringBuilder *sb) {
+  free(sb->data);
+  *sb = (StringBuilder){0};
+}
 
-  char *s = NewString(total_len);
+char *Concat(const char *a, const char *b) {
+  int a_len = strlen(a);
+  int b_len = strlen(b);
 
-  strncpy(s, a, a_len);
-  strncpy(&s[a_len - 1], b, b_len);
+  StringBuilder sb = NewStringBuilder(a_len + b_len + ROOM_FOR_NULL_BYTE);
+  AppendStringL(&sb, a, a_len);
+  AppendStringL(&sb, b, b_len);
 
-  return s;
+  return BuildString(&sb);
 }
 
 bool StringsMatch(char *a, char *b) {
@@ -9,6 +9,12 @@
 
 #define ROOM_FOR_NULL_BYTE 1
 
+typedef struct {
+  char *data; // always NUL-terminated
+  int length;
+  int capacity;
+} StringBuilder;
+
 int64_t  TokenToInt64(Token t);
 uint64_t TokenToUint64(Token t);
 double   TokenToDouble(Token t);
@@ -21,9 +27,16 @@ bool DoubleUnderflow(Token t);
 char *NewString(int size);
 char *CopyString(const char *s);
 char *CopyStringL(const char *s, int length);
-char *Concat(char *a, char *b);
+char *Concat(const char *a, const char *b);
 bool StringsMatch(char *a, char *b);
 
+StringBuilder NewStringBuilder(int capacity);
+void AppendString(StringBuilder *sb, const char *s);
+void AppendStringL(StringBuilder *sb, const char *s, int length);
+void AppendChar(StringBuilder *sb, char c);
+char *BuildString(StringBuilder *sb); // hands the buffer to the caller
+void FreeStringBuilder(StringBuilder *sb);
+
 void Print(const char *fmt, ...);
 void Print_VAList(const char *fmt, va_list args);
 
@@ -1,17 +1,107 @@
 #include "compiler.h"
+#include "constant_data.h"
+#include "escape_analysis.h"
+#include "intern.h"
 #include "interpreter.h"
 #include "lexer.h"
 #include "parser.h"
+#include "range_analysis.h"
 #include "symbol_table.h"
+#include "trace.h"
 #include "type_checker.h"
 
+// Of the last compile, see PrintCompilerReports()
+static struct {
+  RangeReport ranges;
+  EscapeReport escapes;
+  ConstantDataReport constants;
+} Reports;
+
 AST_Node *Compile(const char *filename, const char *source, SymbolTable *st) {
+  TraceBegin("compiler", "Compile");
+
   InitLexer(filename, source);
   InitParser(st);
   DebugRegisterSymbolTable(st);
+
+  TraceBegin("compiler", "Parse");
   AST_Node *ast = ParserBuildAST();
+  TraceEnd("compiler");
 
+  TraceBegin("compiler", "CheckTypes");
   CheckTypes(ast, st);
+  TraceEnd("compiler");
+
+  TraceBegin("compiler", "AnalyzeRanges");
+  Reports.ranges = AnalyzeRanges(ast);
+  TraceEnd("compiler");
+
+  TraceBegin("compiler", "AnalyzeEscapes");
+  Reports.escapes = AnalyzeEscapes(ast);
+  TraceEnd("compiler");
+
+  TraceBegin("compiler", "InternLiterals");
+  InternLiterals(ast);
+  TraceEnd("compiler");
+
+  TraceBegin("compiler", "MaterializeConstantLists");
+  Reports.constants = MaterializeConstantLists(ast);
+  TraceEnd("compiler");
+
+  TraceEnd("compiler");
 
   return ast;
 }
+
+/* Compiles one top-level statement at a time and hands each one to
+ * 'emit' as soon as it has been checked and annotated. Only function
+ * definitions are kept after that, since calls run their bodies from
+ * the AST; every other statement is freed, so memory grows with the
+ * largest statement and the global declarations rather than with the
+ * whole program.
+ *
+ * Crom requires a function to be defined before it is called, so a
+ * statement can always be checked against the globals seen so far
+ * without looking ahead. */
+void CompileStreaming(const char *filename, const char *source, SymbolTable *st, StatementHandler emit) {
+  TraceBegin("compiler", "CompileStreaming");
+
+  InitLexer(filename, source);
+  InitParser(st);
+  DebugRegisterSymbolTable(st);
+
+  BeginRangeAnalysis();
+  BeginEscapeAnalysis();
+  Reports.constants = (ConstantDataReport){0};
+
+  AST_Node *statement;
+  while ((statement = ParseStatement()) != NULL) {
+    TraceBeginToken("compiler", statement->token);
+
+    CheckTypes(statement, st);
+    AnalyzeStatementRanges(statement);
+    AnalyzeStatementEscapes(statement);
+    InternLiterals(statement);
+
+    ConstantDataReport r = MaterializeConstantLists(statement);
+    Reports.constants.lists += r.lists;
+    Reports.constants.lists_constant += r.lists_constant;
+
+    emit(statement, st);
+
+    if (!NodeIs_Function(statement)) FreeAST(statement);
+
+    TraceEnd("compiler");
+  }
+
+  Reports.ranges = EndRangeAnalysis();
+  Reports.escapes = EndEscapeAnalysis();
+
+  TraceEnd("compiler");
+}
+
+void PrintCompilerReports() {
+  PrintRangeReport(Reports.ranges);
+  PrintEscapeReport(Reports.escapes);
+  PrintConstantDataReport(Reports.constants);
+}
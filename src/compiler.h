@@ -4,6 +4,12 @@
 #include "ast.h"
 #include "symbol_table.h"
 
+typedef void (*StatementHandler)(AST_Node *statement, SymbolTable *st);
+
 AST_Node *Compile(const char *filename, const char *source, SymbolTable *st);
+void CompileStreaming(const char *filename, const char *source, SymbolTable *st, StatementHandler emit);
+
+// What the analyses of the last compile proved, see --reports
+void PrintCompilerReports();
 
 #endif
@@ -0,0 +1,121 @@
+#include <stddef.h> // for offsetof
+
+#include "arena.h"
+#include "common.h"
+#include "constant_data.h"
+#include "heap.h"
+#include "intern.h"
+#include "io.h"
+#include "value.h"
+
+static struct {
+  Arena blobs;
+  ConstantDataReport report;
+} Constants;
+
+static bool IsConstantList(AST_Node *list) {
+  for (AST_Node *entry = list; entry != NULL && entry->left != NULL; entry = entry->right) {
+    if (entry->left->node_type != LITERAL_NODE) return false;
+  }
+
+  return true;
+}
+
+ArrayValue *NewConstantArray(enum TypeSpecifier element_type, int64_t count) {
+  size_t size = ArrayValueSize(element_type, count);
+  ArrayValue *array = InitArrayValue(NewRegionObject(&Constants.blobs, HEAP_ARRAY, size),
+                                     element_type, count);
+  array->header.refcount = REFCOUNT_CONSTANT;
+
+  return array;
+}
+
+/* The file's pages become the array's elements, with the header
+ * written just in front of them (see MapFile()). Nothing is copied,
+ * and the OS only reads the parts of the file that get used */
+ArrayValue *MapConstantArray(const char *filename) {
+  size_t size = 0;
+  ArrayValue *array = MapFile(filename, offsetof(ArrayValue, elements), &size);
+  if (array == NULL) return NULL;
+
+  array->header = (HeapObject){
+    .size = offsetof(ArrayValue, elements) + size,
+    .refcount = REFCOUNT_CONSTANT,
+    .kind = HEAP_ARRAY,
+    .in_zero_count_table = false,
+  };
+  array->element_type = T_U8;
+  array->element_size = 1;
+  array->count = (int64_t)size;
+
+  return array;
+}
+
+/* A string array holds its elements as Strings, and ArraySet() would
+ * give a short literal a counted one of its own. Every isolate shares
+ * the array, so its elements come from the pool, which is never counted */
+static Value ConstantString(Value literal) {
+  return NewStringValue(InternString(StringValueData(&literal), StringValueLength(&literal)));
+}
+
+static void Materialize(AST_Node *assignment) {
+  AST_Node *list = assignment->left;
+  Type type = assignment->data_type;
+
+  Constants.report.lists++;
+
+  // Built by the parser already, see DenseInitializerList()
+  if (NodeHasFact(list, FACT_CONSTANT_DATA)) {
+    Constants.report.lists_constant++;
+    return;
+  }
+
+  if (!IsConstantList(list)) return;
+
+  Type element_type = type;
+  element_type.category = TC_NONE;
+  element_type.array_size = 0;
+
+  ArrayValue *array = NewConstantArray(type.specifier, type.array_size);
+
+  int64_t i = 0;
+  for (AST_Node *entry = list; entry != NULL && entry->left != NULL; entry = entry->right) {
+    Value v = (entry->left->token.type == STRING_LITERAL)
+                ? ConstantString(entry->left->value)
+                : NewValue(element_type, entry->left->token);
+
+    ArraySet(array, i++, v);
+  }
+
+  list->value = (Value){ .type = type, .as.array = array };
+  AddNodeFact(list, FACT_CONSTANT_DATA);
+  Constants.report.lists_constant++;
+}
+
+static void Walk(AST_Node *n) {
+  if (n == NULL) return;
+
+  if (n->node_type == ASSIGNMENT_NODE &&
+      NodeIs_ArrayInitializerList(n->left) &&
+      TypeIs_Array(n->data_type) &&
+      !TypeIs_String(n->data_type)) {
+    Materialize(n);
+  }
+
+  Walk(n->left);
+  Walk(n->middle);
+  Walk(n->right);
+}
+
+ConstantDataReport MaterializeConstantLists(AST_Node *root) {
+  Constants.report = (ConstantDataReport){0};
+
+  Walk(root);
+
+  return Constants.report;
+}
+
+void PrintConstantDataReport(ConstantDataReport r) {
+  Print("Constant data: %d of %d initializer lists built at compile time\n",
+        r.lists_constant, r.lists);
+}
@@ -0,0 +1,35 @@
+/* Constant data for array initializer lists.
+ *
+ * MaterializeConstantLists() runs once after InternLiterals() and
+ * builds every initializer list made only of literals into a packed
+ * ArrayValue of the declared element type. The list node gets
+ * FACT_CONSTANT_DATA and holds that array as its value.
+ *
+ * At runtime a declaration with such a list just points the variable
+ * at the constant array. Constant arrays count as shared (see
+ * ArrayIsShared()), so the first write through any variable copies
+ * the array, and arrays that are never written to are never copied.
+ *
+ * Lists made only of number literals don't wait for this pass: the
+ * parser stores them straight into a constant array instead of
+ * building a node per element (see DenseInitializerList() in parser.c).
+ * include_bytes("file") is a constant array as well, mapped straight
+ * from the file when the program is type checked.
+ */
+
+#ifndef CONSTANT_DATA_H
+#define CONSTANT_DATA_H
+
+#include "ast.h"
+
+typedef struct {
+  int lists;
+  int lists_constant;
+} ConstantDataReport;
+
+ArrayValue *NewConstantArray(enum TypeSpecifier element_type, int64_t count);
+ArrayValue *MapConstantArray(const char *filename); // NULL with errno set on failure
+ConstantDataReport MaterializeConstantLists(AST_Node *root);
+void PrintConstantDataReport(ConstantDataReport r);
+
+#endif
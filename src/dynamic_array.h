@@ -24,6 +24,9 @@
 
 #define INITIAL_CAPACITY 16
 
+// Most types only use some of the functions, so the rest aren't warned about
+#define da_function static __attribute__((unused)) void
+
 #define da_struct_name(type) DynamicArray_ ## type
 
 #define da_init_function_name(type) Init_DynamicArray_ ## type
@@ -39,7 +42,7 @@
   };
 
 #define da_init_definition(type)          \
-  static void                             \
+  da_function                             \
   da_init_function_name(type)(            \
       struct da_struct_name(type) *array  \
   )                                       \
@@ -50,7 +53,7 @@
   }
 
 #define da_add_definition(type)                                      \
-  static void                                                        \
+  da_function                                                        \
   da_add_function_name(type)(                                        \
       struct da_struct_name(type) *array,                            \
       type value                                                     \
@@ -68,7 +71,7 @@
   }
 
 #define da_set_definition(type)                                      \
-  static void                                                        \
+  da_function                                                        \
   da_set_function_name(type)(                                        \
       struct da_struct_name(type) *array,                            \
       int index,                                                     \
@@ -87,7 +90,7 @@
   }
 
 #define da_free_definition(type)           \
-  static void da_free_function_name(type)( \
+  da_function da_free_function_name(type)( \
       struct da_struct_name(type) *array   \
   )                                        \
   {                                        \
@@ -48,6 +48,7 @@ const char *ErrorCodeTranslation(ErrorCode code) {
     case ERR_UNKNOWN:              return "UNKNOWN";
     case ERR_COMPILER:             return "COMPILER";
     case ERR_INTERPRETER:          return "INTERPRETER";
+    case ERR_OUT_OF_BOUNDS:        return "OUT OF BOUNDS";
     default:                       return "Unhandled ErrorCodeTranslation case";
   }
 }
@@ -81,6 +82,7 @@ ErrorCode ErrorCodeLookup(char *str) {
   if (StringsMatch(str, "ERR_MISC")) return ERR_MISC;
   if (StringsMatch(str, "ERR_COMPILER")) return ERR_COMPILER;
   if (StringsMatch(str, "ERR_INTERPRETER")) return ERR_INTERPRETER;
+  if (StringsMatch(str, "ERR_OUT_OF_BOUNDS")) return ERR_OUT_OF_BOUNDS;
 
   Print("ErrorCodeLookup(): No match for '%s'\n", str);
   return ERR_UNKNOWN;
@@ -200,6 +202,9 @@ void Error(const char *file, int line, const char *func_name, ErrorCode error_co
     case ERR_INTERPRETER: {
       // This maybe shouldn't be handled in this function
     } break;
+    case ERR_OUT_OF_BOUNDS: {
+      // This maybe shouldn't be handled in this function
+    } break;
   }
 
   Print("\n");
@@ -0,0 +1,233 @@
+/* Escape analysis for heap-backed values declared inside functions.
+ *
+ * Arrays, strings and structs assigned to a function-local variable
+ * are candidates. A candidate escapes when the variable itself or a
+ * slice of it (but not one of its elements) is:
+ *   - returned
+ *   - passed as a function argument
+ *   - assigned to another variable, global or local
+ *   - stored by a builtin such as insert() or push()
+ *   - concatenated onto a string that escapes, since concatenation
+ *     keeps pointers to both halves rather than copying them
+ *
+ * Candidates that never escape get FACT_NO_ESCAPE on their assignment
+ * node and on the value being assigned, so the interpreter can place
+ * initializer lists in the per-call region instead of on the heap
+ * (string literals are interned instead, see intern.h). Every
+ * assignment to the same name must agree: if any of them escapes,
+ * none of them are marked.
+ *
+ * Assignments inside a loop are never marked. The region is only reset
+ * on return, so each pass would take another copy out of it.
+ *
+ * Names are tracked per function without regard to block scope. A
+ * local that shadows a global is treated as the global, which only
+ * ever costs an optimization.
+ */
+
+#include "builtins.h"
+#include "common.h"
+#include "dynamic_array.h"
+#include "escape_analysis.h"
+
+typedef struct {
+  Token name;
+  bool escapes;
+} Candidate;
+
+typedef AST_Node* NodePtr;
+
+USE_DYNAMIC_ARRAY(Token)
+USE_DYNAMIC_ARRAY(Candidate)
+USE_DYNAMIC_ARRAY(NodePtr)
+
+static struct {
+  DA(Token) globals;
+  DA(Candidate) candidates;
+  DA(NodePtr) assignments;
+  bool in_function;
+  int loop_depth;
+  EscapeReport report;
+} Analysis;
+
+/* === Forward Declarations === */
+static void Walk(AST_Node *n, bool escaping);
+
+/* === Names === */
+static bool IsGlobal(Token name) {
+  for (int i = 0; i < Analysis.globals.count; i++) {
+    if (TokenValuesMatch(Analysis.globals.data[i], name)) return true;
+  }
+
+  return false;
+}
+
+static Candidate *LookupCandidate(Token name) {
+  for (int i = 0; i < Analysis.candidates.count; i++) {
+    if (TokenValuesMatch(Analysis.candidates.data[i].name, name)) {
+      return &Analysis.candidates.data[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void Escape(Token name) {
+  Candidate *c = LookupCandidate(name);
+  if (c != NULL) c->escapes = true;
+}
+
+static bool IsHeapBacked(Type t) {
+  return TypeIs_Array(t) || TypeIs_String(t) || TypeIs_Struct(t);
+}
+
+/* === Walkers === */
+static void Assignment(AST_Node *n) {
+  bool is_element = (n->middle != NULL);
+
+  if (!Analysis.in_function) {
+    if (!IsGlobal(n->token)) DA_ADD(Token, Analysis.globals, n->token);
+  } else if (!is_element && !IsGlobal(n->token) && IsHeapBacked(n->data_type)) {
+    if (LookupCandidate(n->token) == NULL) {
+      DA_ADD(Candidate, Analysis.candidates, ((Candidate){ .name = n->token }));
+    }
+
+    if (Analysis.loop_depth == 0) {
+      DA_ADD(NodePtr, Analysis.assignments, n);
+    } else {
+      Analysis.report.locals++;
+    }
+  }
+
+  // Storing a whole array, string or struct shares it with the target
+  if (n->left != NULL) Walk(n->left, true);
+  if (n->middle != NULL) Walk(n->middle, false);
+}
+
+static void FunctionArguments(AST_Node *args) {
+  for (AST_Node *arg = args; arg != NULL; arg = arg->right) {
+    if (arg->node_type == FUNCTION_ARGUMENT_NODE && arg->token.type == IDENTIFIER) {
+      Escape(arg->token);
+    }
+
+    if (arg->left != NULL) Walk(arg->left, true);
+    if (arg->node_type == FUNCTION_CALL_NODE) Walk(arg, false);
+  }
+}
+
+static void MarkFunctionLocals() {
+  for (int i = 0; i < Analysis.assignments.count; i++) {
+    AST_Node *n = Analysis.assignments.data[i];
+    Candidate *c = LookupCandidate(n->token);
+
+    Analysis.report.locals++;
+    if (c->escapes) continue;
+
+    AddNodeFact(n, FACT_NO_ESCAPE);
+    if (n->left != NULL) AddNodeFact(n->left, FACT_NO_ESCAPE);
+    Analysis.report.locals_not_escaping++;
+  }
+}
+
+static void Function(AST_Node *n) {
+  DA_INIT(Candidate, Analysis.candidates);
+  DA_INIT(NodePtr, Analysis.assignments);
+  Analysis.in_function = true;
+
+  if (n->right != NULL) Walk(n->right, false);
+  MarkFunctionLocals();
+
+  DA_FREE(Candidate, Analysis.candidates);
+  DA_FREE(NodePtr, Analysis.assignments);
+  Analysis.in_function = false;
+}
+
+static void Walk(AST_Node *n, bool escaping) {
+  if (n == NULL) return;
+
+  switch (n->node_type) {
+    case FUNCTION_NODE: {
+      Function(n);
+    } break;
+    case ASSIGNMENT_NODE: {
+      Assignment(n);
+    } break;
+    case IDENTIFIER_NODE: {
+      // A slice points into the variable's array or string
+      bool is_whole = (n->middle == NULL || NodeIs_ArraySlice(n->middle));
+      if (escaping && is_whole) Escape(n->token);
+    } break;
+    case RETURN_NODE: {
+      Walk(n->left, true);
+    } break;
+    case WHILE_NODE:
+    case FOR_NODE: {
+      Analysis.loop_depth++;
+      Walk(n->left, false);
+      Walk(n->middle, false);
+      Walk(n->right, false);
+      Analysis.loop_depth--;
+    } break;
+    case FUNCTION_CALL_NODE: {
+      FunctionArguments(n->middle);
+    } break;
+    case BUILTIN_CALL_NODE: {
+      bool keeps_arguments = BuiltinKeepsArguments(LookupBuiltin(n->token));
+      for (AST_Node *arg = n->middle; arg != NULL; arg = arg->right) {
+        Walk(arg->left, keeps_arguments);
+      }
+    } break;
+    case TERNARY_IF_NODE: {
+      Walk(n->left, false);
+      Walk(n->middle, escaping);
+      Walk(n->right, escaping);
+    } break;
+    case BINARY_ARITHMETIC_NODE: {
+      bool shares_operands = TypeIs_String(n->data_type);
+      Walk(n->left, escaping && shares_operands);
+      Walk(n->right, escaping && shares_operands);
+    } break;
+    case TERSE_ASSIGNMENT_NODE: {
+      Walk(n->left, false);
+      Walk(n->right, TypeIs_String(n->data_type));
+    } break;
+    default: {
+      // Everything else computes a new value from its operands
+      Walk(n->left, false);
+      Walk(n->middle, false);
+      Walk(n->right, false);
+    } break;
+  }
+}
+
+/* Top-level statements can also be analyzed one at a time, in source
+ * order, between BeginEscapeAnalysis() and EndEscapeAnalysis(). Only
+ * the global names carry over, since a function is a single statement */
+void BeginEscapeAnalysis() {
+  Analysis.report = (EscapeReport){0};
+  Analysis.in_function = false;
+  Analysis.loop_depth = 0;
+  DA_INIT(Token, Analysis.globals);
+}
+
+void AnalyzeStatementEscapes(AST_Node *statement) {
+  Walk(statement, false);
+}
+
+EscapeReport EndEscapeAnalysis() {
+  DA_FREE(Token, Analysis.globals);
+
+  return Analysis.report;
+}
+
+EscapeReport AnalyzeEscapes(AST_Node *ast_root) {
+  BeginEscapeAnalysis();
+  AnalyzeStatementEscapes(ast_root);
+  return EndEscapeAnalysis();
+}
+
+void PrintEscapeReport(EscapeReport r) {
+  Print("Escape analysis: %d of %d function-local arrays, strings and structs "
+        "can live in their call frame\n",
+        r.locals_not_escaping, r.locals);
+}
@@ -0,0 +1,17 @@
+#ifndef ESCAPE_ANALYSIS_H
+#define ESCAPE_ANALYSIS_H
+
+#include "ast.h"
+
+typedef struct {
+  int locals;
+  int locals_not_escaping;
+} EscapeReport;
+
+EscapeReport AnalyzeEscapes(AST_Node *ast_root);
+void BeginEscapeAnalysis();
+void AnalyzeStatementEscapes(AST_Node *statement);
+EscapeReport EndEscapeAnalysis();
+void PrintEscapeReport(EscapeReport r);
+
+#endif
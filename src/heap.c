@@ -0,0 +1,237 @@
+#include <stdlib.h> // for malloc, realloc, free
+
+#include "chan.h"
+#include "common.h"
+#include "dynamic_array.h"
+#include "error.h"
+#include "heap.h"
+#include "map.h"
+#include "str.h"
+#include "value.h"
+#include "vec.h"
+
+typedef HeapObject* HeapObjectPtr;
+USE_DYNAMIC_ARRAY(HeapObjectPtr)
+
+struct HeapState {
+  HeapStats stats;
+  int64_t statements;
+
+  DA(HeapObjectPtr) zero_count_table;
+  DA(HeapObjectPtr) doomed;
+  bool freeing;
+};
+
+// Every thread has its own default, so threads outside any isolate
+// don't share a table. NULL is the calling thread's default
+static _Thread_local HeapState default_state;
+static _Thread_local HeapState *current;
+
+static HeapState *Heap() {
+  return (current != NULL) ? current : &default_state;
+}
+
+/* === States === */
+HeapState *NewHeapState() {
+  HeapState *state = calloc(1, sizeof(HeapState));
+  if (state == NULL) INTERPRETER_ERROR("NewHeapState(): Out of memory");
+
+  DA_INIT(HeapObjectPtr, state->zero_count_table);
+  DA_INIT(HeapObjectPtr, state->doomed);
+
+  return state;
+}
+
+void DeleteHeapState(HeapState *state) {
+  HeapState *previous = UseHeapState(state);
+  ReleaseTemporaries(0);
+  UseHeapState(previous);
+
+  DA_FREE(HeapObjectPtr, state->zero_count_table);
+  DA_FREE(HeapObjectPtr, state->doomed);
+  free(state);
+}
+
+int64_t HeapStateBytes(const HeapState *state) {
+  return (int64_t)sizeof(HeapState) +
+         (int64_t)(state->zero_count_table.capacity + state->doomed.capacity) * (int64_t)sizeof(HeapObjectPtr);
+}
+
+HeapState *UseHeapState(HeapState *state) {
+  HeapState *previous = Heap();
+  current = state;
+
+  return previous;
+}
+
+/* === Counted Allocation === */
+static void CountBytes(HeapStats *stats, int64_t bytes) {
+  if (bytes > 0) stats->bytes_allocated += bytes;
+  stats->live_bytes += bytes;
+  if (stats->live_bytes > stats->peak_live_bytes) stats->peak_live_bytes = stats->live_bytes;
+}
+
+void *HeapAlloc(size_t size) {
+  void *memory = malloc(size);
+  if (memory == NULL) INTERPRETER_ERROR("HeapAlloc(): Out of memory");
+
+  HeapStats *stats = &Heap()->stats;
+  stats->allocations++;
+  CountBytes(stats, size);
+
+  return memory;
+}
+
+void HeapFree(void *memory, size_t size) {
+  if (memory == NULL) return;
+
+  HeapStats *stats = &Heap()->stats;
+  stats->frees++;
+  stats->live_bytes -= size;
+  free(memory);
+}
+
+/* === Objects === */
+void *NewHeapObject(HeapKind kind, size_t size) {
+  HeapObject *object = HeapAlloc(size);
+  *object = (HeapObject){
+    .size = size,
+    .refcount = 0,
+    .kind = kind,
+    .in_zero_count_table = true,
+  };
+
+  DA_ADD(HeapObjectPtr, Heap()->zero_count_table, object);
+  return object;
+}
+
+void *NewRegionObject(Arena *region, HeapKind kind, size_t size) {
+  HeapObject *object = ArenaAlloc(region, size);
+  *object = (HeapObject){
+    .size = size,
+    .refcount = REFCOUNT_UNCOUNTED,
+    .kind = kind,
+    .in_zero_count_table = false,
+  };
+
+  return object;
+}
+
+/* The zero-count table holds a pointer to its objects, and a second
+ * reference would be left pointing at the old block, so only an
+ * object with one counted reference and no table entry can move */
+void *ResizeHeapObject(HeapObject *object, size_t size) {
+  if (object->refcount != 1 || object->in_zero_count_table) return NULL;
+
+  size_t old_size = object->size;
+  HeapObject *resized = realloc(object, size);
+  if (resized == NULL) INTERPRETER_ERROR("ResizeHeapObject(): Out of memory");
+
+  CountBytes(&Heap()->stats, (int64_t)size - (int64_t)old_size);
+  resized->size = size;
+
+  return resized;
+}
+
+// Releases whatever the object refers to, but not the object itself
+static void Drop(HeapObject *object) {
+  switch (object->kind) {
+    case HEAP_STRING: DropString((String *)object);         break;
+    case HEAP_ARRAY:  DropArrayValue((ArrayValue *)object); break;
+    case HEAP_MAP:    DropMapValue((MapValue *)object);     break;
+    case HEAP_VEC:    DropVecValue((VecValue *)object);     break;
+    case HEAP_ATOMIC: break; // holds nothing but its value
+    case HEAP_CHAN:   DropChanValue((ChanValue *)object);   break;
+    default: INTERPRETER_ERROR("Drop(): Unknown heap object kind");
+  }
+}
+
+/* Dropping an object can release others down to zero; those are
+ * queued and handled by the outermost call instead of recursing */
+static void Destroy(HeapObject *object) {
+  HeapState *heap = Heap();
+
+  DA_ADD(HeapObjectPtr, heap->doomed, object);
+  if (heap->freeing) return;
+
+  heap->freeing = true;
+  while (heap->doomed.count > 0) {
+    HeapObject *next = heap->doomed.data[--heap->doomed.count];
+    Drop(next);
+    HeapFree(next, next->size);
+  }
+  heap->freeing = false;
+}
+
+// Negative counts mark objects that aren't counted at all
+void Retain(HeapObject *object) {
+  if (object == NULL || object->refcount < 0) return;
+
+  object->refcount++;
+}
+
+void Release(HeapObject *object) {
+  if (object == NULL || object->refcount < 0) return;
+  if (object->refcount == 0) return;
+
+  object->refcount--;
+  if (object->refcount == 0 && !object->in_zero_count_table) {
+    Destroy(object);
+  }
+}
+
+/* Like Release(), but an object left with no references goes back in
+ * the zero-count table instead of being freed, so it lives as long as
+ * a temporary of the running statement would. See FunctionCall() in
+ * interpreter.c, whose result outlives the scope that held it */
+void ReleaseToTemporaries(HeapObject *object) {
+  if (object == NULL || object->refcount <= 0) return;
+
+  object->refcount--;
+  if (object->refcount == 0 && !object->in_zero_count_table) {
+    object->in_zero_count_table = true;
+    DA_ADD(HeapObjectPtr, Heap()->zero_count_table, object);
+  }
+}
+
+int TemporariesMark() {
+  return Heap()->zero_count_table.count;
+}
+
+/* An object dropped here can release another table entry to zero.
+ * That entry is still flagged, so it is either freed later in this
+ * loop or left for whoever owns the older part of the table */
+void ReleaseTemporaries(int mark) {
+  HeapState *heap = Heap();
+  heap->statements++;
+
+  for (int i = mark; i < heap->zero_count_table.count; i++) {
+    HeapObject *object = heap->zero_count_table.data[i];
+    object->in_zero_count_table = false;
+
+    if (object->refcount == 0) Destroy(object);
+  }
+
+  heap->zero_count_table.count = mark;
+}
+
+/* === Stats === */
+HeapStats GetHeapStats() {
+  return Heap()->stats;
+}
+
+void PrintHeapStats() {
+  HeapStats stats = Heap()->stats;
+  int64_t statements = Heap()->statements;
+
+  Print("Heap: %lld allocations (%lld bytes), %lld frees, %lld bytes live, %lld bytes at peak",
+        (long long)stats.allocations, (long long)stats.bytes_allocated,
+        (long long)stats.frees, (long long)stats.live_bytes,
+        (long long)stats.peak_live_bytes);
+
+  if (statements > 0) {
+    Print(", %.2f allocations per statement", (double)stats.allocations / statements);
+  }
+
+  Print("\n");
+}
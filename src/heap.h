@@ -0,0 +1,99 @@
+/* Reference counted storage for runtime strings, arrays, maps, vecs,
+ * atomics and chans.
+ *
+ * Every heap object starts with a HeapObject header. The count only
+ * tracks references held by variables and by other heap objects;
+ * intermediate results sitting in AST nodes are not counted, so
+ * reading a variable or passing a value through an expression never
+ * touches a count.
+ *
+ * A new object starts at zero and goes into the zero-count table.
+ * After each statement, ReleaseTemporaries() frees every object that
+ * statement added to the table and that still has no references.
+ * Entries from before the statement started are left alone, so a
+ * function body can't free a temporary its caller is still using.
+ * Objects whose count drops to zero outside the table are freed
+ * right away. Freeing is iterative, so releasing a long chain of
+ * concatenations doesn't recurse.
+ *
+ * Objects placed in a region (see arena.h) by escape analysis are
+ * marked REFCOUNT_UNCOUNTED. Retain() and Release() skip them, and
+ * the region frees them when the call returns. Interned literals and
+ * constant arrays are never freed and are skipped the same way.
+ *
+ * The table and the stats live in a HeapState. Each thread works in
+ * its own current state, which starts as that thread's own default,
+ * and an isolate switches to its own while it runs (see isolate.h), so
+ * the heap never takes a lock. An object belongs to the state it was
+ * allocated in and must be released there, and a thread should release
+ * what it allocated in its default before it exits.
+ */
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h> // for size_t
+#include <stdint.h>
+
+#include "arena.h"
+
+#define REFCOUNT_UNCOUNTED -1
+#define REFCOUNT_INTERNED  -2 // see intern.h
+#define REFCOUNT_CONSTANT  -3 // see constant_data.h
+
+typedef enum {
+  HEAP_STRING,
+  HEAP_ARRAY,
+  HEAP_MAP,
+  HEAP_VEC,
+  HEAP_ATOMIC,
+  HEAP_CHAN,
+} HeapKind;
+
+typedef struct HeapObject {
+  size_t size;
+  int32_t refcount;
+  uint8_t kind;
+  bool in_zero_count_table;
+} HeapObject;
+
+typedef struct {
+  int64_t allocations;
+  int64_t frees;
+  int64_t bytes_allocated;
+  int64_t live_bytes;
+  int64_t peak_live_bytes;
+} HeapStats;
+
+typedef struct HeapState HeapState;
+
+HeapState *NewHeapState();
+void DeleteHeapState(HeapState *state); // frees what's left in its zero-count table
+int64_t HeapStateBytes(const HeapState *state); // the bookkeeping, not the objects
+
+// Makes 'state' current on this thread and returns the one it replaces.
+// NULL goes back to this thread's default
+HeapState *UseHeapState(HeapState *state);
+
+void *NewHeapObject(HeapKind kind, size_t size);
+void *NewRegionObject(Arena *region, HeapKind kind, size_t size);
+
+// Reallocates an object that exactly one reference holds, which may
+// move it. Returns NULL, leaving the object alone, for any other object
+void *ResizeHeapObject(HeapObject *object, size_t size);
+
+void Retain(HeapObject *object);
+void Release(HeapObject *object);
+void ReleaseToTemporaries(HeapObject *object);
+int TemporariesMark();
+void ReleaseTemporaries(int mark);
+
+// Counted allocations for buffers owned by a heap object
+void *HeapAlloc(size_t size);
+void HeapFree(void *memory, size_t size);
+
+HeapStats GetHeapStats(); // of the current state
+void PrintHeapStats();
+
+#endif
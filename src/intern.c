@@ -0,0 +1,88 @@
+#include <stdlib.h> // for calloc, free
+#include <string.h> // for memcmp
+
+#include "arena.h"
+#include "error.h"
+#include "intern.h"
+#include "value.h"
+
+#define POOL_INITIAL_CAPACITY 64
+
+static struct {
+  Arena strings;
+  String **slots; // open addressing, linear probing
+  int64_t capacity;
+  int64_t count;
+} Pool;
+
+static void InsertSlot(String **slots, int64_t capacity, String *s) {
+  int64_t i = s->hash & (capacity - 1);
+  while (slots[i] != NULL) i = (i + 1) & (capacity - 1);
+
+  slots[i] = s;
+}
+
+static void GrowPool() {
+  int64_t capacity = (Pool.capacity == 0) ? POOL_INITIAL_CAPACITY : Pool.capacity * 2;
+
+  String **slots = calloc(capacity, sizeof(String*));
+  if (slots == NULL) COMPILER_ERROR("GrowPool(): Out of memory");
+
+  for (int64_t i = 0; i < Pool.capacity; i++) {
+    if (Pool.slots[i] != NULL) InsertSlot(slots, capacity, Pool.slots[i]);
+  }
+
+  free(Pool.slots);
+  Pool.slots = slots;
+  Pool.capacity = capacity;
+}
+
+String *InternString(const char *chars, int64_t length) {
+  // Keep the load factor under 3/4
+  if (4 * (Pool.count + 1) > 3 * Pool.capacity) GrowPool();
+
+  uint64_t hash = HashChars(chars, length);
+
+  int64_t i = hash & (Pool.capacity - 1);
+  while (Pool.slots[i] != NULL) {
+    String *existing = Pool.slots[i];
+    if (existing->hash == hash &&
+        existing->length == length &&
+        memcmp(existing->data, chars, length) == 0) {
+      return existing;
+    }
+
+    i = (i + 1) & (Pool.capacity - 1);
+  }
+
+  String *s = InitString(NewRegionObject(&Pool.strings, HEAP_STRING, StringAllocationSize(length)), chars, length);
+  s->header.refcount = REFCOUNT_INTERNED;
+  s->hash = hash;
+
+  Pool.slots[i] = s;
+  Pool.count++;
+
+  return s;
+}
+
+static void InternLiteral(AST_Node *n) {
+  const char *chars = n->token.position_in_source;
+  int64_t length = n->token.length;
+
+  n->value = (length > SMALL_STRING_CAPACITY)
+               ? NewStringValue(InternString(chars, length))
+               : NewStringValueFrom(chars, length);
+}
+
+void InternLiterals(AST_Node *root) {
+  if (root == NULL) return;
+
+  if (root->token.type == STRING_LITERAL &&
+      (root->node_type == LITERAL_NODE || root->node_type == FUNCTION_ARGUMENT_NODE)) {
+    InternLiteral(root);
+  }
+
+  InternLiterals(root->left);
+  InternLiterals(root->middle);
+  InternLiterals(root->right);
+}
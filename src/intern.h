@@ -0,0 +1,24 @@
+/* Interned string literals.
+ *
+ * InternLiterals() runs once after type checking and gives every
+ * string literal in the program its runtime value up front. Literals
+ * short enough to be stored inline (see value.h) get an inline value.
+ * Longer ones point into a pool that holds one String per distinct
+ * literal, with the hash already computed.
+ *
+ * Pool strings are never counted, written to or freed. Two of them
+ * are equal exactly when they are the same pointer.
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdint.h>
+
+#include "ast.h"
+#include "str.h"
+
+String *InternString(const char *chars, int64_t length);
+void InternLiterals(AST_Node *root);
+
+#endif
@@ -1,84 +1,186 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h> // for calloc
-#include <string.h> // for strncmp
+#include <string.h> // for strncmp, memcpy
 
+#include "arena.h"
+#include "atomic.h"
+#include "bits.h"
+#include "chan.h"
 #include "common.h"
 #include "error.h"
+#include "heap.h"
 #include "interpreter.h"
+#include "isolate.h"
+#include "map.h"
+#include "simd.h"
+#include "str.h"
 #include "symbol_table.h"
+#include "trace.h"
+#include "vec.h"
 
-#if 0
-/* === Global === */
-static AST_Node *function_definitions[100]; // TODO: Dynamic array?
-static int fdi = 0;
+/* === Isolate === */
+// A run writes nothing but the current isolate, see isolate.h
+#define VALUE(n) (CurrentIsolate()->values[(n)->slot])
 
 /* === Forward Declarations === */
 static void InterpretRecurse(AST_Node *n);
+static void RunStatement(AST_Node *statement);
+static void RunChain(AST_Node *chain);
 
 /* === Scope Related === */
-SymbolTable *shadowed_symbol_table;
+static SymbolTable *SYMBOL_TABLE() {
+  Isolate *isolate = CurrentIsolate();
+  return isolate->scope.locals[isolate->scope.depth];
+}
 
-static struct {
-  int depth;
-  SymbolTable *locals[10]; // TODO: figure out actual size or make dynamic array
-} Scope;
+/* A call sees its own scopes, from 'top' down to 'frame', and then the
+ * globals, never its caller's. A name found nowhere is a new local */
+static SymbolTable *ScopeIn(int top, int frame, Token t) {
+  Isolate *isolate = CurrentIsolate();
 
-static SymbolTable *SYMBOL_TABLE() {
-  return (shadowed_symbol_table != NULL)
-           ? shadowed_symbol_table
-           : Scope.locals[Scope.depth];
+  for (int i = top; i >= frame; i--) {
+    if (IsIn(isolate->scope.locals[i], t)) return isolate->scope.locals[i];
+  }
+
+  if (IsIn(isolate->globals, t)) return isolate->globals;
+  return isolate->scope.locals[top];
+}
+
+static SymbolTable *ScopeOf(Token t) {
+  Isolate *isolate = CurrentIsolate();
+  return ScopeIn(isolate->scope.depth, isolate->scope.frame, t);
+}
+
+static Symbol Lookup(Token t) {
+  return RetrieveFrom(ScopeOf(t), t);
 }
 
 static void BeginScope() {
-  Scope.depth++;
-  Scope.locals[Scope.depth] = NewSymbolTable();
+  Isolate *isolate = CurrentIsolate();
+  ReserveScopes(isolate, isolate->scope.depth + 1);
+
+  isolate->scope.depth++;
+  isolate->scope.locals[isolate->scope.depth] = NewSymbolTable();
 }
 
 static void EndScope() {
-  if (Scope.depth == 0) ERROR_AND_EXIT("How'd you end scope at depth 0?");
+  Isolate *isolate = CurrentIsolate();
+  if (isolate->scope.depth == 0) INTERPRETER_ERROR("EndScope(): How'd you end scope at depth 0?");
 
-  DeleteSymbolTable(Scope.locals[Scope.depth]);
-  Scope.locals[Scope.depth] = NULL;
-  Scope.depth--;
+  ReleaseSymbolValues(isolate->scope.locals[isolate->scope.depth]);
+  DeleteSymbolTable(isolate->scope.locals[isolate->scope.depth]);
+  isolate->scope.locals[isolate->scope.depth] = NULL;
+  isolate->scope.depth--;
 }
 /* === End Scope Related === */
 
 void Literal(AST_Node *n) {
-  n->value = NewValue(n->value.type, n->token);
+  // String literals already hold their interned value (see intern.h),
+  // and memory orders are read from their token, see OrderArgument()
+  if (n->token.type == STRING_LITERAL || n->token.type == MEMORY_ORDER_LITERAL) return;
+
+  VALUE(n) = NewValue(n->data_type, n->token);
+}
+
+static int64_t SubscriptIndex(AST_Node *subscript) {
+  return (subscript->token.type == IDENTIFIER)
+           ? Lookup(subscript->token).value.as.integer
+           : TokenToInt64(subscript->token);
+}
+
+// Subscripts that range analysis proved in bounds skip the check
+static int64_t CheckedSubscript(AST_Node *subscript, int64_t size) {
+  int64_t index = SubscriptIndex(subscript);
+
+  if (!NodeHasFact(subscript, FACT_IN_BOUNDS) &&
+      (index < 0 || index >= size)) {
+    OUT_OF_BOUNDS_ERROR("Array subscript out of bounds");
+  }
+
+  return index;
+}
+
+// A declared vec is NULL until its first write. Copy-on-write otherwise
+static VecValue *WritableVec(Symbol *s) {
+  if (s->value.as.vec == NULL) {
+    s->value = (Value){ .type = s->data_type, .as.vec = NewVecValue(s->data_type) };
+    RetainValue(s->value);
+  } else if (VecIsShared(s->value.as.vec)) {
+    Value previous = s->value;
+    s->value.as.vec = CopyVecValue(previous.as.vec);
+
+    RetainValue(s->value);
+    ReleaseValue(previous);
+  }
+
+  return s->value.as.vec;
+}
+
+// Left out bounds are the start and the end; SliceOf() checks the rest
+static Value Slice(Value v, AST_Node *range) {
+  int64_t lo = (range->left != NULL) ? SubscriptIndex(range->left) : 0;
+  int64_t hi = (range->right != NULL) ? SubscriptIndex(range->right) : SliceableLength(v);
+
+  return SliceOf(v, lo, hi);
 }
 
 void Identifier(AST_Node *n) {
-  Symbol stored_symbol = RetrieveFrom(SYMBOL_TABLE(), n->token);
+  Symbol stored_symbol = Lookup(n->token);
+
+  if (n->middle != NULL && NodeIs_ArraySlice(n->middle)) {
+    VALUE(n) = Slice(stored_symbol.value, n->middle);
+    return;
+  }
+
+  if (TypeIs_Slice(stored_symbol.value.type) && n->middle != NULL) {
+    Value slice = stored_symbol.value;
+    VALUE(n) = SliceGet(slice, CheckedSubscript(n->middle, SliceableLength(slice)));
+    return;
+  }
+
+  if (TypeIs_Vec(stored_symbol.data_type) && n->middle != NULL) {
+    VecValue *vec = stored_symbol.value.as.vec;
+    VALUE(n) = VecGet(vec, CheckedSubscript(n->middle, VecCount(vec)));
+    return;
+  }
 
   if (TypeIs_String(stored_symbol.value.type)) {
     if (!NodeIs_NULL(n->middle) && NodeIs_ArraySubscript(n->middle)) {
       // Extract char from a "str[i]"-type thing
-      int64_t index = TokenToInt64(n->middle->token, 10);
-      n->value = NewCharValue(stored_symbol.value.as.string[index]);
+      Value *s = &stored_symbol.value;
+      int64_t index = CheckedSubscript(n->middle, StringValueLength(s));
+      VALUE(n) = NewCharValue(StringValueData(s)[index]);
     } else {
-      n->value = stored_symbol.value;
+      VALUE(n) = stored_symbol.value;
     }
-  } else if (TypeIs_Array(stored_symbol.value.type)) {
-    int subscript = TokenToInt64(n->middle->token, 10);
-    n->value = stored_symbol.value.as.array[subscript];
+  } else if (TypeIs_Array(stored_symbol.value.type) && n->middle != NULL) {
+    ArrayValue *array = stored_symbol.value.as.array;
+    int64_t subscript = CheckedSubscript(n->middle, array->count);
+    VALUE(n) = ArrayGet(array, subscript);
   } else {
-    n->value = stored_symbol.value;
+    VALUE(n) = stored_symbol.value;
   }
 }
 
 Value ArrayInitializerList(AST_Node *n) {
   AST_Node **current = &n->left;
-  Value *data = calloc(n->value.type.array_size, sizeof(Value));
+  enum TypeSpecifier element_type = n->data_type.specifier;
+  int64_t count = n->data_type.array_size;
+
+  ArrayValue *array = (NodeHasFact(n, FACT_NO_ESCAPE))
+                        ? InitArrayValue(NewRegionObject(&CurrentIsolate()->call_frames, HEAP_ARRAY, ArrayValueSize(element_type, count)), element_type, count)
+                        : NewArrayValue(element_type, count);
   int i = 0;
 
   while (*current != NULL && (*current)->left != NULL) {
     if (NodeIs_Identifier((*current)->left)) {
-      Symbol s = RetrieveFrom(SYMBOL_TABLE(), (*current)->left->token);
-      data[i] = s.value;
+      ArraySet(array, i, Lookup((*current)->left->token).value);
+    } else if ((*current)->left->token.type == STRING_LITERAL) {
+      ArraySet(array, i, VALUE((*current)->left));
     } else {
-      data[i] = NewValue((*current)->left->value.type,
-                         (*current)->left->token);
+      ArraySet(array, i, NewValue((*current)->left->data_type,
+                                  (*current)->left->token));
     }
 
     i++;
@@ -88,32 +190,80 @@ Value ArrayInitializerList(AST_Node *n) {
   return (Value) {
     .type = (Type) {
       .category = TC_ARRAY,
-      .specifier = n->value.type.specifier,
-      .array_size = i,
+      .specifier = element_type,
+      .array_size = count,
     },
 
-    .as.array = data,
+    .as.array = array,
   };
 }
 
-void Assignment(AST_Node *n) {
-  Symbol symbol = {0};
-  if (IsIn(SYMBOL_TABLE(), n->token)) {
-    symbol = RetrieveFrom(SYMBOL_TABLE(), n->token);
+// An array declared before Declaration() gave it storage is NULL until
+// its first write. Copy-on-write: another variable still sees the old elements
+static ArrayValue *WritableArray(Symbol *s) {
+  if (s->value.as.array == NULL) {
+    s->value = (Value){ .type = s->data_type, .as.array = NewArrayValue(s->data_type.specifier, s->data_type.array_size) };
+    RetainValue(s->value);
+  } else if (ArrayIsShared(s->value.as.array)) {
+    Value previous = s->value;
+    s->value.as.array = CopyArrayValue(previous.as.array);
+
+    RetainValue(s->value);
+    ReleaseValue(previous);
+  }
+
+  return s->value.as.array;
+}
+
+// 'a[i] = v' on an array or a vec
+static void AssignElement(Token t, AST_Node *subscript, Value v) {
+  SymbolTable *scope = ScopeOf(t);
+  Symbol s = RetrieveFrom(scope, t);
+
+  if (TypeIs_Vec(s.data_type)) {
+    VecValue *vec = WritableVec(&s);
+    VecSet(vec, CheckedSubscript(subscript, VecCount(vec)), v);
   } else {
-    symbol = NewSymbol(n->token, n->value.type, DECL_NONE);
+    ArrayValue *array = WritableArray(&s);
+    ArraySet(array, CheckedSubscript(subscript, array->count), v);
   }
 
-  if (TypeIs_Array(n->value.type) && !TypeIs_String(n->value.type)) {
-    symbol.value = ArrayInitializerList(n);
-  } else if (false /* TODO: Array subscripting */) {
+  SetSymbolValue(scope, t, s.value);
+}
 
+void Assignment(AST_Node *n) {
+  if (n->middle != NULL && !TypeIs_String(n->data_type)) {
+    AssignElement(n->token, n->middle, VALUE(n->left));
+    VALUE(n) = VALUE(n->left);
+    return;
+  }
+
+  SymbolTable *scope = ScopeOf(n->token);
+  Symbol symbol = (IsIn(scope, n->token)) ? RetrieveFrom(scope, n->token)
+                                          : AddTo(scope, NewSymbol(n->token, n->data_type, DECL_DEFINED));
+  Value previous = symbol.value;
+
+  if (TypeIs_Array(n->data_type) && !TypeIs_String(n->data_type)) {
+    if (NodeHasFact(n->left, FACT_CONSTANT_DATA)) {
+      // Shared with every other declaration of it until written to
+      symbol.value = VALUE(n->left);
+    } else if (NodeIs_ArrayInitializerList(n->left)) {
+      symbol.value = ArrayInitializerList(n);
+    } else {
+      // Whole arrays are shared until one side writes to them
+      symbol.value = VALUE(n->left);
+    }
+  } else if (TypeIs_Slice(symbol.data_type) && !TypeIs_Slice(VALUE(n->left).type)) {
+    symbol.value = WholeSlice(VALUE(n->left));
   } else {
-    symbol.value = n->left->value;
+    symbol.value = VALUE(n->left);
   }
 
-  AddTo(SYMBOL_TABLE(), symbol);
-  n->value = symbol.value;
+  RetainValue(symbol.value);
+  ReleaseValue(previous);
+
+  SetSymbolValue(scope, n->token, symbol.value);
+  VALUE(n) = symbol.value;
 }
 
 void TerseAssignment(AST_Node *n) {
@@ -122,40 +272,48 @@ void TerseAssignment(AST_Node *n) {
 
   switch(n->token.type) {
     case PLUS_EQUALS: {
-      n->value = AddValues(identifier->value, value->value);
+      VALUE(n) = AddValues(VALUE(identifier), VALUE(value));
     } break;
     case MINUS_EQUALS: {
-      n->value = SubValues(identifier->value, value->value);
+      VALUE(n) = SubValues(VALUE(identifier), VALUE(value));
     } break;
     case TIMES_EQUALS: {
-      n->value = MulValues(identifier->value, value->value);
+      VALUE(n) = MulValues(VALUE(identifier), VALUE(value));
     } break;
     case DIVIDE_EQUALS: {
-      n->value = DivValues(identifier->value, value->value);
+      VALUE(n) = DivValues(VALUE(identifier), VALUE(value));
     } break;
     case MODULO_EQUALS: {
-      n->value = ModValues(identifier->value, value->value);
+      VALUE(n) = ModValues(VALUE(identifier), VALUE(value));
     } break;
 
     case BITWISE_OR_EQUALS: {
-      n->value = NewUintValue(identifier->value.as.uinteger | value->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(identifier).as.uinteger | VALUE(value).as.uinteger);
     } break;
     case BITWISE_AND_EQUALS: {
-      n->value = NewUintValue(identifier->value.as.uinteger & value->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(identifier).as.uinteger & VALUE(value).as.uinteger);
     } break;
     case BITWISE_XOR_EQUALS: {
-      n->value = NewUintValue(identifier->value.as.uinteger ^ value->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(identifier).as.uinteger ^ VALUE(value).as.uinteger);
     } break;
 
     default: Print("TerseAssignment(): Not implemented yet\n");
   }
 
-  SetValue(SYMBOL_TABLE(), identifier->token, n->value);
+  // 'a[i] += x' reads and writes one element
+  if (identifier->middle != NULL && !TypeIs_String(identifier->data_type)) {
+    AssignElement(identifier->token, identifier->middle, VALUE(n));
+    return;
+  }
+
+  RetainValue(VALUE(n));
+  ReleaseValue(VALUE(identifier));
+  SetSymbolValue(ScopeOf(identifier->token), identifier->token, VALUE(n));
 }
 
 void Unary(AST_Node *n) {
-  Type type = n->left->value.type;
-  Value value = n->left->value;
+  Type type = VALUE(n->left).type;
+  Value value = VALUE(n->left);
 
   switch(n->token.type) {
     case BITWISE_NOT: {
@@ -163,31 +321,31 @@ void Unary(AST_Node *n) {
 
       if (TypeIs_U8(type)) {
           uint8_t truncated = (~uint);
-          n->value = NewUintValue(truncated);
+          VALUE(n) = NewUintValue(truncated);
       } else if (TypeIs_U16(type)) {
           uint16_t truncated = (~uint);
-          n->value = NewUintValue(truncated);
+          VALUE(n) = NewUintValue(truncated);
       } else if (TypeIs_U32(type)) {
           uint32_t truncated = (~uint);
-          n->value = NewUintValue(truncated);
+          VALUE(n) = NewUintValue(truncated);
       } else if (TypeIs_U64(type)) {
           uint64_t truncated = (~uint);
-          n->value = NewUintValue(truncated);
+          VALUE(n) = NewUintValue(truncated);
       }
     } break;
     case LOGICAL_NOT: {
-      n->value = NewBoolValue(!(value.as.boolean));
+      VALUE(n) = NewBoolValue(!(value.as.boolean));
     } break;
     case MINUS: {
       if (TypeIs_Float(type)) {
-        n->value = NewFloatValue(-(value.as.floating));
+        VALUE(n) = NewFloatValue(-(value.as.floating));
         break;
       }
 
       if (TypeIs_Int(type)) {
-        n->value = NewIntValue(-(value.as.integer));
+        VALUE(n) = NewIntValue(-(value.as.integer));
       } else if (TypeIs_Uint(type)) {
-        n->value = NewUintValue(-(value.as.uinteger));
+        VALUE(n) = NewUintValue(-(value.as.uinteger));
       }
     } break;
     default: {
@@ -196,27 +354,36 @@ void Unary(AST_Node *n) {
   }
 }
 
+static bool IsWholeArray(Value v) {
+  return TypeIs_Array(v.type) && !TypeIs_String(v.type);
+}
+
 void BinaryArithmetic(AST_Node *n) {
+  if (IsWholeArray(VALUE(n->left)) || IsWholeArray(VALUE(n->right))) {
+    VALUE(n) = ElementWise(n->token.type, VALUE(n->left), VALUE(n->right));
+    return;
+  }
+
   switch(n->token.type) {
     case PLUS: {
-      n->value = AddValues(n->left->value,
-                           n->right->value);
+      VALUE(n) = AddValues(VALUE(n->left),
+                           VALUE(n->right));
     } break;
     case MINUS: {
-      n->value = SubValues(n->left->value,
-                           n->right->value);
+      VALUE(n) = SubValues(VALUE(n->left),
+                           VALUE(n->right));
     } break;
     case ASTERISK: {
-      n->value = MulValues(n->left->value,
-                           n->right->value);
+      VALUE(n) = MulValues(VALUE(n->left),
+                           VALUE(n->right));
     } break;
     case DIVIDE: {
-      n->value = DivValues(n->left->value,
-                           n->right->value);
+      VALUE(n) = DivValues(VALUE(n->left),
+                           VALUE(n->right));
     } break;
     case MODULO: {
-      n->value = ModValues(n->left->value,
-                           n->right->value);
+      VALUE(n) = ModValues(VALUE(n->left),
+                           VALUE(n->right));
     } break;
     default: {
       Print("BinaryArithmetic(): Not implemented yet\n");
@@ -225,30 +392,35 @@ void BinaryArithmetic(AST_Node *n) {
 }
 
 void BinaryLogical(AST_Node *n) {
+  if (IsWholeArray(VALUE(n->left)) || IsWholeArray(VALUE(n->right))) {
+    VALUE(n) = ElementWise(n->token.type, VALUE(n->left), VALUE(n->right));
+    return;
+  }
+
   switch(n->token.type) {
     case EQUALITY: {
-      n->value = Equality(n->left->value, n->right->value);
+      VALUE(n) = Equality(VALUE(n->left), VALUE(n->right));
     } break;
     case GREATER_THAN: {
-      n->value = GreaterThan(n->left->value, n->right->value);
+      VALUE(n) = GreaterThan(VALUE(n->left), VALUE(n->right));
     } break;
     case LESS_THAN: {
-      n->value = LessThan(n->left->value, n->right->value);
+      VALUE(n) = LessThan(VALUE(n->left), VALUE(n->right));
     } break;
     case GREATER_THAN_EQUALS: {
-      n->value = Not(GreaterThan(n->right->value, n->left->value));
+      VALUE(n) = Not(GreaterThan(VALUE(n->right), VALUE(n->left)));
     } break;
     case LESS_THAN_EQUALS: {
-      n->value = Not(LessThan(n->right->value, n->left->value));
+      VALUE(n) = Not(LessThan(VALUE(n->right), VALUE(n->left)));
     } break;
     case LOGICAL_NOT_EQUALS: {
-      n->value = Not(Equality(n->left->value, n->right->value));
+      VALUE(n) = Not(Equality(VALUE(n->left), VALUE(n->right)));
     } break;
     case LOGICAL_AND: {
-      n->value = LogicalAND(n->left->value, n->right->value);
+      VALUE(n) = LogicalAND(VALUE(n->left), VALUE(n->right));
     } break;
     case LOGICAL_OR: {
-      n->value = LogicalOR(n->left->value, n->right->value);
+      VALUE(n) = LogicalOR(VALUE(n->left), VALUE(n->right));
     } break;
     default: {
       Print("BinaryLogical(): %s not implemented yet\n", TokenTypeTranslation(n->token.type));
@@ -259,24 +431,24 @@ void BinaryLogical(AST_Node *n) {
 void BinaryBitwise(AST_Node *n) {
   switch(n->token.type) {
     case BITWISE_XOR: {
-      n->value = NewUintValue(n->left->value.as.uinteger ^
-                              n->right->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(n->left).as.uinteger ^
+                              VALUE(n->right).as.uinteger);
     } break;
     case BITWISE_OR: {
-      n->value = NewUintValue(n->left->value.as.uinteger |
-                              n->right->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(n->left).as.uinteger |
+                              VALUE(n->right).as.uinteger);
     } break;
     case BITWISE_AND: {
-      n->value = NewUintValue(n->left->value.as.uinteger &
-                              n->right->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(n->left).as.uinteger &
+                              VALUE(n->right).as.uinteger);
     } break;
     case BITWISE_LEFT_SHIFT: {
-      n->value = NewUintValue(n->left->value.as.uinteger <<
-                              n->right->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(n->left).as.uinteger <<
+                              VALUE(n->right).as.uinteger);
     } break;
     case BITWISE_RIGHT_SHIFT: {
-      n->value = NewUintValue(n->left->value.as.uinteger >>
-                              n->right->value.as.uinteger);
+      VALUE(n) = NewUintValue(VALUE(n->left).as.uinteger >>
+                              VALUE(n->right).as.uinteger);
     } break;
     default: {
       Print("BinaryBitwise(): Not implemented yet\n");
@@ -284,36 +456,110 @@ void BinaryBitwise(AST_Node *n) {
   }
 }
 
-void FunctionCall(AST_Node *n) {
+// Arrays and strings are passed by sharing the caller's copy, so the
+// cost doesn't depend on their size; see Assignment() for writes
+static Value ArgumentValue(AST_Node *arg) {
+  if (arg->node_type == FUNCTION_CALL_NODE) return VALUE(arg);
+  if (arg->left != NULL) return VALUE(arg->left);
+  if (arg->token.type == IDENTIFIER) return Lookup(arg->token).value;
+  if (arg->token.type == STRING_LITERAL) return VALUE(arg);
+
+  return NewValue(arg->data_type, arg->token);
+}
+
+/* A 'ref' param takes the caller's variable over for the call, reference
+ * and all, so writes to it happen in place instead of copying on write.
+ * A 'const ref' one reads it without taking a reference of its own */
+static Value BindParam(AST_Node *param, AST_Node *arg) {
+  // A 'ref T[]' param keeps the caller's array rather than a slice of it,
+  // which would be a second reference and force a copy on the first write
+  if (param->data_type.param_mode == PARAM_REF) return VALUE(arg);
+
+  // Other 'T[]' params are slices, so a whole array is passed as one
+  Value v = VALUE(arg);
+  if (TypeIs_Slice(param->data_type) && !TypeIs_Slice(v.type)) v = WholeSlice(v);
+
+  if (param->data_type.param_mode == PARAM_VALUE) RetainValue(v);
+  return v;
+}
+
+// The caller's variable gets back whatever its 'ref' param ended up holding
+static void UnbindRefParams(int caller_top, int caller_frame, AST_Node *params, AST_Node *args) {
+  for (; args != NULL; params = params->left, args = args->right) {
+    if (params->data_type.param_mode == PARAM_VALUE) continue;
+
+    Symbol s = RetrieveFrom(SYMBOL_TABLE(), params->token);
+    if (params->data_type.param_mode == PARAM_REF) {
+      SetSymbolValue(ScopeIn(caller_top, caller_frame, args->token), args->token, s.value);
+    }
+
+    // Nothing left for EndScope() to release
+    SetSymbolValue(SYMBOL_TABLE(), params->token, (Value){ .type = s.data_type });
+  }
+}
+
+static FunctionDefinition *FindFunction(Token name) {
   // Linear search for function definition (TODO: Hashtable)
-  AST_Node *fn_def = NULL;
-  for (int i = 0; i < fdi; i++) {
-    if (strncmp(n->token.position_in_source,
-                function_definitions[i]->token.position_in_source,
-                n->token.length) == 0)
-    {
-      fn_def = function_definitions[i];
-      break;
+  Isolate *isolate = CurrentIsolate();
+  for (int i = 0; i < isolate->function_count; i++) {
+    if (TokenValuesMatch(name, isolate->functions[i].definition->token)) {
+      return &isolate->functions[i];
     }
   }
 
-  if (fn_def == NULL) {
-    ERROR_AND_EXIT_FMTMSG(
-      "FunctionCall(): Couldn't find function definition for %.*s()",
-      n->token.length, n->token.position_in_source);
+  INTERPRETER_ERROR_FMTMSG("FunctionCall(): Couldn't find function definition for %.*s()",
+                           name.length, name.position_in_source);
+  return NULL;
+}
+
+/* Every node has one slot per isolate, so a call of a function that is
+ * already running would overwrite what its caller's nodes still hold.
+ * Those calls save the body's slots on the call frame and put them back */
+static Value *SaveSlots(FunctionDefinition *fn) {
+  if (fn->calls == 0) return NULL;
+
+  Isolate *isolate = CurrentIsolate();
+  int first = fn->definition->slot;
+  size_t bytes = (fn->end_slot - first) * sizeof(Value);
+
+  Value *saved = ArenaAlloc(&isolate->call_frames, bytes);
+  memcpy(saved, &isolate->values[first], bytes);
+  return saved;
+}
+
+static void RestoreSlots(FunctionDefinition *fn, Value *saved) {
+  if (saved == NULL) return;
+
+  int first = fn->definition->slot;
+  memcpy(&CurrentIsolate()->values[first], saved, (fn->end_slot - first) * sizeof(Value));
+}
+
+void FunctionCall(AST_Node *n) {
+  Isolate *isolate = CurrentIsolate();
+  FunctionDefinition *fn = FindFunction(n->token);
+  AST_Node *fn_def = fn->definition;
+
+  // Arguments are looked up in the caller's scope
+  for (AST_Node *arg = n->middle; arg != NULL; arg = arg->right) {
+    VALUE(arg) = ArgumentValue(arg);
   }
 
+  TraceBeginToken("runtime", fn_def->token);
+  ArenaMark frame = GetArenaMark(&isolate->call_frames);
+  Value *saved = SaveSlots(fn);
+
+  int caller_top = isolate->scope.depth;
+  int caller_frame = isolate->scope.frame;
   BeginScope();
+  isolate->scope.frame = isolate->scope.depth;
+  fn->calls++;
 
   // Create variables for all args
   AST_Node *params = fn_def->middle;
   AST_Node *args   = n->middle;
   while (args != NULL) {
-    Symbol s = AddTo(SYMBOL_TABLE(),
-                     NewSymbol(params->token,
-                               params->value.type,
-                               DECL_DEFINED));
-    s.value = NewValue(args->value.type, args->token);
+    Symbol s = NewSymbol(params->token, params->data_type, DECL_DEFINED);
+    s.value = BindParam(params, args);
     AddTo(SYMBOL_TABLE(), s);
 
     params = params->left;
@@ -322,10 +568,261 @@ void FunctionCall(AST_Node *n) {
 
   // Evaluate function body
   if (fn_def->right != NULL) {
-    InterpretRecurse(fn_def->right);
+    RunChain(fn_def->right);
   }
 
+  // The result is retained, see Return(), so the callee's scope can't free it
+  Value result = (isolate->flow == FLOW_RETURN) ? isolate->return_value : (Value){0};
+  isolate->flow = FLOW_NEXT;
+  isolate->return_value = (Value){0};
+
+  UnbindRefParams(caller_top, caller_frame, fn_def->middle, n->middle);
+  fn->calls--;
   EndScope();
+  isolate->scope.frame = caller_frame;
+
+  RestoreSlots(fn, saved);
+  ResetArenaTo(&isolate->call_frames, frame);
+
+  // Until the caller's statement ends, like any other intermediate result
+  ReleaseValueToTemporaries(result);
+  VALUE(n) = result;
+  TraceEnd("runtime");
+}
+
+static int64_t IntegerArgument(AST_Node *arg) {
+  return (TypeIs_Int(arg->data_type)) ? VALUE(arg->left).as.integer : (int64_t)VALUE(arg->left).as.uinteger;
+}
+
+// A declared map is NULL until its first write. Copy-on-write otherwise
+static MapValue *WritableMap(Symbol *s) {
+  if (s->value.as.map == NULL) {
+    s->value = (Value){ .type = s->data_type, .as.map = NewMapValue(s->data_type) };
+    RetainValue(s->value);
+  } else if (MapIsShared(s->value.as.map)) {
+    Value previous = s->value;
+    s->value.as.map = CopyMapValue(previous.as.map);
+
+    RetainValue(s->value);
+    ReleaseValue(previous);
+  }
+
+  return s->value.as.map;
+}
+
+// The memory order is always the last argument
+static memory_order OrderArgument(AST_Node *args) {
+  while (args->right != NULL) args = args->right;
+  return MemoryOrderOf(args->left->token);
+}
+
+void BuiltinCall(AST_Node *n) {
+  // Bit intrinsics on literals and include_bytes(), see BuiltinCall() in type_checker.c
+  if (NodeHasFact(n, FACT_CONSTANT_DATA)) return;
+
+  Builtin builtin = LookupBuiltin(n->token);
+  AST_Node *args = n->middle;
+
+  if (IsBitIntrinsic(builtin)) {
+    uint64_t y = (args->right != NULL) ? VALUE(args->right->left).as.uinteger : 0;
+    VALUE(n) = ApplyBitIntrinsic(builtin, args->data_type, VALUE(args->left).as.uinteger, y);
+    return;
+  }
+
+  switch (builtin) {
+    case BUILTIN_SUM:
+    case BUILTIN_MIN:
+    case BUILTIN_MAX: {
+      VALUE(n) = Reduce(builtin, VALUE(args->left));
+    } break;
+    case BUILTIN_FIND: {
+      VALUE(n) = NewIntValue(StringValueFind(&VALUE(args->left), &VALUE(args->right->left)));
+    } break;
+    case BUILTIN_CONTAINS: {
+      if (TypeIs_Map(args->data_type)) {
+        VALUE(n) = NewBoolValue(MapContains(VALUE(args->left).as.map, VALUE(args->right->left)));
+        break;
+      }
+
+      VALUE(n) = NewBoolValue(StringValueFind(&VALUE(args->left), &VALUE(args->right->left)) >= 0);
+    } break;
+    case BUILTIN_SHUFFLE: {
+      VALUE(n) = Shuffle(VALUE(args->left), VALUE(args->right->left));
+    } break;
+    case BUILTIN_LOAD: {
+      if (TypeIs_Atomic(args->data_type)) {
+        VALUE(n) = AtomicLoad(VALUE(args->left).as.atomic, OrderArgument(args));
+        break;
+      }
+
+      VALUE(n) = LoadVector(VALUE(args->left), IntegerArgument(args->right), n->data_type);
+    } break;
+    case BUILTIN_STORE: {
+      if (TypeIs_Atomic(args->data_type)) {
+        AtomicStore(VALUE(args->left).as.atomic, VALUE(args->right->left), OrderArgument(args));
+        break;
+      }
+
+      // Copy-on-write, like assigning to a single element
+      Symbol s = Lookup(args->left->token);
+      StoreVector(WritableArray(&s), IntegerArgument(args->right), VALUE(args->right->right->left));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_INSERT: {
+      Symbol s = Lookup(args->left->token);
+      MapInsert(WritableMap(&s), VALUE(args->right->left), VALUE(args->right->right->left));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_GET: {
+      if (!MapGet(VALUE(args->left).as.map, VALUE(args->right->left), &VALUE(n))) {
+        INTERPRETER_ERROR("get(): Key is not in the map");
+      }
+    } break;
+    case BUILTIN_REMOVE: {
+      Symbol s = Lookup(args->left->token);
+      VALUE(n) = NewBoolValue(MapRemove(WritableMap(&s), VALUE(args->right->left)));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_RESERVE: {
+      Symbol s = Lookup(args->left->token);
+      if (TypeIs_Vec(args->data_type)) {
+        VecReserve(WritableVec(&s), IntegerArgument(args->right));
+      } else {
+        MapReserve(WritableMap(&s), IntegerArgument(args->right));
+      }
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_ELEMENT_COUNT: {
+      Value container = VALUE(args->left);
+      VALUE(n) = NewIntValue((TypeIs_Vec(args->data_type))   ? VecCount(container.as.vec)
+                           : (TypeIs_Slice(args->data_type)) ? SliceableLength(container)
+                                                             : MapCount(container.as.map));
+    } break;
+    case BUILTIN_KEY_AT: {
+      VALUE(n) = MapKeyAt(VALUE(args->left).as.map, IntegerArgument(args->right));
+    } break;
+    case BUILTIN_VALUE_AT: {
+      VALUE(n) = MapValueAt(VALUE(args->left).as.map, IntegerArgument(args->right));
+    } break;
+    case BUILTIN_PUSH: {
+      Symbol s = Lookup(args->left->token);
+      VecPush(WritableVec(&s), VALUE(args->right->left));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_POP: {
+      Symbol s = Lookup(args->left->token);
+      VALUE(n) = VecPop(WritableVec(&s));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_SHRINK: {
+      Symbol s = Lookup(args->left->token);
+      VecShrink(WritableVec(&s));
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+    } break;
+    case BUILTIN_CAPACITY: {
+      VALUE(n) = NewIntValue(VecCapacity(VALUE(args->left).as.vec));
+    } break;
+    case BUILTIN_TO_VEC: {
+      VALUE(n) = (Value){ .type = n->data_type, .as.vec = ArrayToVec(VALUE(args->left).as.array) };
+    } break;
+    case BUILTIN_TO_ARRAY: {
+      VecValue *vec = VALUE(args->left).as.vec;
+      if (VecCount(vec) != n->data_type.array_size) {
+        INTERPRETER_ERROR("to_array(): The vec's count doesn't match the array size");
+      }
+
+      VALUE(n) = (Value){ .type = n->data_type, .as.array = VecToArray(vec, args->data_type) };
+    } break;
+    case BUILTIN_FETCH_ADD: {
+      VALUE(n) = AtomicFetchAdd(VALUE(args->left).as.atomic, VALUE(args->right->left), OrderArgument(args));
+    } break;
+    case BUILTIN_FETCH_OR: {
+      VALUE(n) = AtomicFetchOr(VALUE(args->left).as.atomic, VALUE(args->right->left), OrderArgument(args));
+    } break;
+    case BUILTIN_COMPARE_EXCHANGE: {
+      AST_Node *desired = args->right->right;
+      VALUE(n) = AtomicCompareExchange(VALUE(args->left).as.atomic, VALUE(args->right->left), VALUE(desired->left), OrderArgument(args));
+    } break;
+    case BUILTIN_SEND: {
+      ChanSend(VALUE(args->left).as.chan, VALUE(args->right->left));
+    } break;
+    case BUILTIN_TRY_SEND: {
+      VALUE(n) = NewBoolValue(ChanTrySend(VALUE(args->left).as.chan, VALUE(args->right->left)) == CHAN_OK);
+    } break;
+    case BUILTIN_RECV:
+    case BUILTIN_TRY_RECV: {
+      Symbol s = Lookup(args->right->left->token);
+      Value element;
+      bool received = (builtin == BUILTIN_RECV) ? ChanRecv(VALUE(args->left).as.chan, &element)
+                                                : ChanTryRecv(VALUE(args->left).as.chan, &element) == CHAN_OK;
+
+      // Like Assignment(), the variable lets go of what it held before
+      if (received) {
+        RetainValue(element);
+        ReleaseValue(s.value);
+        SetSymbolValue(ScopeOf(s.token), s.token, element);
+      }
+
+      VALUE(n) = NewBoolValue(received);
+    } break;
+    case BUILTIN_CLOSE: {
+      ChanClose(VALUE(args->left).as.chan);
+    } break;
+    case BUILTIN_SEND_BATCH: {
+      Value from = VALUE(args->right->left);
+      if (TypeIs_Slice(args->right->data_type)) {
+        ChanSendBatch(VALUE(args->left).as.chan, from.as.slice.base, from.as.slice.offset, from.as.slice.count);
+      } else {
+        ChanSendBatch(VALUE(args->left).as.chan, from.as.array, 0, from.as.array->count);
+      }
+    } break;
+    case BUILTIN_RECV_BATCH: {
+      // Copy-on-write, like store()
+      Symbol s = Lookup(args->right->left->token);
+      ArrayValue *into = WritableArray(&s);
+
+      int64_t received = ChanRecvBatch(VALUE(args->left).as.chan, into, into->count);
+      SetSymbolValue(ScopeOf(s.token), s.token, s.value);
+
+      VALUE(n) = NewIntValue(received);
+    } break;
+    default: {
+      INTERPRETER_ERROR("BuiltinCall(): Unhandled builtin");
+    } break;
+  }
+}
+
+/* Locals come into being when they're declared; globals were copied in
+ * with the program, see NewIsolate(). Arrays start out zero-filled, and
+ * atomics and chans get their storage here too, see atomic.h and chan.h */
+void Declaration(AST_Node *n) {
+  if (TypeIs_Function(n->data_type)) return;
+
+  // 'a[i]' on an array that was declared but not yet assigned
+  if (n->middle != NULL) {
+    Identifier(n);
+    return;
+  }
+
+  SymbolTable *scope = SYMBOL_TABLE();
+  Symbol s = (IsIn(scope, n->token)) ? RetrieveFrom(scope, n->token)
+                                     : AddTo(scope, NewSymbol(n->token, n->data_type, DECL_DECLARED));
+
+  Value previous = s.value;
+
+  if (TypeIs_Atomic(s.data_type)) {
+    s.value = (Value){ .type = s.data_type, .as.atomic = NewAtomicValue(s.data_type) };
+  } else if (TypeIs_Chan(s.data_type)) {
+    s.value = (Value){ .type = s.data_type, .as.chan = NewChanValue(s.data_type) };
+  } else if (TypeIs_Array(s.data_type) && !TypeIs_String(s.data_type)) {
+    s.value = (Value){ .type = s.data_type, .as.array = NewArrayValue(s.data_type.specifier, s.data_type.array_size) };
+  } else {
+    return;
+  }
+
+  RetainValue(s.value);
+  ReleaseValue(previous);
+  SetSymbolValue(scope, n->token, s.value);
 }
 
 void StructDeclaration(AST_Node *struct_identifier) {
@@ -342,7 +839,7 @@ void StructDeclaration(AST_Node *struct_identifier) {
     SetStructValue(SYMBOL_TABLE(),
                    struct_identifier->token,
                    (*current)->token,
-                   (*current)->left->value);
+                   VALUE((*current)->left));
     */
     current = &(*current)->right;
   }
@@ -357,63 +854,170 @@ void StructMemberAccess(AST_Node *struct_identifier) {
   }
 
   // TODO: Need to store Struct Values somewhere
-  //struct_identifier->value = GetStructValue(SYMBOL_TABLE(), struct_identifier->right->token, struct_identifier->token);
+  //VALUE(struct_identifier) = GetStructValue(SYMBOL_TABLE(), struct_identifier->right->token, struct_identifier->token);
 }
 
-void PrefixIncrement(AST_Node *n) {
-  Symbol s = RetrieveFrom(SYMBOL_TABLE(), n->left->token);
-  if (TypeIs_Int(s.value.type)) {
-    s.value.as.integer++;
-  } else {
-    s.value.as.uinteger++;
+// '++' and '--' wrap around at the variable's declared width
+static Value Step(Token t, int64_t delta) {
+  SymbolTable *scope = ScopeOf(t);
+  Symbol s = RetrieveFrom(scope, t);
+  Value v = s.value;
+
+  switch (s.data_type.specifier) {
+    case T_I8:  v.as.integer = (int8_t)(v.as.integer + delta);   break;
+    case T_I16: v.as.integer = (int16_t)(v.as.integer + delta);  break;
+    case T_I32: v.as.integer = (int32_t)(v.as.integer + delta);  break;
+    case T_U8:  v.as.uinteger = (uint8_t)(v.as.uinteger + delta);  break;
+    case T_U16: v.as.uinteger = (uint16_t)(v.as.uinteger + delta); break;
+    case T_U32: v.as.uinteger = (uint32_t)(v.as.uinteger + delta); break;
+    default:    v.as.uinteger += delta; break;
   }
-  Symbol stored_symbol = AddTo(SYMBOL_TABLE(), s);
 
-  n->value = stored_symbol.value;
+  SetSymbolValue(scope, t, v);
+  return v;
+}
+
+void PrefixIncrement(AST_Node *n) {
+  VALUE(n) = Step(n->left->token, 1);
 }
 
 void PostfixIncrement(AST_Node *n) {
-  Symbol s = RetrieveFrom(SYMBOL_TABLE(), n->token);
-  n->value = s.value;
+  VALUE(n) = Lookup(n->token).value;
+  Step(n->token, 1);
+}
 
-  if (TypeIs_Int(s.value.type)) {
-    s.value.as.integer++;
-  } else {
-    s.value.as.uinteger++;
+void PrefixDecrement(AST_Node *n) {
+  VALUE(n) = Step(n->left->token, -1);
+}
+
+void PostfixDecrement(AST_Node *n) {
+  VALUE(n) = Lookup(n->token).value;
+  Step(n->token, -1);
+}
+
+/* === Control Flow === */
+static bool Condition(AST_Node *condition) {
+  int temporaries = TemporariesMark();
+  InterpretRecurse(condition);
+  ReleaseTemporaries(temporaries);
+
+  return VALUE(condition).as.boolean;
+}
+
+// Runs a block in a scope of its own
+static void Block(AST_Node *block) {
+  BeginScope();
+  RunChain(block);
+  EndScope();
+}
+
+void If(AST_Node *n) {
+  if (Condition(n->left)) {
+    Block(n->middle);
+  } else if (n->right != NULL) {
+    if (NodeIs_If(n->right)) {
+      If(n->right);
+    } else {
+      Block(n->right);
+    }
   }
+}
+
+void TernaryIf(AST_Node *n) {
+  AST_Node *branch = (Condition(n->left)) ? n->middle : n->right;
 
-  AddTo(SYMBOL_TABLE(), s);
+  InterpretRecurse(branch);
+  VALUE(n) = VALUE(branch);
 }
 
-void PrefixDecrement(AST_Node *n) {
-  Symbol s = RetrieveFrom(SYMBOL_TABLE(), n->left->token);
-  if (TypeIs_Int(s.value.type)) {
-    s.value.as.integer--;
-  } else {
-    s.value.as.uinteger--;
+/* A 'for' loop's step is the last statement of its body (see ForStmt()
+ * in parser.c), so a 'continue' that skips the rest of the body runs
+ * it on its own */
+static void Loop(AST_Node *while_node, AST_Node *step) {
+  Isolate *isolate = CurrentIsolate();
+
+  while (Condition(while_node->left)) {
+    Block(while_node->right);
+
+    if (isolate->flow == FLOW_CONTINUE) {
+      isolate->flow = FLOW_NEXT;
+      if (step != NULL) RunStatement(step);
+    }
+
+    if (isolate->flow == FLOW_BREAK) {
+      isolate->flow = FLOW_NEXT;
+      break;
+    }
+
+    if (isolate->flow == FLOW_RETURN) break;
   }
-  Symbol stored_symbol = AddTo(SYMBOL_TABLE(), s);
+}
 
-  n->value = stored_symbol.value;
+void While(AST_Node *n) {
+  Loop(n, NULL);
 }
 
-void PostfixDecrement(AST_Node *n) {
-  Symbol s = RetrieveFrom(SYMBOL_TABLE(), n->left->token);
-  n->value = s.value;
+void For(AST_Node *n) {
+  AST_Node *last = n->right->right;
+  while (last->right != NULL) last = last->right;
 
-  if (TypeIs_Int(s.value.type)) {
-    s.value.as.integer--;
-  } else {
-    s.value.as.uinteger--;
+  BeginScope();
+  RunStatement(n->left);
+  Loop(n->right, last->left);
+  EndScope();
+}
+
+/* The value is retained so the scopes between here and the call can't
+ * free it, see FunctionCall() */
+void Return(AST_Node *n) {
+  Isolate *isolate = CurrentIsolate();
+
+  if (n->left != NULL) {
+    InterpretRecurse(n->left);
+    isolate->return_value = VALUE(n->left);
+    RetainValue(isolate->return_value);
   }
 
-  AddTo(SYMBOL_TABLE(), s);
+  isolate->flow = FLOW_RETURN;
+}
+
+static void DefineFunction(AST_Node *n) {
+  Isolate *isolate = CurrentIsolate();
+  ReserveFunctions(isolate, isolate->function_count + 1);
+
+  isolate->functions[isolate->function_count++] = (FunctionDefinition){
+    .definition = n,
+    .end_slot = EndSlot(n),
+  };
+}
+
+// A statement's temporaries die with it
+static void RunStatement(AST_Node *statement) {
+  int temporaries = TemporariesMark();
+  InterpretRecurse(statement);
+  ReleaseTemporaries(temporaries);
+}
+
+// Runs the statements of a chain in order, up to a break, continue or return
+static void RunChain(AST_Node *chain) {
+  Isolate *isolate = CurrentIsolate();
+
+  for (; chain != NULL && isolate->flow == FLOW_NEXT; chain = chain->right) {
+    if (chain->left != NULL) RunStatement(chain->left);
+  }
 }
 
 static void InterpretRecurse(AST_Node *n) {
-  if (NodeIs_Function(n)) {
-    function_definitions[fdi++] = n;
-    return;
+  switch (n->node_type) {
+    case FUNCTION_NODE:   DefineFunction(n); return;
+    case IF_NODE:         If(n);             return;
+    case TERNARY_IF_NODE: TernaryIf(n);      return;
+    case WHILE_NODE:      While(n);          return;
+    case FOR_NODE:        For(n);            return;
+    case RETURN_NODE:     Return(n);         return;
+    case BREAK_NODE:    CurrentIsolate()->flow = FLOW_BREAK;    return;
+    case CONTINUE_NODE: CurrentIsolate()->flow = FLOW_CONTINUE; return;
+    default: break;
   }
 
   if (!NodeIs_NULL(n->left))   InterpretRecurse(n->left);
@@ -424,6 +1028,9 @@ static void InterpretRecurse(AST_Node *n) {
     case STRUCT_DECLARATION_NODE: {
       StructDeclaration(n);
     } break;
+    case DECLARATION_NODE: {
+      Declaration(n);
+    } break;
     case STRUCT_MEMBER_IDENTIFIER_NODE: {
       StructMemberAccess(n);
     } break;
@@ -466,19 +1073,51 @@ static void InterpretRecurse(AST_Node *n) {
     case FUNCTION_CALL_NODE: {
       FunctionCall(n);
     } break;
-    case RETURN_NODE: {
+    case BUILTIN_CALL_NODE: {
+      BuiltinCall(n);
     } break;
     default: break;
   }
 }
 
-void Interpret(AST_Node *root, SymbolTable *st) {
-  Scope.locals[Scope.depth] = st;
+void RunIsolate(Isolate *isolate) {
+  Isolate *previous = EnterIsolate(isolate);
+  RunChain(isolate->program->root);
+  EnterIsolate(previous);
+}
+
+/* The run main() makes stays current until FinishInterpreting(), so
+ * what's printed on exit is its globals and its heap. Streaming
+ * compiles one statement at a time into 'st', so its isolate starts
+ * with no code and gets each statement as it comes */
+static Program main_program;
+static Isolate *main_isolate;
+
+static void BeginRun(AST_Node *root, SymbolTable *st) {
+  main_program = NewProgram(root, st);
+  main_isolate = NewIsolate(&main_program);
+
+  EnterIsolate(main_isolate);
+  DebugRegisterSymbolTable(main_isolate->globals);
+}
+
+// Runs one top-level statement, see CompileStreaming()
+void InterpretStatement(AST_Node *statement, SymbolTable *st) {
+  if (main_isolate == NULL) BeginRun(NULL, st);
+
+  AddToIsolate(main_isolate, statement);
+  RunStatement(statement);
+}
+
+void FinishInterpreting(SymbolTable *st) {
+  if (main_isolate == NULL) return;
 
-  InterpretRecurse(root);
+  DeleteIsolate(main_isolate);
+  main_isolate = NULL;
+  DebugRegisterSymbolTable(st);
 }
-#endif
 
 void Interpret(AST_Node *root, SymbolTable *st) {
-  PrintAST(root);
+  BeginRun(root, st);
+  RunChain(root);
 }
@@ -2,8 +2,15 @@
 #define INTERPRETER_H
 
 #include "ast.h"
+#include "isolate.h"
 #include "symbol_table.h"
 
+// Both leave the run current until FinishInterpreting(), see main.c
 void Interpret(AST_Node *root, SymbolTable *st);
+void InterpretStatement(AST_Node *statement, SymbolTable *st);
+void FinishInterpreting(SymbolTable *st);
+
+// Runs the isolate's program on the calling thread, see isolate.h
+void RunIsolate(Isolate *isolate);
 
 #endif
@@ -1,7 +1,14 @@
+// For MAP_ANONYMOUS, which -std=c11 leaves out of <sys/mman.h>
+#define _DEFAULT_SOURCE
+
 #include <errno.h>  // for errno
+#include <fcntl.h>  // for open
 #include <stdio.h>  // for fopen et al.
 #include <stdlib.h> // for malloc
-#include <string.h> // for strerror
+#include <string.h> // for strerror, strrchr
+#include <sys/mman.h> // for mmap
+#include <sys/stat.h> // for fstat
+#include <unistd.h>   // for close, sysconf
 
 #include "common.h"
 #include "error.h"
@@ -29,6 +36,58 @@ int ReadFile(const char *filename, char **dest) {
   return bytes_read;
 }
 
+// 'path' is taken relative to the directory holding 'relative_to', unless it's absolute
+char *ResolvePath(const char *relative_to, const char *path, int path_length) {
+  const char *last_slash = strrchr(relative_to, '/');
+  int directory_length = (path[0] == '/' || last_slash == NULL) ? 0 : last_slash - relative_to + 1;
+
+  StringBuilder sb = NewStringBuilder(directory_length + path_length + ROOM_FOR_NULL_BYTE);
+  AppendStringL(&sb, relative_to, directory_length);
+  AppendStringL(&sb, path, path_length);
+
+  return BuildString(&sb);
+}
+
+/* Maps a file read-only, with 'header_size' writable bytes directly in
+ * front of its contents so a caller can put its own header there
+ * instead of copying the file. Returns the start of that header, or
+ * NULL with errno set. The mapping is never unmapped */
+void *MapFile(const char *filename, size_t header_size, size_t *filesize) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat s;
+  if (fstat(fd, &s) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  size_t header_pages = (header_size + page_size - 1) / page_size * page_size;
+  size_t size = (size_t)s.st_size;
+
+  unsigned char *base = mmap(NULL, header_pages + size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  // The file replaces the anonymous pages after the header
+  if (size > 0 &&
+      mmap(base + header_pages, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    int saved_errno = errno;
+    munmap(base, header_pages + size);
+    close(fd);
+    errno = saved_errno;
+    return NULL;
+  }
+
+  close(fd);
+
+  *filesize = size;
+  return base + header_pages - header_size;
+}
+
 void PrintSourceLine(const char *filename, int line_number) {
   char buf[200];
 
@@ -3,7 +3,11 @@
 
 #include "token.h"
 
+#include <stddef.h> // for size_t
+
 int ReadFile(const char *filename, char **dest);
+char *ResolvePath(const char *relative_to, const char *path, int path_length);
+void *MapFile(const char *filename, size_t header_size, size_t *filesize);
 void PrintSourceLine(const char *filename, int line_number);
 void PrintSourceLineOfToken(Token t);
 
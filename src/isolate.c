@@ -0,0 +1,125 @@
+#include <stdlib.h> // for calloc, realloc, free
+
+#include "error.h"
+#include "isolate.h"
+
+static _Thread_local Isolate *current;
+
+/* === Slots === */
+static void GrowValues(Isolate *isolate, int count) {
+  if (count <= isolate->value_count) return;
+
+  Value *values = realloc(isolate->values, count * sizeof(Value));
+  if (values == NULL) INTERPRETER_ERROR("GrowValues(): Out of memory");
+
+  isolate->values = values;
+  isolate->value_count = count;
+}
+
+// Slots start out as what compiling left in the nodes
+static void SeedValue(AST_Node *n, void *isolate) {
+  ((Isolate *)isolate)->values[n->slot] = n->value;
+}
+
+static void SeedValues(Isolate *isolate, AST_Node *root) {
+  VisitNodes(root, SeedValue, isolate);
+}
+
+/* === Scopes and Functions === */
+// Doubles 'capacity' until it holds 'count'
+static void *Reserve(void *data, int *capacity, int count, size_t size) {
+  if (count <= *capacity) return data;
+
+  int grown = (*capacity > 0) ? *capacity : 8;
+  while (grown < count) grown *= 2;
+
+  data = realloc(data, grown * size);
+  if (data == NULL) INTERPRETER_ERROR("Reserve(): Out of memory");
+
+  *capacity = grown;
+  return data;
+}
+
+void ReserveScopes(Isolate *isolate, int depth) {
+  isolate->scope.locals = Reserve(isolate->scope.locals, &isolate->scope.capacity, depth + 1, sizeof(SymbolTable *));
+}
+
+void ReserveFunctions(Isolate *isolate, int count) {
+  isolate->functions = Reserve(isolate->functions, &isolate->function_capacity, count, sizeof(FunctionDefinition));
+}
+
+/* === Programs === */
+Program NewProgram(AST_Node *root, SymbolTable *symbols) {
+  return (Program){
+    .root = root,
+    .symbols = symbols,
+    .node_count = NumberNodes(root, 0),
+  };
+}
+
+/* === Isolates === */
+Isolate *NewIsolate(const Program *program) {
+  Isolate *isolate = calloc(1, sizeof(Isolate));
+  if (isolate == NULL) INTERPRETER_ERROR("NewIsolate(): Out of memory");
+
+  isolate->program = program;
+  isolate->heap = NewHeapState();
+
+  isolate->globals = NewSymbolTable();
+  CopyNewSymbols(isolate->globals, program->symbols);
+  ReserveScopes(isolate, 0);
+  isolate->scope.locals[0] = isolate->globals;
+
+  GrowValues(isolate, program->node_count);
+  SeedValues(isolate, program->root);
+
+  return isolate;
+}
+
+void DeleteIsolate(Isolate *isolate) {
+  if (current == isolate) EnterIsolate(NULL);
+
+  // Values are released into the heap that allocated them
+  HeapState *previous = UseHeapState(isolate->heap);
+  ReleaseSymbolValues(isolate->globals);
+  UseHeapState(previous);
+
+  DeleteHeapState(isolate->heap);
+  DeleteSymbolTable(isolate->globals);
+  FreeArena(&isolate->call_frames);
+
+  free(isolate->scope.locals);
+  free(isolate->functions);
+  free(isolate->values);
+  free(isolate);
+}
+
+Isolate *EnterIsolate(Isolate *isolate) {
+  Isolate *previous = current;
+
+  current = isolate;
+  UseHeapState((isolate != NULL) ? isolate->heap : NULL);
+
+  return previous;
+}
+
+Isolate *CurrentIsolate() {
+  return current;
+}
+
+void AddToIsolate(Isolate *isolate, AST_Node *statement) {
+  int first = isolate->value_count;
+  GrowValues(isolate, NumberNodes(statement, first));
+  SeedValues(isolate, statement);
+
+  CopyNewSymbols(isolate->globals, isolate->program->symbols);
+}
+
+int64_t IsolateBytes(const Isolate *isolate) {
+  return (int64_t)sizeof(Isolate) +
+         (int64_t)isolate->value_count * (int64_t)sizeof(Value) +
+         (int64_t)isolate->scope.capacity * (int64_t)sizeof(SymbolTable *) +
+         (int64_t)isolate->function_capacity * (int64_t)sizeof(FunctionDefinition) +
+         SymbolTableBytes(isolate->globals) +
+         HeapStateBytes(isolate->heap);
+}
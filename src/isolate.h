@@ -0,0 +1,102 @@
+/* Isolates: independent runs of one compiled program.
+ *
+ * A Program is what compiling produced: the AST with its types, the
+ * interned literals and constant arrays its nodes point to, and the
+ * globals as the type checker declared them. Once NewProgram() has
+ * numbered its nodes it is only ever read, so any number of isolates
+ * can run it at the same time, on any threads.
+ *
+ * An isolate holds everything a run writes: its own copy of the
+ * globals, its own heap (a HeapState, see heap.h), its own scopes and
+ * call frames, and a slot per AST node for the value that node last
+ * evaluated to. The slots start out as the compile-time values, so
+ * literals and constant data are shared rather than copied.
+ *
+ * A thread runs one isolate at a time and an isolate runs on one
+ * thread at a time. EnterIsolate() makes it current on the calling
+ * thread, which is thread-local state, so nothing on the way through
+ * a run takes a lock. Heap values can't move between isolates: an
+ * object is freed by the heap that allocated it.
+ */
+
+#ifndef ISOLATE_H
+#define ISOLATE_H
+
+#include <stdint.h>
+
+#include "arena.h"
+#include "ast.h"
+#include "heap.h"
+#include "symbol_table.h"
+
+typedef struct {
+  AST_Node *root;
+  SymbolTable *symbols;
+  int node_count;
+} Program;
+
+// How the last statement finished, for the loops and calls running it
+typedef enum {
+  FLOW_NEXT,
+  FLOW_BREAK,
+  FLOW_CONTINUE,
+  FLOW_RETURN,
+} Flow;
+
+typedef struct {
+  AST_Node *definition;
+  int end_slot; // one past its last node's, see EndSlot()
+  int calls;    // of it that are running now
+} FunctionDefinition;
+
+typedef struct Isolate {
+  const Program *program;
+  HeapState *heap;
+  SymbolTable *globals;
+
+  Value *values; // indexed by AST_Node.slot
+  int value_count;
+
+  struct {
+    int depth;
+    int frame; // the running call's outermost scope, 0 outside any call
+    SymbolTable **locals; // [0] is the globals, see ReserveScopes()
+    int capacity;
+  } scope;
+
+  Flow flow;
+  Value return_value;
+
+  /* Arrays that escape analysis proved function-local (FACT_NO_ESCAPE)
+   * are allocated here and released on return */
+  Arena call_frames;
+
+  FunctionDefinition *functions; // see ReserveFunctions()
+  int function_count;
+  int function_capacity;
+} Isolate;
+
+// Numbers the nodes. The program is read-only from here on
+Program NewProgram(AST_Node *root, SymbolTable *symbols);
+
+Isolate *NewIsolate(const Program *program);
+void DeleteIsolate(Isolate *isolate); // frees its heap objects too
+
+// Makes 'isolate' the one this thread runs and switches to its heap.
+// Returns the isolate it replaces; NULL leaves none current
+Isolate *EnterIsolate(Isolate *isolate);
+Isolate *CurrentIsolate();
+
+// For a statement compiled after the isolate was made, see
+// CompileStreaming(): numbers it, gives it slots, and copies the
+// globals it declared
+void AddToIsolate(Isolate *isolate, AST_Node *statement);
+
+// Make room for scopes up to 'depth' and for 'count' functions
+void ReserveScopes(Isolate *isolate, int depth);
+void ReserveFunctions(Isolate *isolate, int count);
+
+// What the isolate itself takes, not counting its heap objects
+int64_t IsolateBytes(const Isolate *isolate);
+
+#endif
@@ -4,15 +4,7 @@
 #include "lexer.h"
 #include "token_type.h"
 
-struct {
-  const char *start;
-  const char *end;
-
-  // For helpful error messages
-  int current_line;
-  int current_x_offset;
-  const char *src_filename;
-} Lexer;
+LexerState Lexer;
 
 void InitLexer(const char *filename, const char *contents) {
   Lexer.start = contents;
@@ -22,6 +14,14 @@ void InitLexer(const char *filename, const char *contents) {
   Lexer.src_filename = filename;
 }
 
+LexerState SaveLexerState() {
+  return Lexer;
+}
+
+void RestoreLexerState(LexerState state) {
+  Lexer = state;
+}
+
 static int LexemeLength() {
   return Lexer.end - Lexer.start;
 }
@@ -157,7 +157,8 @@ static Token Number() {
 
   while (IsNumber(Peek())) Advance();
 
-  if (Peek() == '.' && !IsNumber(PeekNext())) {
+  // '1..4' is a range, not a float
+  if (Peek() == '.' && PeekNext() != '.' && !IsNumber(PeekNext())) {
     return MakeErrorToken("Invalid float literal");
   }
 
@@ -215,6 +216,29 @@ static Token SkipToEOF() {
   return MakeToken(TOKEN_EOF);
 }
 
+// A scalar type name followed by 'x' and a lane count, e.g. 'f32x4'.
+// Whether the shape fits a register is up to the parser
+static bool IsVectorType() {
+  static const char *const lane_types[] = {
+    "i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64", "f32", "f64", "bool",
+  };
+
+  for (size_t i = 0; i < sizeof(lane_types) / sizeof(lane_types[0]); i++) {
+    int len = strlen(lane_types[i]);
+    const char *x = Lexer.start + len;
+
+    if (Lexer.end - x < 2 || memcmp(Lexer.start, lane_types[i], len) != 0 || *x != 'x') continue;
+
+    for (const char *c = x + 1; c < Lexer.end; c++) {
+      if (!IsNumber(*c)) return false;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
 static TokenType IdentifierType() {
   if (LexemeEquals( "i8", 2)) return I8;
   if (LexemeEquals("i16", 3)) return I16;
@@ -237,6 +261,12 @@ static TokenType IdentifierType() {
 
   if (LexemeEquals("enum", 4)) return ENUM;
   if (LexemeEquals("struct", 6)) return STRUCT;
+  if (LexemeEquals("map", 3)) return MAP;
+  if (LexemeEquals("vec", 3)) return VEC;
+  if (LexemeEquals("atomic", 6)) return ATOMIC;
+  if (LexemeEquals("chan", 4)) return CHAN;
+
+  if (IsVectorType()) return VECTOR_TYPE;
 
   if (LexemeEquals("if", 2)) return IF;
   if (LexemeEquals("else", 4)) return ELSE;
@@ -247,9 +277,17 @@ static TokenType IdentifierType() {
   if (LexemeEquals("continue", 8)) return CONTINUE;
   if (LexemeEquals("return", 6)) return RETURN;
 
+  if (LexemeEquals("const", 5)) return CONST;
+  if (LexemeEquals("ref", 3)) return REF;
+
   if (LexemeEquals("true", 4))  return BOOL_LITERAL;
   if (LexemeEquals("false", 5)) return BOOL_LITERAL;
 
+  if (LexemeEquals("relaxed", 7)) return MEMORY_ORDER_LITERAL;
+  if (LexemeEquals("acquire", 7)) return MEMORY_ORDER_LITERAL;
+  if (LexemeEquals("release", 7)) return MEMORY_ORDER_LITERAL;
+  if (LexemeEquals("seq_cst", 7)) return MEMORY_ORDER_LITERAL;
+
   return IDENTIFIER;
 }
 
@@ -280,7 +318,7 @@ Token ScanToken() {
     case ')': return MakeToken(RPAREN);
     case '[': return MakeToken(LBRACKET);
     case ']': return MakeToken(RBRACKET);
-    case '.': return MakeToken(PERIOD);
+    case '.': return MakeToken(Match('.') ? DOT_DOT : PERIOD);
     case ',': return MakeToken(COMMA);
     case ':': return MakeToken(Match(':') ? COLON_SEPARATOR : COLON);
     case ';': return MakeToken(SEMICOLON);
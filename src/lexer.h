@@ -3,7 +3,21 @@
 
 #include "token.h"
 
+typedef struct {
+  const char *start;
+  const char *end;
+
+  // For helpful error messages
+  int current_line;
+  int current_x_offset;
+  const char *src_filename;
+} LexerState;
+
 void InitLexer(const char *filename, const char *contents);
 Token ScanToken();
 
+// For looking further ahead than the parser's own lookahead tokens
+LexerState SaveLexerState();
+void RestoreLexerState(LexerState state);
+
 #endif
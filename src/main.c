@@ -1,26 +1,57 @@
+#include <stdbool.h>
 #include <stddef.h> // for NULL
+#include <string.h> // for strncmp, strcmp
 
 #include "ast.h"
 #include "compiler.h"
+#include "heap.h"
 #include "interpreter.h"
 #include "io.h"
 #include "symbol_table.h"
+#include "trace.h"
 
 int main(int argc, char **argv) {
   char *filename = "test.txt";
+  bool heap_stats = false;
+  bool reports = false;
+  bool streaming = false;
 
-  if (argc == 2) {
-    filename = argv[1];
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--trace=", 8) == 0) {
+      InitTrace(&argv[i][8]);
+    } else if (strcmp(argv[i], "--heap-stats") == 0) {
+      heap_stats = true;
+    } else if (strcmp(argv[i], "--reports") == 0) {
+      reports = true;
+    } else if (strcmp(argv[i], "--stream") == 0) {
+      streaming = true;
+    } else {
+      filename = argv[i];
+    }
   }
 
   char *contents = NULL;
   ReadFile(filename, &contents);
 
   SymbolTable *st = NewSymbolTable();
-  AST_Node *compiled_code = Compile(filename, contents, st);
 
-  Interpret(compiled_code, st);
+  if (streaming) {
+    // Each statement runs as soon as it's compiled
+    CompileStreaming(filename, contents, st, InterpretStatement);
+  } else {
+    AST_Node *compiled_code = Compile(filename, contents, st);
 
+    TraceBegin("runtime", "Interpret");
+    Interpret(compiled_code, st);
+    TraceEnd("runtime");
+  }
+
+  if (reports) PrintCompilerReports();
+
+  // Of the run, which is still current
+  if (heap_stats) PrintHeapStats();
   DebugReportErrorCode();
+
+  FinishInterpreting(st);
   return 0;
 }
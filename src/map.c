@@ -0,0 +1,403 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h> // for memcpy, memcmp, memset
+
+#include "error.h"
+#include "map.h"
+#include "str.h"
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+  #define HAVE_SSE2_GROUPS 1
+#else
+  #define HAVE_SSE2_GROUPS 0
+#endif
+
+#define CTRL_EMPTY   ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+
+#define W MAP_GROUP_WIDTH
+
+typedef uint32_t GroupMask; // bit i is slot i of the group
+
+/* === Control Bytes === */
+#if HAVE_SSE2_GROUPS
+static GroupMask MatchByte(const int8_t *group, int8_t byte) {
+  __m128i control = _mm_loadu_si128((const __m128i *)group);
+  return (GroupMask)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(byte)));
+}
+
+// Empty and deleted are the only control bytes with the top bit set
+static GroupMask MatchFree(const int8_t *group) {
+  return (GroupMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+#else
+static GroupMask MatchByte(const int8_t *group, int8_t byte) {
+  GroupMask mask = 0;
+  for (int i = 0; i < W; i++) {
+    if (group[i] == byte) mask |= 1u << i;
+  }
+
+  return mask;
+}
+
+static GroupMask MatchFree(const int8_t *group) {
+  GroupMask mask = 0;
+  for (int i = 0; i < W; i++) {
+    if (group[i] < 0) mask |= 1u << i;
+  }
+
+  return mask;
+}
+#endif
+
+static int8_t H2(uint64_t hash) {
+  return (int8_t)(hash & 0x7F);
+}
+
+typedef struct {
+  int64_t group;
+  int64_t step;
+  int64_t mask;
+} Probe;
+
+static Probe StartProbe(const MapValue *m, uint64_t hash) {
+  int64_t mask = m->capacity / W - 1;
+  return (Probe){ .group = (int64_t)(hash >> 7) & mask, .step = 0, .mask = mask };
+}
+
+// Triangular steps visit every group once when the group count is a power of two
+static void NextGroup(Probe *p) {
+  p->step++;
+  p->group = (p->group + p->step) & p->mask;
+}
+
+/* === Keys and Values === */
+static uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+
+  return x;
+}
+
+static uint64_t ScalarBits(Value v, enum TypeSpecifier t) {
+  switch (t) {
+    case T_I8: case T_I16: case T_I32: case T_I64: return (uint64_t)v.as.integer;
+    case T_U8: case T_U16: case T_U32: case T_U64: return v.as.uinteger;
+    case T_CHAR: return (unsigned char)v.as.character;
+    case T_BOOL: return v.as.boolean;
+    case T_F32: case T_F64: {
+      uint64_t bits;
+      memcpy(&bits, &v.as.floating, sizeof(bits));
+      return bits;
+    }
+    default: INTERPRETER_ERROR("ScalarBits(): Not a map key or value type");
+  }
+
+  return 0;
+}
+
+// Heap strings cache their hash, inline ones are short enough to hash every time
+static uint64_t KeyHash(Value key, enum TypeSpecifier t) {
+  if (t != T_STRING) return Mix(ScalarBits(key, t));
+
+  if (StringValueIsSmall(&key)) {
+    return Mix(HashChars(StringValueData(&key), StringValueLength(&key)));
+  }
+
+  return Mix(StringHash(key.as.string));
+}
+
+static bool KeyMatches(const MapEntry *e, const MapValue *m, uint64_t hash, Value *key) {
+  if (e->hash != hash) return false;
+  if (m->key_type != T_STRING) return e->key == ScalarBits(*key, m->key_type);
+
+  String *s = (String *)(uintptr_t)e->key;
+  int64_t length = StringValueLength(key);
+
+  return StringLength(s) == length &&
+         memcmp(StringData(s), StringValueData(key), length) == 0;
+}
+
+// Strings are stored as a counted reference to a heap string
+static uint64_t StoreBits(Value v, enum TypeSpecifier t) {
+  if (t != T_STRING) return ScalarBits(v, t);
+
+  String *s = HeapString(v);
+  Retain(&s->header);
+
+  return (uint64_t)(uintptr_t)s;
+}
+
+static void ReleaseBits(uint64_t bits, enum TypeSpecifier t) {
+  if (t == T_STRING) Release(&((String *)(uintptr_t)bits)->header);
+}
+
+static Value LoadBits(uint64_t bits, enum TypeSpecifier t) {
+  if (t == T_STRING) return NewStringValue((String *)(uintptr_t)bits);
+
+  Value v = { .type = { .specifier = t } };
+  switch (t) {
+    case T_I8: case T_I16: case T_I32: case T_I64: v.as.integer = (int64_t)bits; break;
+    case T_U8: case T_U16: case T_U32: case T_U64: v.as.uinteger = bits; break;
+    case T_CHAR: v.as.character = (char)bits; break;
+    case T_BOOL: v.as.boolean = (bits != 0); break;
+    case T_F32: case T_F64: memcpy(&v.as.floating, &bits, sizeof(bits)); break;
+    default: INTERPRETER_ERROR("LoadBits(): Not a map key or value type");
+  }
+
+  return v;
+}
+
+/* === Table === */
+static int64_t FindSlot(MapValue *m, Value key, uint64_t hash) {
+  if (m == NULL || m->count == 0) return -1;
+
+  Probe p = StartProbe(m, hash);
+  while (true) {
+    const int8_t *group = m->control + p.group * W;
+
+    for (GroupMask match = MatchByte(group, H2(hash)); match != 0; match &= match - 1) {
+      int64_t slot = p.group * W + __builtin_ctz(match);
+      if (KeyMatches(&m->entries[m->slots[slot]], m, hash, &key)) return slot;
+    }
+
+    if (MatchByte(group, CTRL_EMPTY) != 0) return -1;
+    NextGroup(&p);
+  }
+}
+
+static int64_t SlotOfEntry(MapValue *m, int64_t index) {
+  uint64_t hash = m->entries[index].hash;
+
+  Probe p = StartProbe(m, hash);
+  while (true) {
+    const int8_t *group = m->control + p.group * W;
+
+    for (GroupMask match = MatchByte(group, H2(hash)); match != 0; match &= match - 1) {
+      int64_t slot = p.group * W + __builtin_ctz(match);
+      if (m->slots[slot] == index) return slot;
+    }
+
+    NextGroup(&p);
+  }
+}
+
+static int64_t FreeSlot(MapValue *m, uint64_t hash) {
+  Probe p = StartProbe(m, hash);
+  while (true) {
+    GroupMask free = MatchFree(m->control + p.group * W);
+    if (free != 0) return p.group * W + __builtin_ctz(free);
+
+    NextGroup(&p);
+  }
+}
+
+static int64_t MaxLoad(int64_t capacity) {
+  return capacity - capacity / 8;
+}
+
+// Rebuilds the index from the cached hashes, which also drops every deleted slot
+static void Rehash(MapValue *m, int64_t capacity) {
+  HeapFree(m->control, m->capacity * sizeof(int8_t));
+  HeapFree(m->slots, m->capacity * sizeof(uint32_t));
+
+  m->capacity = capacity;
+  m->control = HeapAlloc(capacity * sizeof(int8_t));
+  m->slots = HeapAlloc(capacity * sizeof(uint32_t));
+  memset(m->control, CTRL_EMPTY, capacity);
+
+  for (int64_t i = 0; i < m->count; i++) {
+    int64_t slot = FreeSlot(m, m->entries[i].hash);
+    m->control[slot] = H2(m->entries[i].hash);
+    m->slots[slot] = (uint32_t)i;
+  }
+
+  m->growth_left = MaxLoad(capacity) - m->count;
+}
+
+static void ReserveEntries(MapValue *m, int64_t count) {
+  if (count <= m->entries_capacity) return;
+  if (count > UINT32_MAX) INTERPRETER_ERROR("Map has too many entries");
+
+  MapEntry *entries = HeapAlloc(count * sizeof(MapEntry));
+  if (m->count > 0) memcpy(entries, m->entries, m->count * sizeof(MapEntry));
+  HeapFree(m->entries, m->entries_capacity * sizeof(MapEntry));
+
+  m->entries = entries;
+  m->entries_capacity = count;
+}
+
+// Mostly deleted slots are cleaned up in place, otherwise the table doubles
+static void MakeRoomForOne(MapValue *m) {
+  if (m->count == m->entries_capacity) {
+    ReserveEntries(m, (m->entries_capacity < 8) ? 8 : m->entries_capacity * 2);
+  }
+
+  if (m->capacity == 0) {
+    Rehash(m, W);
+  } else if (m->growth_left == 0) {
+    Rehash(m, (m->count + 1 > m->capacity / 2) ? m->capacity * 2 : m->capacity);
+  }
+}
+
+// A group with an empty slot was never full, so no probe has gone past it
+static void ClearSlot(MapValue *m, int64_t slot) {
+  const int8_t *group = m->control + (slot / W) * W;
+
+  if (MatchByte(group, CTRL_EMPTY) != 0) {
+    m->control[slot] = CTRL_EMPTY;
+    m->growth_left++;
+  } else {
+    m->control[slot] = CTRL_DELETED;
+  }
+}
+
+/* === Maps === */
+MapValue *NewMapValue(Type map_type) {
+  MapValue *m = NewHeapObject(HEAP_MAP, sizeof(MapValue));
+  m->key_type = map_type.key_specifier;
+  m->value_type = map_type.value_specifier;
+
+  m->count = 0;
+  m->entries_capacity = 0;
+  m->entries = NULL;
+
+  m->capacity = 0;
+  m->growth_left = 0;
+  m->control = NULL;
+  m->slots = NULL;
+
+  return m;
+}
+
+MapValue *CopyMapValue(MapValue *source) {
+  MapValue *copy = NewMapValue((Type){ .key_specifier = source->key_type, .value_specifier = source->value_type });
+  if (source->count == 0) return copy;
+
+  ReserveEntries(copy, source->count);
+  memcpy(copy->entries, source->entries, source->count * sizeof(MapEntry));
+  copy->count = source->count;
+
+  for (int64_t i = 0; i < copy->count; i++) {
+    if (copy->key_type == T_STRING) Retain(&((String *)(uintptr_t)copy->entries[i].key)->header);
+    if (copy->value_type == T_STRING) Retain(&((String *)(uintptr_t)copy->entries[i].value)->header);
+  }
+
+  copy->capacity = source->capacity;
+  copy->growth_left = source->growth_left;
+  copy->control = HeapAlloc(source->capacity * sizeof(int8_t));
+  copy->slots = HeapAlloc(source->capacity * sizeof(uint32_t));
+  memcpy(copy->control, source->control, source->capacity * sizeof(int8_t));
+  memcpy(copy->slots, source->slots, source->capacity * sizeof(uint32_t));
+
+  return copy;
+}
+
+bool MapIsShared(const MapValue *m) {
+  return m->header.refcount > 1;
+}
+
+void DropMapValue(MapValue *m) {
+  for (int64_t i = 0; i < m->count; i++) {
+    ReleaseBits(m->entries[i].key, m->key_type);
+    ReleaseBits(m->entries[i].value, m->value_type);
+  }
+
+  HeapFree(m->entries, m->entries_capacity * sizeof(MapEntry));
+  HeapFree(m->control, m->capacity * sizeof(int8_t));
+  HeapFree(m->slots, m->capacity * sizeof(uint32_t));
+}
+
+int64_t MapCount(const MapValue *m) {
+  return (m == NULL) ? 0 : m->count;
+}
+
+bool MapContains(MapValue *m, Value key) {
+  if (m == NULL) return false;
+
+  return FindSlot(m, key, KeyHash(key, m->key_type)) >= 0;
+}
+
+bool MapGet(MapValue *m, Value key, Value *value) {
+  if (m == NULL) return false;
+
+  int64_t slot = FindSlot(m, key, KeyHash(key, m->key_type));
+  if (slot < 0) return false;
+
+  *value = LoadBits(m->entries[m->slots[slot]].value, m->value_type);
+  return true;
+}
+
+void MapInsert(MapValue *m, Value key, Value value) {
+  uint64_t hash = KeyHash(key, m->key_type);
+
+  int64_t slot = FindSlot(m, key, hash);
+  if (slot >= 0) {
+    MapEntry *e = &m->entries[m->slots[slot]];
+    uint64_t previous = e->value;
+
+    e->value = StoreBits(value, m->value_type);
+    ReleaseBits(previous, m->value_type);
+    return;
+  }
+
+  MakeRoomForOne(m);
+
+  slot = FreeSlot(m, hash);
+  if (m->control[slot] == CTRL_EMPTY) m->growth_left--;
+
+  m->control[slot] = H2(hash);
+  m->slots[slot] = (uint32_t)m->count;
+  m->entries[m->count++] = (MapEntry){
+    .hash = hash,
+    .key = StoreBits(key, m->key_type),
+    .value = StoreBits(value, m->value_type),
+  };
+}
+
+// The last entry moves into the hole so the entries stay dense
+bool MapRemove(MapValue *m, Value key) {
+  if (m == NULL) return false;
+
+  int64_t slot = FindSlot(m, key, KeyHash(key, m->key_type));
+  if (slot < 0) return false;
+
+  int64_t index = m->slots[slot];
+  ClearSlot(m, slot);
+  ReleaseBits(m->entries[index].key, m->key_type);
+  ReleaseBits(m->entries[index].value, m->value_type);
+
+  int64_t last = m->count - 1;
+  if (index != last) {
+    m->entries[index] = m->entries[last];
+    m->slots[SlotOfEntry(m, last)] = (uint32_t)index;
+  }
+
+  m->count--;
+  return true;
+}
+
+void MapReserve(MapValue *m, int64_t count) {
+  ReserveEntries(m, count);
+
+  int64_t capacity = (m->capacity == 0) ? W : m->capacity;
+  while (MaxLoad(capacity) < count) capacity *= 2;
+
+  if (capacity > m->capacity) Rehash(m, capacity);
+}
+
+Value MapKeyAt(MapValue *m, int64_t index) {
+  if (index < 0 || index >= MapCount(m)) INTERPRETER_ERROR("Map index out of bounds");
+
+  return LoadBits(m->entries[index].key, m->key_type);
+}
+
+Value MapValueAt(MapValue *m, int64_t index) {
+  if (index < 0 || index >= MapCount(m)) INTERPRETER_ERROR("Map index out of bounds");
+
+  return LoadBits(m->entries[index].value, m->value_type);
+}
@@ -0,0 +1,72 @@
+/* Runtime values of 'map<K, V>'.
+ *
+ * Entries live in one dense array in insertion order, so iterating is
+ * a walk over [0, count) (MapKeyAt(), MapValueAt()). remove() moves
+ * the last entry into the hole, which is the only thing that changes
+ * the order. Each entry keeps its key's hash, so growing the table
+ * and comparing string keys never rehash a string.
+ *
+ * The index into the entries is an open-addressing table laid out in
+ * groups of MAP_GROUP_WIDTH slots. Every slot has a control byte that
+ * is either empty, deleted, or the low 7 bits of the hash of the key
+ * it holds. A lookup picks a group from the rest of the hash and
+ * compares all of that group's control bytes at once (one SSE2 compare
+ * on x86, a loop elsewhere), so only slots whose 7 bits match are ever
+ * compared against the key. Groups are probed in triangular order,
+ * which visits every group once, and a group with an empty slot ends
+ * the probe. The table grows once 7/8 of the slots have been used.
+ *
+ * Maps are reference counted and copied on write like arrays (see
+ * value.h). A map variable that was declared but never written to
+ * holds NULL, which every read treats as an empty map.
+ */
+
+#ifndef MAP_H
+#define MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "heap.h"
+#include "value.h"
+
+#define MAP_GROUP_WIDTH 16
+
+typedef struct MapEntry {
+  uint64_t hash;
+  uint64_t key;   // the key's bits, or a String*
+  uint64_t value; // the value's bits, or a String*
+} MapEntry;
+
+typedef struct MapValue {
+  HeapObject header;
+  enum TypeSpecifier key_type;
+  enum TypeSpecifier value_type;
+
+  int64_t count;
+  int64_t entries_capacity;
+  MapEntry *entries;
+
+  int64_t capacity;    // slots, a power of two and a multiple of MAP_GROUP_WIDTH
+  int64_t growth_left; // empty slots that can be used before growing
+  int8_t *control;
+  uint32_t *slots;     // index into 'entries' for each full slot
+} MapValue;
+
+MapValue *NewMapValue(Type map_type);
+MapValue *CopyMapValue(MapValue *source);
+bool MapIsShared(const MapValue *m);
+void DropMapValue(MapValue *m);
+
+int64_t MapCount(const MapValue *m);
+bool MapContains(MapValue *m, Value key);
+bool MapGet(MapValue *m, Value key, Value *value); // false if absent
+void MapInsert(MapValue *m, Value key, Value value);
+bool MapRemove(MapValue *m, Value key);            // false if absent
+void MapReserve(MapValue *m, int64_t count);
+
+// 'index' is in [0, MapCount())
+Value MapKeyAt(MapValue *m, int64_t index);
+Value MapValueAt(MapValue *m, int64_t index);
+
+#endif
@@ -1,15 +1,21 @@
 #include <stdio.h>
 
+#include <float.h> // for FLT_MAX
 #include <limits.h> // for LONG_MIN and LONG_MAX (strtol error checking)
 #include <stdarg.h> // for va_list
 #include <stdbool.h>
-#include <stdlib.h> // for malloc
+#include <stdlib.h> // for malloc, strtol
+#include <string.h> // for memchr, strncmp
 
 #include "ast.h"
+#include "builtins.h"
+#include "chan.h"
 #include "common.h"
+#include "constant_data.h"
 #include "error.h"
 #include "io.h"
 #include "lexer.h"
+#include "trace.h"
 
 static bool IN_LOOP = false;
 
@@ -46,6 +52,7 @@ static SymbolTable *SYMBOL_TABLE();
 static AST_Node *StructMemberAccess(Token struct_name);
 static AST_Node *FunctionDeclaration(Token function_name);
 static AST_Node *FunctionCall(Token identifier);
+static AST_Node *BuiltinCall(Token identifier);
 static AST_Node *InitializerList(Type expected_type);
 
 /* === Forward Declarations for Rules Table === */
@@ -94,9 +101,14 @@ static ParseRule Rules[] = {
 
   [BOOL]           = { TypeSpecifier, NULL, NO_PRECEDENCE },
   [VOID]           = { TypeSpecifier, NULL, NO_PRECEDENCE },
+  [VECTOR_TYPE]    = { TypeSpecifier, NULL, NO_PRECEDENCE },
 
   [ENUM]           = { Enum,     NULL, NO_PRECEDENCE },
   [STRUCT]         = { Struct,   NULL, NO_PRECEDENCE },
+  [MAP]            = { TypeSpecifier, NULL, NO_PRECEDENCE },
+  [VEC]            = { TypeSpecifier, NULL, NO_PRECEDENCE },
+  [ATOMIC]         = { TypeSpecifier, NULL, NO_PRECEDENCE },
+  [CHAN]           = { TypeSpecifier, NULL, NO_PRECEDENCE },
 
   [BREAK]          = { Break,    NULL, NO_PRECEDENCE },
   [CONTINUE]       = { Continue, NULL, NO_PRECEDENCE },
@@ -114,6 +126,7 @@ static ParseRule Rules[] = {
   [CHAR_LITERAL]   = { Literal, NULL, NO_PRECEDENCE },
   [BOOL_LITERAL]   = { Literal, NULL, NO_PRECEDENCE },
   [STRING_LITERAL] = { Literal, NULL, NO_PRECEDENCE },
+  [MEMORY_ORDER_LITERAL] = { Literal, NULL, NO_PRECEDENCE },
 
   // Punctuators
   [LPAREN]         = { Parens,              NULL,      NO_PRECEDENCE },
@@ -152,10 +165,24 @@ static ParseRule Rules[] = {
 /* === Scope Related === */
 static struct {
   int depth;
-  SymbolTable *locals[10]; // TODO: figure out actual size or make dynamic array
+  int capacity;
+  SymbolTable **locals; // kept between parses, grown as blocks nest deeper
 } Scope;
 
+static void ReserveScopes(int depth) {
+  if (depth < Scope.capacity) return;
+
+  int grown = (Scope.capacity > 0) ? Scope.capacity * 2 : 16;
+  SymbolTable **locals = realloc(Scope.locals, grown * sizeof(SymbolTable *));
+  if (locals == NULL) COMPILER_ERROR("ReserveScopes(): Out of memory");
+
+  Scope.locals = locals;
+  Scope.capacity = grown;
+}
+
 static void BeginScope() {
+  ReserveScopes(Scope.depth + 1);
+
   Scope.depth++;
   Scope.locals[Scope.depth] = NewSymbolTable();
 }
@@ -234,6 +261,7 @@ static bool NextTokenIsAnyType() {
     case CHAR:
     case STRING:
     case VOID:
+    case VECTOR_TYPE:
     {
       return true;
     }
@@ -318,7 +346,8 @@ static void ConsumeAnyType(const char *msg, ...) {
       NextTokenIs(STRUCT) ||
       NextTokenIs(CHAR)   ||
       NextTokenIs(STRING) ||
-      NextTokenIs(VOID))
+      NextTokenIs(VOID)   ||
+      NextTokenIs(VECTOR_TYPE))
   {
     Advance();
     return;
@@ -380,6 +409,7 @@ static void ConsumeAnyTerseAssignment(const char *msg, ...) {
 }
 
 void InitParser(SymbolTable *st) {
+  ReserveScopes(0);
   Scope.depth = 0;
   Scope.locals[Scope.depth] = st;
 
@@ -430,27 +460,196 @@ static AST_Node *Parse(int PrecedenceLevel, bool prevent_assignment) {
   return (return_node == NULL) ? prefix_node : return_node;
 }
 
+// 'f32x4' is F32 with 4 lanes, see IsVectorType() in lexer.c
+static Type VectorType(Token type_token) {
+  static const struct { const char *name; TokenType type; } lane_types[] = {
+    { "i8",  I8  }, { "i16", I16 }, { "i32", I32 }, { "i64", I64 },
+    { "u8",  U8  }, { "u16", U16 }, { "u32", U32 }, { "u64", U64 },
+    { "f32", F32 }, { "f64", F64 }, { "bool", BOOL },
+  };
+
+  const char *x = memchr(type_token.position_in_source, 'x', type_token.length);
+  int name_length = x - type_token.position_in_source;
+  long lanes = strtol(x + 1, NULL, 10);
+
+  Type element = NoType();
+  for (size_t i = 0; i < sizeof(lane_types) / sizeof(lane_types[0]); i++) {
+    if ((int)strlen(lane_types[i].name) == name_length &&
+        strncmp(lane_types[i].name, type_token.position_in_source, name_length) == 0) {
+      element = NewType(lane_types[i].type);
+    }
+  }
+
+  if (!VectorShapeIsValid(element, lanes)) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, type_token, "'%.*s' doesn't fill a 128 or 256 bit register", type_token.length, type_token.position_in_source);
+  }
+
+  return NewVectorType(element, lanes);
+}
+
+static Type SliceType(Token type_token) {
+  if (type_token.type == STRING || type_token.type == VOID || type_token.type == VECTOR_TYPE) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, type_token, "Slices of %s are not supported", TokenTypeTranslation(type_token.type));
+  }
+
+  return NewSliceType(NewType(type_token.type));
+}
+
+static Type DeclaredType(Token type_token, bool is_array, int array_size) {
+  if (type_token.type == VECTOR_TYPE) {
+    if (is_array) {
+      ERROR_MSG(ERR_IMPROPER_DECLARATION, type_token, "Arrays of vectors are not supported");
+    }
+
+    return VectorType(type_token);
+  }
+
+  return (is_array) ? NewArrayType(type_token.type, array_size) : NewType(type_token.type);
+}
+
+// 'map<K, V>': keys are integers, chars, bools or strings, values any scalar or a string
+static Type MapTypeArguments() {
+  Consume(LESS_THAN, "MapTypeArguments(): Expected '<' after 'map', got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  ConsumeAnyType("MapTypeArguments(): Expected a key type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+  Token key = Parser.current;
+
+  Consume(COMMA, "MapTypeArguments(): Expected ',' after the key type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  ConsumeAnyType("MapTypeArguments(): Expected a value type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+  Token value = Parser.current;
+
+  Consume(GREATER_THAN, "MapTypeArguments(): Expected '>' after the value type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  switch (key.type) {
+    case I8: case I16: case I32: case I64:
+    case U8: case U16: case U32: case U64:
+    case CHAR: case BOOL: case STRING:
+      break;
+    default: {
+      ERROR_FMT(ERR_IMPROPER_DECLARATION, key, "Map keys can't be %s", TokenTypeTranslation(key.type));
+    }
+  }
+
+  if (value.type == VOID || value.type == STRUCT || value.type == VECTOR_TYPE) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, value, "Map values can't be %s", TokenTypeTranslation(value.type));
+  }
+
+  return NewMapType(NewType(key.type), NewType(value.type));
+}
+
+// 'vec<T>': the same element types as map values
+static Type VecTypeArgument() {
+  Consume(LESS_THAN, "VecTypeArgument(): Expected '<' after 'vec', got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  ConsumeAnyType("VecTypeArgument(): Expected an element type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+  Token element = Parser.current;
+
+  Consume(GREATER_THAN, "VecTypeArgument(): Expected '>' after the element type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  if (element.type == VOID || element.type == STRUCT || element.type == VECTOR_TYPE) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, element, "vec elements can't be %s", TokenTypeTranslation(element.type));
+  }
+
+  return NewVecType(NewType(element.type));
+}
+
+// 'atomic<T>': the types that have atomic instructions on every target
+static Type AtomicTypeArgument() {
+  Consume(LESS_THAN, "AtomicTypeArgument(): Expected '<' after 'atomic', got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  ConsumeAnyType("AtomicTypeArgument(): Expected a value type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+  Token value = Parser.current;
+
+  Consume(GREATER_THAN, "AtomicTypeArgument(): Expected '>' after the value type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  switch (value.type) {
+    case I32: case I64:
+    case U32: case U64:
+    case BOOL:
+      break;
+    default: {
+      ERROR_FMT(ERR_IMPROPER_DECLARATION, value, "atomic values can't be %s", TokenTypeTranslation(value.type));
+    }
+  }
+
+  return NewAtomicType(NewType(value.type));
+}
+
+// 'chan<T, N>': scalars, which move between threads without touching a refcount
+static Type ChanTypeArguments() {
+  Consume(LESS_THAN, "ChanTypeArguments(): Expected '<' after 'chan', got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  ConsumeAnyType("ChanTypeArguments(): Expected an element type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+  Token element = Parser.current;
+
+  Consume(COMMA, "ChanTypeArguments(): Expected ',' after the element type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  if (!Match(INT_LITERAL)) {
+    ERROR(ERR_MISSING_SIZE, Parser.next);
+  }
+  Token capacity = Parser.current;
+
+  Consume(GREATER_THAN, "ChanTypeArguments(): Expected '>' after the capacity, got '%s' instead", TokenTypeTranslation(Parser.next.type));
+
+  switch (element.type) {
+    case I8: case I16: case I32: case I64:
+    case U8: case U16: case U32: case U64:
+    case F32: case F64:
+    case CHAR: case BOOL:
+      break;
+    default: {
+      ERROR_FMT(ERR_IMPROPER_DECLARATION, element, "chan elements can't be %s", TokenTypeTranslation(element.type));
+    }
+  }
+
+  int64_t n = TokenToInt64(capacity);
+  if (n < 1 || n > CHAN_MAX_CAPACITY) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, capacity, "A chan holds 1 to %d elements, not %lld", CHAN_MAX_CAPACITY, (long long)n);
+  }
+
+  return NewChanType(NewType(element.type), (int)n);
+}
+
 static AST_Node *TypeSpecifier(bool) {
   Token type_token = Parser.current;
   bool is_array = false || type_token.type == STRING;
+  bool is_slice = false;
   long array_size = 0;
 
+  Type container_type = (type_token.type == MAP)    ? MapTypeArguments()
+                      : (type_token.type == VEC)    ? VecTypeArgument()
+                      : (type_token.type == ATOMIC) ? AtomicTypeArgument()
+                      : (type_token.type == CHAN)   ? ChanTypeArguments()
+                                                    : NoType();
+  bool is_container = TypeIs_Map(container_type) || TypeIs_Vec(container_type) ||
+                      TypeIs_Atomic(container_type) || TypeIs_Chan(container_type);
+
   if (Match(LBRACKET)) {
-    if (Match(MINUS)) {
-      ERROR_MSG(ERR_IMPROPER_DECLARATION, Parser.current, "Array size can't be negative.");
-    }
+    if (Match(DOT_DOT)) {
+      Consume(RBRACKET, "TypeSpecifier(): Expected ']' after '[..', got '%s' instead.", TokenTypeTranslation(Parser.next.type));
+      is_slice = true;
+    } else {
+      if (Match(MINUS)) {
+        ERROR_MSG(ERR_IMPROPER_DECLARATION, Parser.current, "Array size can't be negative.");
+      }
 
-    if (!Match(INT_LITERAL)) {
-      ERROR(ERR_MISSING_SIZE, Parser.next);
-    }
+      if (!Match(INT_LITERAL)) {
+        ERROR(ERR_MISSING_SIZE, Parser.next);
+      }
 
-    array_size = TokenToInt64(Parser.current);
+      array_size = TokenToInt64(Parser.current);
 
-    Consume(RBRACKET, "TypeSpecifier(): Expected ] after '%s', got '%s' instead.",
-            TokenTypeTranslation(Parser.current.type),
-            TokenTypeTranslation(Parser.next.type));
+      Consume(RBRACKET, "TypeSpecifier(): Expected ] after '%s', got '%s' instead.",
+              TokenTypeTranslation(Parser.current.type),
+              TokenTypeTranslation(Parser.next.type));
+
+      is_array = true;
+    }
+  }
 
-    is_array = true;
+  if ((is_array || is_slice) && is_container) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, type_token, "Arrays of %s are not supported", TypeTranslation(container_type));
   }
 
   Consume(IDENTIFIER, "TypeSpecifier(): Expected IDENTIFIER after Type '%s%s', got '%s' instead.",
@@ -470,10 +669,18 @@ static AST_Node *TypeSpecifier(bool) {
     ERROR_MSG(ERR_IMPROPER_DECLARATION, Parser.current, "Function declarations cannot be preceded by a type");
   }
 
-  Type type = (is_array) ? NewArrayType(type_token.type, array_size) : NewType(type_token.type);
-  AddTo(SYMBOL_TABLE(), NewSymbol(Parser.current, type, DECL_DECLARED));
+  Token identifier = Parser.current;
+  Type type = (is_container) ? container_type
+            : (is_slice)     ? SliceType(type_token)
+                             : DeclaredType(type_token, is_array, array_size);
+  AddTo(SYMBOL_TABLE(), NewSymbol(identifier, type, DECL_DECLARED));
+
+  AST_Node *declaration = Identifier(ASSIGNABLE);
 
-  return Identifier(ASSIGNABLE);
+  // Maps, vecs and chans start out empty and atomics at zero, so declaring one defines it
+  if (is_container) SetDecl(SYMBOL_TABLE(), identifier, DECL_DEFINED);
+
+  return declaration;
 }
 
 static AST_Node *Identifier(bool can_assign) {
@@ -483,7 +690,7 @@ static AST_Node *Identifier(bool can_assign) {
   AST_Node *array_index = NULL;
 
   if (Match(LPAREN)) {
-    if (NextTokenIsAnyType() ||
+    if (NextTokenIsAnyType() || NextTokenIs(REF) || NextTokenIs(CONST) ||
         (NextTokenIs(RPAREN) && TokenAfterNextIs(COLON_SEPARATOR)))
     { // Declaration
       if (is_in_symbol_table && !DECLARED(identifier_symbol)) {
@@ -495,6 +702,10 @@ static AST_Node *Identifier(bool can_assign) {
 
       return FunctionDeclaration(identifier_token);
     } else { // Function call
+      if (!is_in_symbol_table && LookupBuiltin(identifier_token) != BUILTIN_NONE) {
+        return BuiltinCall(identifier_token);
+      }
+
       if (!is_in_symbol_table) {
         ERROR(ERR_UNDECLARED, identifier_token);
       } else if (!DEFINED(identifier_symbol)) {
@@ -550,11 +761,10 @@ static AST_Node *Identifier(bool can_assign) {
         AST_Node *initializer_list = InitializerList(identifier_symbol.data_type);
         identifier_symbol = SetDecl(SYMBOL_TABLE(), identifier_token, DECL_DEFINED);
         return NewNodeFromSymbol(ASSIGNMENT_NODE, initializer_list, array_index, NULL, identifier_symbol);
-      } else if (array_index != NULL) {
-        /* Subscripting */
-      } else {
-        ERROR_MSG(ERR_IMPROPER_ASSIGNMENT, identifier_token, "Arrays are not assignable");
       }
+
+      // Anything else is either an element store or a whole-array
+      // expression like 'c = a * k + b', see Assignment() in type_checker.c
     }
 
     AST_Node *expr = Expression(_);
@@ -569,7 +779,7 @@ static AST_Node *Identifier(bool can_assign) {
     }
 
     AST_Node *terse_assignment = TerseAssignment(_);
-    terse_assignment->left = NewNodeFromSymbol(IDENTIFIER_NODE, NULL, NULL, NULL, identifier_symbol);
+    terse_assignment->left = NewNodeFromSymbol(IDENTIFIER_NODE, NULL, array_index, NULL, identifier_symbol);
     return terse_assignment;
   }
 
@@ -854,14 +1064,30 @@ static AST_Node *Parens(bool) {
   return parse_result;
 }
 
-static AST_Node *ArraySubscripting(bool) {
+static AST_Node *BuiltinCall(Token builtin_name) {
+  AST_Node *args = NULL;
+  AST_Node **current = &args;
+
+  while (!NextTokenIs(RPAREN) && !NextTokenIs(TOKEN_EOF)) {
+    AST_Node *expr = Expression(_);
+    (*current) = NewNodeFromToken(FUNCTION_ARGUMENT_NODE, expr, NULL, NULL, expr->token, expr->data_type);
+    current = &(*current)->right;
+
+    if (!Match(COMMA)) break;
+  }
+
+  Consume(RPAREN, "BuiltinCall(): Expected ')'");
+
+  return NewNodeFromToken(BUILTIN_CALL_NODE, NULL, args, NULL, builtin_name, NoType());
+}
+
+static AST_Node *SubscriptBound() {
   AST_Node *return_value = NULL;
 
   if (Match(IDENTIFIER)) {
-    Symbol symbol = RetrieveFrom(SYMBOL_TABLE(), Parser.current);
-    bool is_in_symbol_table = IsIn(SYMBOL_TABLE(), Parser.current);
+    Symbol symbol = ExistsInOuterScope(Parser.current);
 
-    if (!is_in_symbol_table) {
+    if (symbol.token.type == ERROR) {
       ERROR(ERR_UNDECLARED, Parser.current);
     }
 
@@ -869,11 +1095,26 @@ static AST_Node *ArraySubscripting(bool) {
       ERROR(ERR_UNINITIALIZED, Parser.current);
     }
 
-    return_value = NewNodeFromSymbol(ARRAY_SUBSCRIPT_NODE, NULL, NULL, NULL, symbol);
+    // Where it's used, not where it was declared, for error messages
+    return_value = NewNodeFromToken(ARRAY_SUBSCRIPT_NODE, NULL, NULL, NULL, Parser.current, symbol.data_type);
   } else if (Match(INT_LITERAL)) {
     return_value = NewNodeFromToken(ARRAY_SUBSCRIPT_NODE, NULL, NULL, NULL, Parser.current, NewType(Parser.current.type));
   }
 
+  return return_value;
+}
+
+// 'a[i]', or 'a[lo..hi]' where either bound can be left out
+static AST_Node *ArraySubscripting(bool) {
+  AST_Node *return_value = (NextTokenIs(DOT_DOT)) ? NULL : SubscriptBound();
+
+  if (Match(DOT_DOT)) {
+    Token range = Parser.current;
+    AST_Node *end = (NextTokenIs(RBRACKET)) ? NULL : SubscriptBound();
+
+    return_value = NewNodeFromToken(ARRAY_SLICE_NODE, return_value, NULL, end, range, NoType());
+  }
+
   Consume(RBRACKET, "ArraySubscripting(): Where's the ']'?");
 
   return return_value;
@@ -1031,7 +1272,7 @@ static void StructBody(AST_Node **struct_name) {
             TokenTypeTranslation(Parser.next.type));
 
     Token member_token = Parser.current;
-    Type member_type = (is_array) ? NewArrayType(type_token.type, array_size) : NewType(type_token.type);
+    Type member_type = DeclaredType(type_token, is_array, array_size);
 
     if (StructContainsMember((*struct_name)->data_type, member_token)) {
       ERROR(ERR_REDECLARED, member_token);
@@ -1074,7 +1315,136 @@ static AST_Node *Struct() {
   return struct_identifier;
 }
 
+/* === Dense Initializer Lists === */
+static bool IsNumberLiteral(TokenType t) {
+  return t == INT_LITERAL || t == HEX_LITERAL || t == BINARY_LITERAL || t == FLOAT_LITERAL;
+}
+
+static Token PrescanToken(int *scanned) {
+  Token t = (*scanned == 0) ? Parser.next
+          : (*scanned == 1) ? Parser.after_next
+          : ScanToken();
+
+  (*scanned)++;
+  return t;
+}
+
+/* Looks ahead to the closing '}' without consuming anything. True when
+ * every element is a number literal, optionally negated. A '-' right
+ * after a number is a subtraction, which takes the normal path */
+static bool IsDenseList() {
+  LexerState saved = SaveLexerState();
+  int scanned = 0;
+  int elements = 0;
+  bool element_start = true;
+  bool dense = false;
+
+  for (;;) {
+    Token t = PrescanToken(&scanned);
+
+    if (t.type == RCURLY) {
+      dense = (elements > 0);
+      break;
+    }
+
+    if (t.type == COMMA) {
+      if (element_start) break;
+      element_start = true;
+      continue;
+    }
+
+    if (t.type == MINUS) {
+      if (!element_start) break;
+      t = PrescanToken(&scanned);
+    }
+
+    if (!IsNumberLiteral(t.type)) break;
+
+    elements++;
+    element_start = false;
+  }
+
+  RestoreLexerState(saved);
+  return dense;
+}
+
+static void DenseOverflow(Token literal, Type list_type) {
+  ERROR_FMT(ERR_OVERFLOW, literal, "Literal value overflows target type '%s'", TypeTranslation(list_type));
+}
+
+// The same checks and conversions the type checker and NewValue() make for a single literal
+static Value DenseElement(Token literal, bool negative, Type list_type) {
+  if (TypeIs_Float(list_type)) {
+    if (DoubleOverflow(literal) || DoubleUnderflow(literal)) DenseOverflow(literal, list_type);
+
+    double d = TokenToDouble(literal);
+    if (TypeIs_F32(list_type) && (d < -FLT_MAX || d > FLT_MAX)) DenseOverflow(literal, list_type);
+
+    return NewFloatValue(negative ? -d : d);
+  }
+
+  if (literal.type == FLOAT_LITERAL) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, literal, "Can't convert from %s to %s",
+              TypeTranslation(NewType(literal.type)), TypeTranslation(list_type));
+  }
+
+  if (Uint64Overflow(literal)) DenseOverflow(literal, list_type);
+  uint64_t magnitude = TokenToUint64(literal);
+
+  if (TypeIs_Uint(list_type)) {
+    uint64_t max = (TypeIs_U8(list_type))  ? UINT8_MAX
+                 : (TypeIs_U16(list_type)) ? UINT16_MAX
+                 : (TypeIs_U32(list_type)) ? UINT32_MAX
+                 : UINT64_MAX;
+    if ((negative && magnitude != 0) || magnitude > max) DenseOverflow(literal, list_type);
+
+    return NewUintValue(magnitude);
+  }
+
+  uint64_t max = (TypeIs_I8(list_type))  ? INT8_MAX
+               : (TypeIs_I16(list_type)) ? INT16_MAX
+               : (TypeIs_I32(list_type)) ? INT32_MAX
+               : INT64_MAX;
+  if (magnitude > max + negative) DenseOverflow(literal, list_type); // one more below zero
+
+  return NewIntValue((negative && magnitude != 0) ? -(int64_t)(magnitude - 1) - 1 : (int64_t)magnitude);
+}
+
+/* A list of number literals for a numeric array skips the per-element
+ * nodes: each number is checked against the element type here and
+ * stored straight into a constant array that the list node holds */
+static AST_Node *DenseInitializerList(Type list_type) {
+  ArrayValue *array = NewConstantArray(list_type.specifier, list_type.array_size);
+  int64_t count = 0;
+
+  while (!Match(RCURLY)) {
+    bool negative = Match(MINUS);
+    Advance();
+
+    Value v = DenseElement(Parser.current, negative, list_type);
+
+    count++;
+    if (count > list_type.array_size) {
+      ERROR_FMT(ERR_TOO_MANY, Parser.current, "Too many elements (%d) in initializer list (array size is %d)", (int)count, list_type.array_size);
+    }
+
+    ArraySet(array, count - 1, v);
+    Match(COMMA);
+  }
+
+  AST_Node *n = NewNode(ARRAY_INITIALIZER_LIST_NODE, NULL, NULL, NULL, list_type);
+  n->value = (Value){ .type = list_type, .as.array = array };
+  AddNodeFact(n, FACT_CONSTANT_DATA);
+
+  return n;
+}
+/* === End Dense Initializer Lists === */
+
 static AST_Node *InitializerList(Type expected_type) {
+  if (TypeIs_Numeric(expected_type) && IsDenseList()) {
+    return DenseInitializerList(expected_type);
+  }
+
   AST_Node *n = NULL;
   AST_Node **current = &n;
 
@@ -1098,6 +1468,18 @@ static AST_Node *InitializerList(Type expected_type) {
   return n;
 }
 
+// 'ref T x' and 'const ref T x' name the caller's variable instead of copying it
+static enum ParamMode ParamModePrefix() {
+  if (Match(REF)) return PARAM_REF;
+
+  if (Match(CONST)) {
+    Consume(REF, "ParamModePrefix(): Expected 'ref' after 'const', got '%s' instead", TokenTypeTranslation(Parser.next.type));
+    return PARAM_CONST_REF;
+  }
+
+  return PARAM_VALUE;
+}
+
 static AST_Node *FunctionParams(Token function_name) {
   Symbol function = RetrieveFrom(SYMBOL_TABLE(), function_name);
 
@@ -1105,6 +1487,8 @@ static AST_Node *FunctionParams(Token function_name) {
   AST_Node **current = &params;
 
   while (!NextTokenIs(RPAREN) && !NextTokenIs(TOKEN_EOF)) {
+    enum ParamMode mode = ParamModePrefix();
+
     ConsumeAnyType("FunctionParams(): Expected a type, got '%s' instead", TokenTypeTranslation(Parser.next.type));
     Token type_token = Parser.current;
 
@@ -1121,7 +1505,11 @@ static AST_Node *FunctionParams(Token function_name) {
     Consume(IDENTIFIER, "FunctionParams(): Expected identifier after '(', got '%s' instead",
             TokenTypeTranslation(Parser.next.type));
     Token member_name = Parser.current;
-    Type member_type = (is_array) ? NewArrayType(type_token.type, 0) : NewType(type_token.type);
+    // An unsized array param takes a slice, so any part of an array can be passed without copying.
+    // A ref one is the caller's array itself, so its elements can be written
+    bool takes_slice = (is_array && type_token.type != STRING && mode == PARAM_VALUE);
+    Type member_type = (takes_slice) ? SliceType(type_token) : DeclaredType(type_token, is_array, 0);
+    member_type.param_mode = mode;
 
     if (FunctionHasParam(function.data_type, member_name) && !DECLARED(function)) {
       ERROR(ERR_REDECLARED, member_name);
@@ -1150,6 +1538,9 @@ static AST_Node *FunctionReturnType() {
   ConsumeAnyType("FunctionReturnType(): Expected a type after '::'");
 
   Token fn_return_type = Parser.current;
+  if (fn_return_type.type == VECTOR_TYPE) {
+    ERROR_MSG(ERR_IMPROPER_DECLARATION, fn_return_type, "Functions can't return vectors");
+  }
 
   return NewNodeFromToken(FUNCTION_RETURN_TYPE_NODE, NULL, NULL, NULL, fn_return_type, NewType(fn_return_type.type));
 }
@@ -1260,19 +1651,28 @@ static AST_Node *Literal(bool) {
   return NewNodeFromToken(LITERAL_NODE, NULL, NULL, NULL, Parser.current, t);
 }
 
+AST_Node *ParseStatement() {
+  if (Match(TOKEN_EOF)) return NULL;
+
+  TraceBeginToken("parser", Parser.next);
+  AST_Node *parse_result = Statement(_);
+  TraceEnd("parser");
+
+  if (parse_result == NULL) {
+    SetErrorCode(ERR_MISC);
+    COMPILER_ERROR("ParseStatement(): AST could not be created");
+  }
+
+  return parse_result;
+}
+
 AST_Node *ParserBuildAST() {
   AST_Node *root = NewNode(START_NODE, NULL, NULL, NULL, NoType());
 
   AST_Node **current_node = &root;
 
-  while (!Match(TOKEN_EOF)) {
-    AST_Node *parse_result = Statement(_);
-
-    if (parse_result == NULL) {
-      SetErrorCode(ERR_MISC);
-      COMPILER_ERROR("ParserBuildAST(): AST could not be created");
-    }
-
+  AST_Node *parse_result;
+  while ((parse_result = ParseStatement()) != NULL) {
     AST_Node *next_statement = NewNode(CHAIN_NODE, NULL, NULL, NULL, NoType());
 
     (*current_node)->left = parse_result;
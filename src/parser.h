@@ -6,5 +6,6 @@
 
 void InitParser(SymbolTable *symbol_table);
 AST_Node *ParserBuildAST();
+AST_Node *ParseStatement(); // one top-level statement, NULL at end of input
 
 #endif
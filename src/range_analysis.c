@@ -0,0 +1,975 @@
+/* Interval analysis over the type-checked AST.
+ *
+ * Every integer expression is annotated with the range of values it
+ * can take (AST_Node.range). Ranges come from literals, declared types,
+ * single assignments and comparisons that guard a branch or loop body.
+ *
+ * Variables are tracked by name in a flat environment that is copied
+ * at branches and merged afterwards. Merging always widens with the
+ * state from before the branch, which keeps the analysis sound when a
+ * block shadows an outer variable of the same name.
+ *
+ * The results are recorded as node facts:
+ *   - FACT_IN_BOUNDS on array subscripts that can't leave the array
+ *   - FACT_NO_OVERFLOW on integer operations that can't overflow
+ *
+ * Neither is added for a loop counter that only goes one way unless the
+ * loop condition stops it before it could wrap around its type.
+ *
+ * A subscript whose whole range lies outside the array is reported as
+ * ERR_IMPROPER_ACCESS. Any other subscript without FACT_IN_BOUNDS keeps
+ * its runtime bounds check.
+ */
+
+#include <stdint.h>
+#include <stdlib.h> // for strtoull
+
+#include "builtins.h"
+#include "common.h"
+#include "dynamic_array.h"
+#include "error.h"
+#include "range_analysis.h"
+
+typedef struct {
+  Token name;
+  Type type;
+  ValueRange range;
+  bool is_global;
+  bool may_wrap; // a loop counter not proven to stop short of the end of its type
+} Binding;
+
+USE_DYNAMIC_ARRAY(Binding)
+
+typedef enum {
+  MUT_NONE,
+  MUT_INCREASING,
+  MUT_DECREASING,
+  MUT_ARBITRARY,
+} MutationKind;
+
+static struct {
+  DA(Binding) env;
+  bool in_function;
+  RangeReport report;
+} Analysis;
+
+/* === Forward Declarations === */
+static ValueRange Expr(AST_Node *n);
+static void Walk(AST_Node *n);
+static TokenType MirrorComparison(TokenType op);
+static bool IsPlainVariable(AST_Node *n);
+
+/* === Ranges === */
+static ValueRange Unknown() {
+  return (ValueRange){0};
+}
+
+static ValueRange Between(int64_t min, int64_t max) {
+  return (ValueRange){ .known = true, .min = min, .max = max };
+}
+
+static bool IsEmpty(ValueRange r) {
+  return r.known && r.min > r.max;
+}
+
+static ValueRange TypeRange(Type t) {
+  switch (t.specifier) {
+    case T_I8:  return Between(INT8_MIN,  INT8_MAX);
+    case T_I16: return Between(INT16_MIN, INT16_MAX);
+    case T_I32: return Between(INT32_MIN, INT32_MAX);
+    case T_I64: return Between(INT64_MIN, INT64_MAX);
+
+    case T_U8:  return Between(0, UINT8_MAX);
+    case T_U16: return Between(0, UINT16_MAX);
+    case T_U32: return Between(0, UINT32_MAX);
+
+    default: return Unknown(); // U64 doesn't fit in the int64_t bounds
+  }
+}
+
+static bool Contains(ValueRange outer, ValueRange inner) {
+  return outer.known && inner.known &&
+         inner.min >= outer.min && inner.max <= outer.max;
+}
+
+static ValueRange Hull(ValueRange a, ValueRange b) {
+  if (IsEmpty(a)) return b;
+  if (IsEmpty(b)) return a;
+  if (!a.known || !b.known) return Unknown();
+
+  return Between((a.min < b.min) ? a.min : b.min,
+                 (a.max > b.max) ? a.max : b.max);
+}
+
+// Wrap-around or truncation makes any value of the type possible
+static ValueRange FitToType(ValueRange r, Type t) {
+  ValueRange type_range = TypeRange(t);
+  return (Contains(type_range, r)) ? r : type_range;
+}
+
+static ValueRange LiteralRange(Token t) {
+  int base = (t.type == HEX_LITERAL)    ? 16
+           : (t.type == BINARY_LITERAL) ?  2
+           : (t.type == INT_LITERAL)    ? 10
+           : 0;
+  if (base == 0) return Unknown();
+
+  // The sign is a separate unary node, so only the digits are read here
+  uint64_t u = strtoull(t.position_in_source, NULL, base);
+  if (u > INT64_MAX) return Unknown();
+
+  return Between(u, u);
+}
+
+static ValueRange Negate(ValueRange r) {
+  if (!r.known || r.min == INT64_MIN) return Unknown();
+  return Between(-r.max, -r.min);
+}
+
+static ValueRange FromCorners(int64_t c[4]) {
+  int64_t min = c[0], max = c[0];
+  for (int i = 1; i < 4; i++) {
+    if (c[i] < min) min = c[i];
+    if (c[i] > max) max = c[i];
+  }
+
+  return Between(min, max);
+}
+
+static ValueRange Arithmetic(TokenType op, ValueRange a, ValueRange b) {
+  if (!a.known || !b.known || IsEmpty(a) || IsEmpty(b)) return Unknown();
+
+  int64_t c[4];
+  bool overflow = false;
+
+  switch (op) {
+    case PLUS:
+    case PLUS_EQUALS: {
+      overflow |= __builtin_add_overflow(a.min, b.min, &c[0]);
+      overflow |= __builtin_add_overflow(a.max, b.max, &c[1]);
+      if (overflow) return Unknown();
+      return Between(c[0], c[1]);
+    }
+    case MINUS:
+    case MINUS_EQUALS: {
+      overflow |= __builtin_sub_overflow(a.min, b.max, &c[0]);
+      overflow |= __builtin_sub_overflow(a.max, b.min, &c[1]);
+      if (overflow) return Unknown();
+      return Between(c[0], c[1]);
+    }
+    case ASTERISK:
+    case TIMES_EQUALS: {
+      overflow |= __builtin_mul_overflow(a.min, b.min, &c[0]);
+      overflow |= __builtin_mul_overflow(a.min, b.max, &c[1]);
+      overflow |= __builtin_mul_overflow(a.max, b.min, &c[2]);
+      overflow |= __builtin_mul_overflow(a.max, b.max, &c[3]);
+      if (overflow) return Unknown();
+      return FromCorners(c);
+    }
+    case DIVIDE:
+    case DIVIDE_EQUALS: {
+      // Truncating division is monotonic on either side of zero
+      if (b.min <= 0 && b.max >= 0) return Unknown();
+      if (a.min == INT64_MIN && b.min <= -1 && b.max >= -1) return Unknown();
+
+      c[0] = a.min / b.min;
+      c[1] = a.min / b.max;
+      c[2] = a.max / b.min;
+      c[3] = a.max / b.max;
+      return FromCorners(c);
+    }
+    case MODULO:
+    case MODULO_EQUALS: {
+      if (b.min <= 0 && b.max >= 0) return Unknown();
+      if (b.min == INT64_MIN) return Unknown();
+
+      int64_t largest_divisor = (b.max > -b.min) ? b.max : -b.min;
+      int64_t limit = largest_divisor - 1;
+
+      // The remainder takes the sign of the dividend
+      if (a.min >= 0) return Between(0, (a.max < limit) ? a.max : limit);
+      if (a.max <= 0) return Between((a.min > -limit) ? a.min : -limit, 0);
+      return Between(-limit, limit);
+    }
+    default: return Unknown();
+  }
+}
+
+static ValueRange Bitwise(TokenType op, ValueRange a, ValueRange b, Type t) {
+  bool both_non_negative = a.known && b.known && a.min >= 0 && b.min >= 0;
+
+  switch (op) {
+    case BITWISE_AND: {
+      if (both_non_negative) return Between(0, (a.max < b.max) ? a.max : b.max);
+    } break;
+    case BITWISE_RIGHT_SHIFT: {
+      if (both_non_negative) return Between(0, a.max);
+    } break;
+    default: break;
+  }
+
+  return TypeRange(t);
+}
+
+/* === Environment === */
+static Binding *Lookup(Token name) {
+  for (int i = Analysis.env.count - 1; i >= 0; i--) {
+    if (TokenValuesMatch(Analysis.env.data[i].name, name)) {
+      return &Analysis.env.data[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void Bind(Token name, Type type, ValueRange r) {
+  Binding *b = Lookup(name);
+  if (b != NULL) {
+    b->range = r;
+    return;
+  }
+
+  Binding new_binding = {
+    .name = name,
+    .type = type,
+    .range = r,
+    .is_global = !Analysis.in_function,
+  };
+  DA_ADD(Binding, Analysis.env, new_binding);
+}
+
+static DA(Binding) CopyEnv(DA(Binding) env) {
+  DA(Binding) copy;
+  DA_INIT(Binding, copy);
+
+  for (int i = 0; i < env.count; i++) {
+    DA_ADD(Binding, copy, env.data[i]);
+  }
+
+  return copy;
+}
+
+/* Makes 'before' the current environment, with each binding widened to
+ * also cover its state at the end of the given branches. Bindings that
+ * were introduced inside the branches go out of scope.
+ *
+ * The branch environments are freed, so the current environment must
+ * already be one of them (or have been freed by the caller). */
+static void MergeEnv(DA(Binding) before, DA(Binding) *branches, int branch_count) {
+  for (int i = 0; i < before.count; i++) {
+    Binding *b = &before.data[i];
+
+    for (int j = 0; j < branch_count; j++) {
+      for (int k = 0; k < branches[j].count; k++) {
+        if (TokenValuesMatch(branches[j].data[k].name, b->name)) {
+          b->range = Hull(b->range, branches[j].data[k].range);
+          b->may_wrap |= branches[j].data[k].may_wrap;
+          break;
+        }
+      }
+    }
+  }
+
+  for (int j = 0; j < branch_count; j++) {
+    DA_FREE(Binding, branches[j]);
+  }
+
+  Analysis.env = before;
+}
+
+/* === Mutations === */
+// The variable a builtin call like 'recv(c, x)' writes to, if any
+static AST_Node *WrittenArgument(AST_Node *call) {
+  int index = BuiltinWrittenArgument(LookupBuiltin(call->token));
+  if (index < 0) return NULL;
+
+  AST_Node *arg = call->middle;
+  for (int i = 0; i < index && arg != NULL; i++) arg = arg->right;
+
+  return (arg != NULL && arg->left != NULL && arg->left->node_type == IDENTIFIER_NODE) ? arg->left : NULL;
+}
+
+static MutationKind CombineMutations(MutationKind a, MutationKind b) {
+  if (a == MUT_NONE) return b;
+  if (b == MUT_NONE) return a;
+  return (a == b) ? a : MUT_ARBITRARY;
+}
+
+static bool IsNonNegativeLiteral(AST_Node *n) {
+  ValueRange r = (n != NULL && n->node_type == LITERAL_NODE) ? LiteralRange(n->token) : Unknown();
+  return r.known && r.min >= 0;
+}
+
+static MutationKind MutationOf(AST_Node *n, Token name, bool is_global) {
+  if (n == NULL) return MUT_NONE;
+
+  MutationKind kind = MUT_NONE;
+
+  switch (n->node_type) {
+    case ASSIGNMENT_NODE: {
+      if (n->middle == NULL && TokenValuesMatch(n->token, name)) kind = MUT_ARBITRARY;
+    } break;
+    case DECLARATION_NODE: {
+      if (TokenValuesMatch(n->token, name)) kind = MUT_ARBITRARY;
+    } break;
+    case TERSE_ASSIGNMENT_NODE: {
+      if (!TokenValuesMatch(n->left->token, name)) break;
+
+      if (n->token.type == PLUS_EQUALS && IsNonNegativeLiteral(n->right)) {
+        kind = MUT_INCREASING;
+      } else if (n->token.type == MINUS_EQUALS && IsNonNegativeLiteral(n->right)) {
+        kind = MUT_DECREASING;
+      } else {
+        kind = MUT_ARBITRARY;
+      }
+    } break;
+    case PREFIX_INCREMENT_NODE: {
+      if (TokenValuesMatch(n->left->token, name)) kind = MUT_INCREASING;
+    } break;
+    case PREFIX_DECREMENT_NODE: {
+      if (TokenValuesMatch(n->left->token, name)) kind = MUT_DECREASING;
+    } break;
+    case POSTFIX_INCREMENT_NODE: {
+      if (TokenValuesMatch(n->token, name)) kind = MUT_INCREASING;
+    } break;
+    case POSTFIX_DECREMENT_NODE: {
+      if (TokenValuesMatch(n->token, name)) kind = MUT_DECREASING;
+    } break;
+    case FUNCTION_CALL_NODE: {
+      if (is_global) kind = MUT_ARBITRARY;
+    } break;
+    case BUILTIN_CALL_NODE: {
+      AST_Node *written = WrittenArgument(n);
+      if (written != NULL && TokenValuesMatch(written->token, name)) kind = MUT_ARBITRARY;
+    } break;
+    default: break;
+  }
+
+  kind = CombineMutations(kind, MutationOf(n->left, name, is_global));
+  kind = CombineMutations(kind, MutationOf(n->middle, name, is_global));
+  kind = CombineMutations(kind, MutationOf(n->right, name, is_global));
+
+  return kind;
+}
+
+static bool HasMutation(AST_Node *n) {
+  if (n == NULL) return false;
+  if (n->node_type == BUILTIN_CALL_NODE && WrittenArgument(n) != NULL) return true;
+
+  switch (n->node_type) {
+    case ASSIGNMENT_NODE:
+    case TERSE_ASSIGNMENT_NODE:
+    case PREFIX_INCREMENT_NODE:
+    case PREFIX_DECREMENT_NODE:
+    case POSTFIX_INCREMENT_NODE:
+    case POSTFIX_DECREMENT_NODE:
+    case FUNCTION_CALL_NODE:
+      return true;
+    default:
+      return HasMutation(n->left) || HasMutation(n->middle) || HasMutation(n->right);
+  }
+}
+
+static bool HasBreak(AST_Node *n) {
+  if (n == NULL) return false;
+  if (n->node_type == BREAK_NODE) return true;
+
+  return HasBreak(n->left) || HasBreak(n->middle) || HasBreak(n->right);
+}
+
+/* The most one pass through 'n' can move 'name' by, or -1 if that
+ * isn't bounded because a nested loop moves it */
+static int64_t StepsIn(AST_Node *n, Token name, bool is_global) {
+  if (n == NULL) return 0;
+
+  switch (n->node_type) {
+    case WHILE_NODE:
+    case FOR_NODE: {
+      return (MutationOf(n, name, is_global) == MUT_NONE) ? 0 : -1;
+    }
+    case TERSE_ASSIGNMENT_NODE: {
+      if (!TokenValuesMatch(n->left->token, name)) break;
+      return IsNonNegativeLiteral(n->right) ? LiteralRange(n->right->token).max : -1;
+    } break;
+    case PREFIX_INCREMENT_NODE:
+    case PREFIX_DECREMENT_NODE: {
+      if (TokenValuesMatch(n->left->token, name)) return 1;
+    } break;
+    case POSTFIX_INCREMENT_NODE:
+    case POSTFIX_DECREMENT_NODE: {
+      if (TokenValuesMatch(n->token, name)) return 1;
+    } break;
+    default: break;
+  }
+
+  int64_t steps = 0;
+  AST_Node *children[] = { n->left, n->middle, n->right };
+  for (int i = 0; i < 3; i++) {
+    int64_t child = StepsIn(children[i], name, is_global);
+    if (child < 0 || __builtin_add_overflow(steps, child, &steps)) return -1;
+  }
+
+  return steps;
+}
+
+static ValueRange OperandRange(AST_Node *n) {
+  if (n->node_type == LITERAL_NODE) return LiteralRange(n->token);
+  if (!IsPlainVariable(n)) return Unknown();
+
+  Binding *b = Lookup(n->token);
+  return (b != NULL) ? b->range : TypeRange(n->data_type);
+}
+
+/* The highest (or lowest) 'name' can be when an iteration starts, from
+ * a comparison like 'i < n' the loop condition needs to hold */
+static bool ConditionBound(AST_Node *condition, Token name, bool upper, int64_t *bound) {
+  if (condition == NULL || condition->node_type != BINARY_LOGICAL_NODE) return false;
+
+  TokenType op = condition->token.type;
+  if (op == LOGICAL_AND) {
+    return ConditionBound(condition->left, name, upper, bound) ||
+           ConditionBound(condition->right, name, upper, bound);
+  }
+
+  ValueRange other;
+  if (IsPlainVariable(condition->left) && TokenValuesMatch(condition->left->token, name)) {
+    other = OperandRange(condition->right);
+  } else if (IsPlainVariable(condition->right) && TokenValuesMatch(condition->right->token, name)) {
+    other = OperandRange(condition->left);
+    op = MirrorComparison(op);
+  } else {
+    return false;
+  }
+
+  if (!other.known) return false;
+
+  switch (op) {
+    case LESS_THAN:           if (!upper || other.max == INT64_MIN) return false; *bound = other.max - 1; return true;
+    case LESS_THAN_EQUALS:    if (!upper) return false; *bound = other.max; return true;
+    case GREATER_THAN:        if (upper || other.min == INT64_MAX) return false; *bound = other.min + 1; return true;
+    case GREATER_THAN_EQUALS: if (upper) return false; *bound = other.min; return true;
+    default: return false;
+  }
+}
+
+/* Counters wrap around at the ends of their type, so one that only goes
+ * up only keeps its lower bound if the loop condition stops it before
+ * it can pass the top, and the other way around */
+static bool CantWrap(AST_Node *loop, Binding *b, MutationKind kind) {
+  ValueRange type_range = TypeRange(b->type);
+  int64_t condition_steps = StepsIn(loop->left, b->name, b->is_global);
+  int64_t body_steps = StepsIn(loop->right, b->name, b->is_global);
+  int64_t steps, bound, last;
+
+  if (condition_steps < 0 || body_steps < 0 ||
+      __builtin_add_overflow(condition_steps, body_steps, &steps) || !ConditionBound(loop->left, b->name, kind == MUT_INCREASING, &bound)) return false;
+
+  return (kind == MUT_INCREASING) ? !__builtin_add_overflow(bound, steps, &last) && last <= type_range.max
+                                  : !__builtin_sub_overflow(bound, steps, &last) && last >= type_range.min;
+}
+
+/* Widens every binding changed somewhere in 'loop' to a range that holds
+ * on every iteration, e.g. a counter that only ever goes up and can't
+ * wrap keeps its lower bound. */
+static void WidenForLoop(AST_Node *loop) {
+  for (int i = 0; i < Analysis.env.count; i++) {
+    Binding *b = &Analysis.env.data[i];
+    ValueRange type_range = TypeRange(b->type);
+
+    switch (MutationOf(loop, b->name, b->is_global)) {
+      case MUT_NONE: break;
+      case MUT_INCREASING: {
+        b->range = (b->range.known) ? Between(b->range.min, type_range.max) : type_range;
+      } break;
+      case MUT_DECREASING: {
+        b->range = (b->range.known) ? Between(type_range.min, b->range.max) : type_range;
+      } break;
+      case MUT_ARBITRARY: {
+        b->range = type_range;
+      } break;
+    }
+
+    if (!type_range.known) b->range = Unknown();
+  }
+
+  // A bound in the condition can come from another counter, so this
+  // runs until no counter is left that might wrap
+  bool widened = true;
+  while (widened) {
+    widened = false;
+
+    for (int i = 0; i < Analysis.env.count; i++) {
+      Binding *b = &Analysis.env.data[i];
+      ValueRange type_range = TypeRange(b->type);
+      MutationKind kind = MutationOf(loop, b->name, b->is_global);
+
+      if ((kind == MUT_INCREASING || kind == MUT_DECREASING) &&
+          !b->may_wrap && !CantWrap(loop, b, kind)) {
+        b->range = (type_range.known) ? type_range : Unknown();
+        b->may_wrap = true;
+        widened = true;
+      }
+    }
+  }
+}
+
+static void ForgetGlobals() {
+  for (int i = 0; i < Analysis.env.count; i++) {
+    Binding *b = &Analysis.env.data[i];
+    if (b->is_global) b->range = TypeRange(b->type);
+  }
+}
+
+/* === Refinement by comparisons === */
+static TokenType MirrorComparison(TokenType op) {
+  switch (op) {
+    case LESS_THAN:           return GREATER_THAN;
+    case LESS_THAN_EQUALS:    return GREATER_THAN_EQUALS;
+    case GREATER_THAN:        return LESS_THAN;
+    case GREATER_THAN_EQUALS: return LESS_THAN_EQUALS;
+    default:                  return op;
+  }
+}
+
+static TokenType NegateComparison(TokenType op) {
+  switch (op) {
+    case LESS_THAN:           return GREATER_THAN_EQUALS;
+    case LESS_THAN_EQUALS:    return GREATER_THAN;
+    case GREATER_THAN:        return LESS_THAN_EQUALS;
+    case GREATER_THAN_EQUALS: return LESS_THAN;
+    default:                  return op;
+  }
+}
+
+static void RefineVariable(AST_Node *variable, TokenType op, ValueRange bound) {
+  if (!bound.known) return;
+
+  Binding *b = Lookup(variable->token);
+  ValueRange r = (b != NULL) ? b->range : TypeRange(variable->data_type);
+  if (!r.known) return;
+
+  switch (op) {
+    case LESS_THAN: {
+      if (bound.max == INT64_MIN) return;
+      if (r.max > bound.max - 1) r.max = bound.max - 1;
+    } break;
+    case LESS_THAN_EQUALS: {
+      if (r.max > bound.max) r.max = bound.max;
+    } break;
+    case GREATER_THAN: {
+      if (bound.min == INT64_MAX) return;
+      if (r.min < bound.min + 1) r.min = bound.min + 1;
+    } break;
+    case GREATER_THAN_EQUALS: {
+      if (r.min < bound.min) r.min = bound.min;
+    } break;
+    default: return;
+  }
+
+  if (b != NULL) {
+    b->range = r;
+    return;
+  }
+
+  // Not declared in this function, so it could be changed by any call
+  Binding new_binding = {
+    .name = variable->token,
+    .type = variable->data_type,
+    .range = r,
+    .is_global = true,
+  };
+  DA_ADD(Binding, Analysis.env, new_binding);
+}
+
+static bool IsPlainVariable(AST_Node *n) {
+  return n->node_type == IDENTIFIER_NODE &&
+         n->middle == NULL &&
+         !TypeIs_Array(n->data_type) &&
+         TypeRange(n->data_type).known;
+}
+
+// Nothing is proven from a counter that might have wrapped around
+static bool MayWrap(AST_Node *n) {
+  if (n == NULL || !IsPlainVariable(n)) return false;
+
+  Binding *b = Lookup(n->token);
+  return b != NULL && b->may_wrap;
+}
+
+static void Refine(AST_Node *condition, bool holds) {
+  if (condition == NULL || HasMutation(condition)) return;
+
+  if (condition->node_type == UNARY_OP_NODE && condition->token.type == LOGICAL_NOT) {
+    Refine(condition->left, !holds);
+    return;
+  }
+
+  if (condition->node_type != BINARY_LOGICAL_NODE) return;
+
+  TokenType op = condition->token.type;
+
+  if ((op == LOGICAL_AND && holds) || (op == LOGICAL_OR && !holds)) {
+    Refine(condition->left, holds);
+    Refine(condition->right, holds);
+    return;
+  }
+
+  if (!holds) op = NegateComparison(op);
+
+  if (IsPlainVariable(condition->left)) {
+    RefineVariable(condition->left, op, condition->right->range);
+  } else if (IsPlainVariable(condition->right)) {
+    RefineVariable(condition->right, MirrorComparison(op), condition->left->range);
+  }
+}
+
+/* === Checks === */
+static void CheckSubscript(AST_Node *array, AST_Node *subscript) {
+  if (!NodeIs_ArraySubscript(subscript) ||
+      TypeIs_String(array->data_type) ||
+      !TypeIs_Array(array->data_type)) return;
+
+  ValueRange index = Unknown();
+  bool may_wrap = false;
+  if (subscript->token.type == IDENTIFIER) {
+    Binding *b = Lookup(subscript->token);
+    index = (b != NULL) ? b->range : TypeRange(subscript->data_type);
+    may_wrap = (b != NULL && b->may_wrap);
+  } else {
+    index = LiteralRange(subscript->token);
+  }
+
+  subscript->range = index;
+  Analysis.report.subscripts++;
+
+  int size = array->data_type.array_size;
+  if (size > 0 && index.known && !IsEmpty(index) &&
+      (index.max < 0 || index.min > size - 1)) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, subscript->token,
+              "Subscript of '%.*s' is always out of bounds: index in [%lld, %lld], size %d",
+              array->token.length, array->token.position_in_source,
+              (long long)index.min, (long long)index.max, size);
+  }
+
+  if (size > 0 && Contains(Between(0, size - 1), index) && !may_wrap) {
+    AddNodeFact(subscript, FACT_IN_BOUNDS);
+    Analysis.report.subscripts_in_bounds++;
+  }
+}
+
+static ValueRange CheckOverflow(AST_Node *n, ValueRange exact) {
+  ValueRange type_range = TypeRange(n->data_type);
+  if (!TypeIs_Int(n->data_type) && !TypeIs_Uint(n->data_type)) return Unknown();
+  if (TypeIs_Array(n->data_type)) return Unknown(); // Element-wise, see simd.c
+
+  Analysis.report.arithmetic_ops++;
+
+  if (Contains(type_range, exact) && !MayWrap(n->left) && !MayWrap(n->right)) {
+    AddNodeFact(n, FACT_NO_OVERFLOW);
+    Analysis.report.arithmetic_ops_without_overflow++;
+    return exact;
+  }
+
+  return type_range;
+}
+
+/* === Walkers === */
+static ValueRange Identifier(AST_Node *n) {
+  if (n->middle != NULL) {
+    CheckSubscript(n, n->middle);
+    return TypeRange(n->data_type);
+  }
+
+  Binding *b = Lookup(n->token);
+  return (b != NULL) ? b->range : TypeRange(n->data_type);
+}
+
+static void Assignment(AST_Node *n) {
+  ValueRange value = (n->left != NULL) ? Expr(n->left) : Unknown();
+
+  if (n->middle != NULL) {
+    CheckSubscript(n, n->middle);
+    return;
+  }
+
+  if (TypeIs_Array(n->data_type) || !TypeRange(n->data_type).known) return;
+
+  Bind(n->token, n->data_type, FitToType(value, n->data_type));
+  Lookup(n->token)->may_wrap = false;
+}
+
+static ValueRange TerseAssignment(AST_Node *n) {
+  AST_Node *variable = n->left;
+  ValueRange amount = Expr(n->right);
+  ValueRange current = Expr(variable);
+  ValueRange result = TypeRange(variable->data_type);
+
+  switch (n->token.type) {
+    case PLUS_EQUALS:
+    case MINUS_EQUALS:
+    case TIMES_EQUALS:
+    case DIVIDE_EQUALS:
+    case MODULO_EQUALS: {
+      result = CheckOverflow(n, Arithmetic(n->token.type, current, amount));
+    } break;
+    default: break;
+  }
+
+  if (variable->middle == NULL && result.known) {
+    Bind(variable->token, variable->data_type, result);
+  }
+
+  return result;
+}
+
+static ValueRange IncrementOrDecrement(AST_Node *n, Token name, int64_t step, bool return_old) {
+  Binding *b = Lookup(name);
+  ValueRange old = (b != NULL) ? b->range : TypeRange(n->data_type);
+  ValueRange updated = FitToType(Arithmetic(PLUS, old, Between(step, step)), n->data_type);
+
+  if (TypeRange(n->data_type).known) {
+    Bind(name, n->data_type, updated);
+  }
+
+  return (return_old) ? old : updated;
+}
+
+static ValueRange TernaryIf(AST_Node *n) {
+  Expr(n->left);
+
+  DA(Binding) before = CopyEnv(Analysis.env);
+  DA(Binding) branches[2];
+
+  Refine(n->left, true);
+  ValueRange if_true = Expr(n->middle);
+  branches[0] = Analysis.env;
+
+  Analysis.env = CopyEnv(before);
+  Refine(n->left, false);
+  ValueRange if_false = Expr(n->right);
+  branches[1] = Analysis.env;
+
+  MergeEnv(before, branches, 2);
+
+  return Hull(if_true, if_false);
+}
+
+static ValueRange ExprChildren(AST_Node *n) {
+  if (n->left   != NULL) Expr(n->left);
+  if (n->middle != NULL) Expr(n->middle);
+  if (n->right  != NULL) Expr(n->right);
+
+  return TypeRange(n->data_type);
+}
+
+static ValueRange Expr(AST_Node *n) {
+  ValueRange r = Unknown();
+
+  switch (n->node_type) {
+    case LITERAL_NODE: {
+      r = LiteralRange(n->token);
+    } break;
+    case IDENTIFIER_NODE: {
+      r = Identifier(n);
+    } break;
+    case ASSIGNMENT_NODE: {
+      Assignment(n);
+    } break;
+    case TERSE_ASSIGNMENT_NODE: {
+      r = TerseAssignment(n);
+    } break;
+    case PREFIX_INCREMENT_NODE: {
+      r = IncrementOrDecrement(n->left, n->left->token, 1, false);
+    } break;
+    case PREFIX_DECREMENT_NODE: {
+      r = IncrementOrDecrement(n->left, n->left->token, -1, false);
+    } break;
+    case POSTFIX_INCREMENT_NODE: {
+      r = IncrementOrDecrement(n, n->token, 1, true);
+    } break;
+    case POSTFIX_DECREMENT_NODE: {
+      r = IncrementOrDecrement(n, n->token, -1, true);
+    } break;
+    case UNARY_OP_NODE: {
+      ValueRange operand = Expr(n->left);
+      if (n->token.type == MINUS) {
+        r = CheckOverflow(n, Negate(operand));
+      } else if (n->token.type == BITWISE_NOT) {
+        r = TypeRange(n->data_type);
+      }
+    } break;
+    case BINARY_ARITHMETIC_NODE: {
+      ValueRange left = Expr(n->left);
+      ValueRange right = Expr(n->right);
+      r = CheckOverflow(n, Arithmetic(n->token.type, left, right));
+    } break;
+    case BINARY_BITWISE_NODE: {
+      ValueRange left = Expr(n->left);
+      ValueRange right = Expr(n->right);
+      r = Bitwise(n->token.type, left, right, n->data_type);
+    } break;
+    case BINARY_LOGICAL_NODE: {
+      Expr(n->left);
+      Expr(n->right);
+    } break;
+    case TERNARY_IF_NODE: {
+      r = TernaryIf(n);
+    } break;
+    case FUNCTION_CALL_NODE: {
+      r = ExprChildren(n);
+      ForgetGlobals();
+    } break;
+    case BUILTIN_CALL_NODE: {
+      r = ExprChildren(n);
+
+      // Anything could have been written to it
+      AST_Node *written = WrittenArgument(n);
+      if (written != NULL && IsPlainVariable(written)) {
+        Bind(written->token, written->data_type, TypeRange(written->data_type));
+        Lookup(written->token)->may_wrap = false;
+      }
+    } break;
+    case DECLARATION_NODE: {
+      if (TypeRange(n->data_type).known && !TypeIs_Array(n->data_type)) {
+        Bind(n->token, n->data_type, TypeRange(n->data_type));
+      }
+    } break;
+
+    // Enum and struct definitions hold no runtime integer state
+    case ENUM_IDENTIFIER_NODE:
+    case STRUCT_DECLARATION_NODE:
+      break;
+
+    default: {
+      r = ExprChildren(n);
+    } break;
+  }
+
+  n->range = r;
+  return r;
+}
+
+/* === Statements === */
+static void IfStmt(AST_Node *n) {
+  Expr(n->left);
+
+  DA(Binding) before = CopyEnv(Analysis.env);
+  DA(Binding) branches[2];
+
+  Refine(n->left, true);
+  Walk(n->middle);
+  branches[0] = Analysis.env;
+
+  Analysis.env = CopyEnv(before);
+  Refine(n->left, false);
+  if (n->right != NULL) Walk(n->right);
+  branches[1] = Analysis.env;
+
+  MergeEnv(before, branches, 2);
+}
+
+static void WhileStmt(AST_Node *n) {
+  WidenForLoop(n);
+
+  Expr(n->left);
+
+  DA(Binding) loop_head = CopyEnv(Analysis.env);
+
+  Refine(n->left, true);
+  if (n->right != NULL) Walk(n->right);
+  DA_FREE(Binding, Analysis.env);
+
+  // Widening made the loop head state hold on every iteration,
+  // so it still holds once the loop is left
+  Analysis.env = loop_head;
+  if (!HasBreak(n->right)) Refine(n->left, false);
+}
+
+static void ForStmt(AST_Node *n) {
+  DA(Binding) before = CopyEnv(Analysis.env);
+  DA(Binding) branches[1];
+
+  Walk(n->left);
+  Walk(n->right);
+  branches[0] = Analysis.env;
+
+  MergeEnv(before, branches, 1);
+}
+
+static void Function(AST_Node *n) {
+  DA(Binding) outer = Analysis.env;
+  DA_INIT(Binding, Analysis.env);
+  Analysis.in_function = true;
+
+  if (n->right != NULL) Walk(n->right);
+
+  DA_FREE(Binding, Analysis.env);
+  Analysis.env = outer;
+  Analysis.in_function = false;
+}
+
+static void Walk(AST_Node *n) {
+  if (n == NULL) return;
+
+  switch (n->node_type) {
+    case START_NODE:
+    case CHAIN_NODE:
+    case FUNCTION_BODY_NODE: {
+      Walk(n->left);
+      Walk(n->right);
+    } break;
+    case IF_NODE: {
+      IfStmt(n);
+    } break;
+    case WHILE_NODE: {
+      WhileStmt(n);
+    } break;
+    case FOR_NODE: {
+      ForStmt(n);
+    } break;
+    case FUNCTION_NODE: {
+      Function(n);
+    } break;
+    case RETURN_NODE: {
+      if (n->left != NULL) Expr(n->left);
+    } break;
+    case BREAK_NODE:
+    case CONTINUE_NODE:
+      break;
+    default: {
+      Expr(n);
+    } break;
+  }
+}
+
+/* Top-level statements can also be analyzed one at a time, in source
+ * order, between BeginRangeAnalysis() and EndRangeAnalysis(). Global
+ * bindings carry over from one statement to the next */
+void BeginRangeAnalysis() {
+  Analysis.report = (RangeReport){0};
+  Analysis.in_function = false;
+  DA_INIT(Binding, Analysis.env);
+}
+
+void AnalyzeStatementRanges(AST_Node *statement) {
+  Walk(statement);
+}
+
+RangeReport EndRangeAnalysis() {
+  DA_FREE(Binding, Analysis.env);
+
+  return Analysis.report;
+}
+
+RangeReport AnalyzeRanges(AST_Node *ast_root) {
+  BeginRangeAnalysis();
+  AnalyzeStatementRanges(ast_root);
+  return EndRangeAnalysis();
+}
+
+void PrintRangeReport(RangeReport r) {
+  Print("Range analysis: %d of %d array subscripts proven in bounds, "
+        "%d of %d integer operations proven not to overflow\n",
+        r.subscripts_in_bounds, r.subscripts,
+        r.arithmetic_ops_without_overflow, r.arithmetic_ops);
+}
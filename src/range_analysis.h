@@ -0,0 +1,19 @@
+#ifndef RANGE_ANALYSIS_H
+#define RANGE_ANALYSIS_H
+
+#include "ast.h"
+
+typedef struct {
+  int subscripts;
+  int subscripts_in_bounds;
+  int arithmetic_ops;
+  int arithmetic_ops_without_overflow;
+} RangeReport;
+
+RangeReport AnalyzeRanges(AST_Node *ast_root);
+void BeginRangeAnalysis();
+void AnalyzeStatementRanges(AST_Node *statement);
+RangeReport EndRangeAnalysis();
+void PrintRangeReport(RangeReport r);
+
+#endif
@@ -0,0 +1,492 @@
+#include <pthread.h>   // for pthread_once
+#include <stdatomic.h> // for atomic_int
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h> // for memcpy
+
+#include "error.h"
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define HAVE_X86_KERNELS 1
+#else
+  #define HAVE_X86_KERNELS 0
+#endif
+
+typedef enum {
+  ARRAY_ARRAY,
+  ARRAY_SCALAR,
+  SCALAR_ARRAY,
+} Operands;
+
+typedef enum {
+  KOP_ADD, KOP_SUB, KOP_MUL, KOP_DIV, KOP_MOD,
+  KOP_EQ, KOP_NE, KOP_LT, KOP_GT, KOP_LE, KOP_GE,
+  KOP_AND, KOP_OR,
+
+  KOP_COUNT
+} KernelOp;
+
+typedef void (*Kernel)(void *out, const void *a, const void *b, int64_t n, Operands operands);
+typedef void (*Reduction)(void *result, const void *a, int64_t n);
+
+/* === Kernels ===
+ *
+ * The loops are written against GCC vector types of WIDTH bytes. The
+ * scalar level uses a WIDTH of one element, which compiles to ordinary
+ * scalar code. A scalar operand is broadcast to every lane up front.
+ */
+#define LOAD_OPERANDS(T, V)                                          \
+    if (operands != SCALAR_ARRAY) memcpy(&va, a + i, sizeof(V));     \
+    if (operands != ARRAY_SCALAR) memcpy(&vb, b + i, sizeof(V));
+
+#define SCALAR_OPERANDS(T)                                           \
+    T x = (operands == SCALAR_ARRAY) ? a[0] : a[i];                  \
+    T y = (operands == ARRAY_SCALAR) ? b[0] : b[i];
+
+#define BROADCAST_OPERANDS(V, LANES)                                 \
+    V va = {0}, vb = {0};                                            \
+    for (int j = 0; j < LANES; j++) {                                \
+      if (operands == SCALAR_ARRAY) va[j] = a[0];                    \
+      if (operands == ARRAY_SCALAR) vb[j] = b[0];                    \
+    }
+
+#define DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, name, op)                                 \
+  TARGET static void level##_##name##_##T(void *out_, const void *a_, const void *b_, int64_t n, Operands operands) { \
+    typedef T V __attribute__((vector_size(WIDTH)));                                                \
+    enum { LANES = WIDTH / sizeof(T) };                                                             \
+    T *out = out_;                                                                                  \
+    const T *a = a_;                                                                                \
+    const T *b = b_;                                                                                \
+    BROADCAST_OPERANDS(V, LANES)                                                                    \
+                                                                                                    \
+    int64_t i = 0;                                                                                  \
+    for (; i + LANES <= n; i += LANES) {                                                            \
+      LOAD_OPERANDS(T, V)                                                                           \
+      V r = va op vb;                                                                               \
+      memcpy(out + i, &r, sizeof(V));                                                               \
+    }                                                                                               \
+                                                                                                    \
+    for (; i < n; i++) {                                                                            \
+      SCALAR_OPERANDS(T)                                                                            \
+      out[i] = (T)(x op y);                                                                         \
+    }                                                                                               \
+  }
+
+#define DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, name, op)                                 \
+  TARGET static void level##_##name##_##T(void *out_, const void *a_, const void *b_, int64_t n, Operands operands) { \
+    typedef T V __attribute__((vector_size(WIDTH)));                                                \
+    enum { LANES = WIDTH / sizeof(T) };                                                             \
+    bool *out = out_;                                                                               \
+    const T *a = a_;                                                                                \
+    const T *b = b_;                                                                                \
+    BROADCAST_OPERANDS(V, LANES)                                                                    \
+                                                                                                    \
+    int64_t i = 0;                                                                                  \
+    for (; i + LANES <= n; i += LANES) {                                                            \
+      LOAD_OPERANDS(T, V)                                                                           \
+      __typeof__(va op vb) mask = va op vb;                                                         \
+      for (int j = 0; j < LANES; j++) out[i + j] = (mask[j] != 0);                                  \
+    }                                                                                               \
+                                                                                                    \
+    for (; i < n; i++) {                                                                            \
+      SCALAR_OPERANDS(T)                                                                            \
+      out[i] = (x op y);                                                                            \
+    }                                                                                               \
+  }
+
+#define DEFINE_SUM_REDUCTION(level, TARGET, WIDTH, T)                                               \
+  TARGET static void level##_Sum_##T(void *result, const void *a_, int64_t n) {                     \
+    typedef T V __attribute__((vector_size(WIDTH)));                                                \
+    enum { LANES = WIDTH / sizeof(T) };                                                             \
+    const T *a = a_;                                                                                \
+    V acc = {0};                                                                                    \
+                                                                                                    \
+    int64_t i = 0;                                                                                  \
+    for (; i + LANES <= n; i += LANES) {                                                            \
+      V va;                                                                                         \
+      memcpy(&va, a + i, sizeof(V));                                                                \
+      acc += va;                                                                                    \
+    }                                                                                               \
+                                                                                                    \
+    T total = 0;                                                                                    \
+    for (int j = 0; j < LANES; j++) total += acc[j];                                                \
+    for (; i < n; i++) total += a[i];                                                               \
+                                                                                                    \
+    memcpy(result, &total, sizeof(T));                                                              \
+  }
+
+#define DEFINE_NUMERIC_KERNELS(level, TARGET, WIDTH, T)                \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, Add, +)            \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, Sub, -)            \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, Mul, *)            \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, Div, /)            \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Eq, ==)            \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Ne, !=)            \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Lt, <)             \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Gt, >)             \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Le, <=)            \
+  DEFINE_COMPARISON_KERNEL(level, TARGET, WIDTH, T, Ge, >=)            \
+  DEFINE_SUM_REDUCTION(level, TARGET, WIDTH, T)
+
+#define DEFINE_INTEGER_KERNELS(level, TARGET, WIDTH, T)                \
+  DEFINE_NUMERIC_KERNELS(level, TARGET, WIDTH, T)                      \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, T, Mod, %)
+
+// Bools are stored as 0 or 1, so the bitwise operators are exact
+#define DEFINE_BOOL_KERNELS(level, TARGET, WIDTH)                      \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, uint8_t, And, &)      \
+  DEFINE_ARITHMETIC_KERNEL(level, TARGET, WIDTH, uint8_t, Or,  |)
+
+/* X-macro over the numeric element types: (specifier, C type) */
+#define INTEGER_ELEMENT_TYPES(X) \
+  X(T_I8,  int8_t)               \
+  X(T_I16, int16_t)              \
+  X(T_I32, int32_t)              \
+  X(T_I64, int64_t)              \
+  X(T_U8,  uint8_t)              \
+  X(T_U16, uint16_t)             \
+  X(T_U32, uint32_t)             \
+  X(T_U64, uint64_t)
+
+#define FLOAT_ELEMENT_TYPES(X)   \
+  X(T_F32, float)                \
+  X(T_F64, double)
+
+#define NUMERIC_ELEMENT_TYPES(X) \
+  INTEGER_ELEMENT_TYPES(X)       \
+  FLOAT_ELEMENT_TYPES(X)
+
+#define NO_TARGET
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+#define SCALAR_INTEGER(spec, T) DEFINE_INTEGER_KERNELS(Scalar, NO_TARGET, sizeof(T), T)
+#define SCALAR_FLOAT(spec, T)   DEFINE_NUMERIC_KERNELS(Scalar, NO_TARGET, sizeof(T), T)
+INTEGER_ELEMENT_TYPES(SCALAR_INTEGER)
+FLOAT_ELEMENT_TYPES(SCALAR_FLOAT)
+DEFINE_BOOL_KERNELS(Scalar, NO_TARGET, 1)
+
+#if HAVE_X86_KERNELS
+#define SSE2_INTEGER(spec, T) DEFINE_INTEGER_KERNELS(SSE2, SSE2_TARGET, 16, T)
+#define SSE2_FLOAT(spec, T)   DEFINE_NUMERIC_KERNELS(SSE2, SSE2_TARGET, 16, T)
+#define AVX2_INTEGER(spec, T) DEFINE_INTEGER_KERNELS(AVX2, AVX2_TARGET, 32, T)
+#define AVX2_FLOAT(spec, T)   DEFINE_NUMERIC_KERNELS(AVX2, AVX2_TARGET, 32, T)
+INTEGER_ELEMENT_TYPES(SSE2_INTEGER)
+FLOAT_ELEMENT_TYPES(SSE2_FLOAT)
+DEFINE_BOOL_KERNELS(SSE2, SSE2_TARGET, 16)
+INTEGER_ELEMENT_TYPES(AVX2_INTEGER)
+FLOAT_ELEMENT_TYPES(AVX2_FLOAT)
+DEFINE_BOOL_KERNELS(AVX2, AVX2_TARGET, 32)
+#endif
+
+/* === Kernel Tables === */
+#define NUMERIC_ENTRIES(level, spec, T)       \
+  [spec][KOP_ADD] = level##_Add_##T,          \
+  [spec][KOP_SUB] = level##_Sub_##T,          \
+  [spec][KOP_MUL] = level##_Mul_##T,          \
+  [spec][KOP_DIV] = level##_Div_##T,          \
+  [spec][KOP_EQ]  = level##_Eq_##T,           \
+  [spec][KOP_NE]  = level##_Ne_##T,           \
+  [spec][KOP_LT]  = level##_Lt_##T,           \
+  [spec][KOP_GT]  = level##_Gt_##T,           \
+  [spec][KOP_LE]  = level##_Le_##T,           \
+  [spec][KOP_GE]  = level##_Ge_##T,
+
+#define INTEGER_ENTRIES(level, spec, T)       \
+  NUMERIC_ENTRIES(level, spec, T)             \
+  [spec][KOP_MOD] = level##_Mod_##T,
+
+#define BOOL_ENTRIES(level)                   \
+  [T_BOOL][KOP_AND] = level##_And_uint8_t,    \
+  [T_BOOL][KOP_OR]  = level##_Or_uint8_t,
+
+#define SCALAR_INTEGER_ENTRIES(spec, T) INTEGER_ENTRIES(Scalar, spec, T)
+#define SCALAR_FLOAT_ENTRIES(spec, T)   NUMERIC_ENTRIES(Scalar, spec, T)
+#define SCALAR_SUM_ENTRY(spec, T)       [spec] = Scalar_Sum_##T,
+
+static const Kernel scalar_kernels[T_F64 + 1][KOP_COUNT] = {
+  INTEGER_ELEMENT_TYPES(SCALAR_INTEGER_ENTRIES)
+  FLOAT_ELEMENT_TYPES(SCALAR_FLOAT_ENTRIES)
+};
+
+static const Kernel scalar_bool_kernels[T_BOOL + 1][KOP_COUNT] = {
+  BOOL_ENTRIES(Scalar)
+};
+
+static const Reduction scalar_sums[T_F64 + 1] = {
+  NUMERIC_ELEMENT_TYPES(SCALAR_SUM_ENTRY)
+};
+
+#if HAVE_X86_KERNELS
+#define SSE2_INTEGER_ENTRIES(spec, T) INTEGER_ENTRIES(SSE2, spec, T)
+#define SSE2_FLOAT_ENTRIES(spec, T)   NUMERIC_ENTRIES(SSE2, spec, T)
+#define SSE2_SUM_ENTRY(spec, T)       [spec] = SSE2_Sum_##T,
+#define AVX2_INTEGER_ENTRIES(spec, T) INTEGER_ENTRIES(AVX2, spec, T)
+#define AVX2_FLOAT_ENTRIES(spec, T)   NUMERIC_ENTRIES(AVX2, spec, T)
+#define AVX2_SUM_ENTRY(spec, T)       [spec] = AVX2_Sum_##T,
+
+static const Kernel sse2_kernels[T_F64 + 1][KOP_COUNT] = {
+  INTEGER_ELEMENT_TYPES(SSE2_INTEGER_ENTRIES)
+  FLOAT_ELEMENT_TYPES(SSE2_FLOAT_ENTRIES)
+};
+
+static const Kernel sse2_bool_kernels[T_BOOL + 1][KOP_COUNT] = {
+  BOOL_ENTRIES(SSE2)
+};
+
+static const Reduction sse2_sums[T_F64 + 1] = {
+  NUMERIC_ELEMENT_TYPES(SSE2_SUM_ENTRY)
+};
+
+static const Kernel avx2_kernels[T_F64 + 1][KOP_COUNT] = {
+  INTEGER_ELEMENT_TYPES(AVX2_INTEGER_ENTRIES)
+  FLOAT_ELEMENT_TYPES(AVX2_FLOAT_ENTRIES)
+};
+
+static const Kernel avx2_bool_kernels[T_BOOL + 1][KOP_COUNT] = {
+  BOOL_ENTRIES(AVX2)
+};
+
+static const Reduction avx2_sums[T_F64 + 1] = {
+  NUMERIC_ELEMENT_TYPES(AVX2_SUM_ENTRY)
+};
+#endif
+
+/* === Dispatch === */
+// Detected once, by the first thread to need it
+static SimdLevel supported_level;
+static pthread_once_t detection = PTHREAD_ONCE_INIT;
+static atomic_int active_level = SIMD_LEVEL_COUNT; // Not set, use supported_level
+
+static void DetectSimdLevel() {
+  supported_level = SIMD_SCALAR;
+
+#if HAVE_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) supported_level = SIMD_SSE2;
+  if (__builtin_cpu_supports("avx2")) supported_level = SIMD_AVX2;
+#endif
+}
+
+SimdLevel ActiveSimdLevel() {
+  pthread_once(&detection, DetectSimdLevel);
+
+  SimdLevel level = atomic_load(&active_level);
+  return (level == SIMD_LEVEL_COUNT) ? supported_level : level;
+}
+
+void SetSimdLevel(SimdLevel level) {
+  pthread_once(&detection, DetectSimdLevel);
+  atomic_store(&active_level, (level < supported_level) ? level : supported_level);
+}
+
+const char *SimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_SSE2:   return "SSE2";
+    case SIMD_AVX2:   return "AVX2";
+    default:          return "Unknown SIMD level";
+  }
+}
+
+static Kernel LookupKernel(enum TypeSpecifier element_type, KernelOp op) {
+  SimdLevel level = ActiveSimdLevel();
+
+  if (element_type == T_BOOL) {
+#if HAVE_X86_KERNELS
+    if (level == SIMD_AVX2) return avx2_bool_kernels[T_BOOL][op];
+    if (level == SIMD_SSE2) return sse2_bool_kernels[T_BOOL][op];
+#endif
+    return scalar_bool_kernels[T_BOOL][op];
+  }
+
+  if (element_type > T_F64) return NULL;
+
+#if HAVE_X86_KERNELS
+  if (level == SIMD_AVX2) return avx2_kernels[element_type][op];
+  if (level == SIMD_SSE2) return sse2_kernels[element_type][op];
+#endif
+  return scalar_kernels[element_type][op];
+}
+
+static Reduction LookupSum(enum TypeSpecifier element_type) {
+  if (element_type > T_F64) return NULL;
+
+#if HAVE_X86_KERNELS
+  SimdLevel level = ActiveSimdLevel();
+  if (level == SIMD_AVX2) return avx2_sums[element_type];
+  if (level == SIMD_SSE2) return sse2_sums[element_type];
+#endif
+  return scalar_sums[element_type];
+}
+
+static KernelOp KernelOpFor(TokenType op) {
+  switch (op) {
+    case PLUS:                return KOP_ADD;
+    case MINUS:               return KOP_SUB;
+    case ASTERISK:            return KOP_MUL;
+    case DIVIDE:              return KOP_DIV;
+    case MODULO:              return KOP_MOD;
+    case EQUALITY:            return KOP_EQ;
+    case LOGICAL_NOT_EQUALS:  return KOP_NE;
+    case LESS_THAN:           return KOP_LT;
+    case GREATER_THAN:        return KOP_GT;
+    case LESS_THAN_EQUALS:    return KOP_LE;
+    case GREATER_THAN_EQUALS: return KOP_GE;
+    case LOGICAL_AND:         return KOP_AND;
+    case LOGICAL_OR:          return KOP_OR;
+    default:                  return KOP_COUNT;
+  }
+}
+
+static bool IsComparison(KernelOp op) {
+  return op >= KOP_EQ && op <= KOP_GE;
+}
+
+// An integer division by a zero element traps, so it's reported before the kernel runs
+static void CheckDivisors(KernelOp op, ArrayValue *divisors) {
+  if (op != KOP_DIV && op != KOP_MOD) return;
+
+  Type element = { .specifier = divisors->element_type };
+  if (!TypeIs_Int(element) && !TypeIs_Uint(element)) return;
+
+  for (int64_t i = 0; i < divisors->count; i++) {
+    if (ArrayGet(divisors, i).as.uinteger == 0) INTERPRETER_ERROR("Element-wise division by zero");
+  }
+}
+
+/* === Entry Points === */
+Value ElementWise(TokenType op, Value left, Value right) {
+  bool left_is_array  = TypeIs_Array(left.type);
+  bool right_is_array = TypeIs_Array(right.type);
+
+  ArrayValue *array = (left_is_array) ? left.as.array : right.as.array;
+  enum TypeSpecifier element_type = array->element_type;
+  int64_t count = array->count;
+
+  KernelOp kop = KernelOpFor(op);
+  Kernel kernel = (kop == KOP_COUNT) ? NULL : LookupKernel(element_type, kop);
+  if (kernel == NULL) {
+    INTERPRETER_ERROR("ElementWise(): No kernel for this operator and element type");
+  }
+
+  // A scalar operand is converted to the element type once, up front
+  _Alignas(8) unsigned char scalar_storage[sizeof(ArrayValue) + sizeof(uint64_t)];
+  ArrayValue *scalar = NULL;
+  if (!left_is_array || !right_is_array) {
+    scalar = InitArrayValue(scalar_storage, element_type, 1);
+    ArraySet(scalar, 0, (left_is_array) ? right : left);
+  }
+
+  Operands operands = (left_is_array && right_is_array) ? ARRAY_ARRAY
+                    : (left_is_array)                   ? ARRAY_SCALAR
+                                                        : SCALAR_ARRAY;
+
+  CheckDivisors(kop, (right_is_array) ? right.as.array : scalar);
+
+  const void *a = (left_is_array)  ? (const void*)left.as.array->elements  : scalar->elements;
+  const void *b = (right_is_array) ? (const void*)right.as.array->elements : scalar->elements;
+
+  enum TypeSpecifier result_type = (IsComparison(kop)) ? T_BOOL : element_type;
+  ArrayValue *result = NewArrayValue(result_type, count);
+
+  kernel(result->elements, a, b, count, operands);
+
+  return (Value){
+    .type = (Type){
+      .category = (left_is_array) ? left.type.category : right.type.category,
+      .specifier = result_type,
+      .array_size = count,
+    },
+    .as.array = result,
+  };
+}
+
+// A slice reduces over its part of the array it views
+Value Reduce(Builtin b, Value array_value) {
+  ArrayValue *array = array_value.as.array;
+  int64_t first = 0;
+  int64_t count = array->count;
+
+  if (TypeIs_Slice(array_value.type)) {
+    array = array_value.as.slice.base;
+    first = array_value.as.slice.offset;
+    count = array_value.as.slice.count;
+  }
+
+  switch (b) {
+    case BUILTIN_SUM: {
+      Reduction sum = LookupSum(array->element_type);
+      if (sum == NULL) INTERPRETER_ERROR("Reduce(): sum() needs a numeric array");
+
+      _Alignas(8) unsigned char result_storage[sizeof(ArrayValue) + sizeof(uint64_t)];
+      ArrayValue *result = InitArrayValue(result_storage, array->element_type, 1);
+      sum(result->elements, array->elements + first * array->element_size, count);
+
+      return ArrayGet(result, 0);
+    }
+    case BUILTIN_MIN:
+    case BUILTIN_MAX: {
+      if (count == 0) INTERPRETER_ERROR("Reduce(): min()/max() of an empty array");
+
+      Value best = ArrayGet(array, first);
+      for (int64_t i = first + 1; i < first + count; i++) {
+        Value v = ArrayGet(array, i);
+        Value is_better = (b == BUILTIN_MIN) ? LessThan(v, best) : GreaterThan(v, best);
+        if (is_better.as.boolean) best = v;
+      }
+
+      return best;
+    }
+    default: {
+      INTERPRETER_ERROR("Reduce(): Not a reduction");
+    }
+  }
+
+  return (Value){0};
+}
+
+/* === Vectors === */
+static void CheckLanes(const ArrayValue *array, int64_t offset, int64_t lanes) {
+  // Written so that a huge offset can't overflow 'offset + lanes'
+  if (offset < 0 || lanes > (int64_t)array->count || offset > (int64_t)array->count - lanes) {
+    INTERPRETER_ERROR("Vector lanes out of bounds");
+  }
+}
+
+Value Shuffle(Value vector, Value indices) {
+  ArrayValue *from = vector.as.array;
+  ArrayValue *order = indices.as.array;
+  ArrayValue *result = NewArrayValue(from->element_type, from->count);
+
+  for (int64_t i = 0; i < from->count; i++) {
+    Value index = ArrayGet(order, i);
+    int64_t lane = (TypeIs_Int(index.type)) ? index.as.integer : (int64_t)index.as.uinteger;
+    CheckLanes(from, lane, 1);
+
+    memcpy(result->elements + i * result->element_size,
+           from->elements + lane * from->element_size,
+           from->element_size);
+  }
+
+  return (Value){ .type = vector.type, .as.array = result };
+}
+
+Value LoadVector(Value array, int64_t offset, Type vector_type) {
+  ArrayValue *from = array.as.array;
+  int64_t lanes = vector_type.array_size;
+  CheckLanes(from, offset, lanes);
+
+  ArrayValue *result = NewArrayValue(from->element_type, lanes);
+  memcpy(result->elements, from->elements + offset * from->element_size, lanes * from->element_size);
+
+  return (Value){ .type = vector_type, .as.array = result };
+}
+
+void StoreVector(ArrayValue *array, int64_t offset, Value vector) {
+  ArrayValue *from = vector.as.array;
+  CheckLanes(array, offset, from->count);
+
+  memcpy(array->elements + offset * array->element_size, from->elements, from->count * from->element_size);
+}
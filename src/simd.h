@@ -0,0 +1,43 @@
+/* Element-wise array operations and reductions.
+ *
+ * Each kernel is compiled once per instruction set level and the best
+ * one supported by the running CPU is picked on first use, by whichever
+ * thread gets there first. Arithmetic, comparisons and sum() work on
+ * whole vector registers. min() and max() are plain loops.
+ *
+ * Vector values ('f32x4', see TC_VECTOR in type.h) are arrays exactly
+ * one register wide, so the same kernels run them in a single step.
+ * Shuffles copy lane by lane; loads and stores are a single copy of
+ * the lanes. All three stop the program when a lane is out of bounds.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "builtins.h"
+#include "token_type.h"
+#include "value.h"
+
+typedef enum {
+  SIMD_SCALAR,
+  SIMD_SSE2,
+  SIMD_AVX2,
+
+  SIMD_LEVEL_COUNT
+} SimdLevel;
+
+SimdLevel ActiveSimdLevel();
+void SetSimdLevel(SimdLevel level); // Clamped to what the CPU supports
+const char *SimdLevelName(SimdLevel level);
+
+// At least one of left and right must be an array. The result is a new
+// array of the same size, with BOOL elements for comparisons.
+Value ElementWise(TokenType op, Value left, Value right);
+
+Value Reduce(Builtin b, Value array); // or a slice
+
+Value Shuffle(Value vector, Value indices);
+Value LoadVector(Value array, int64_t offset, Type vector_type);
+void StoreVector(ArrayValue *array, int64_t offset, Value vector); // 'array' must not be shared
+
+#endif
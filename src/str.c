@@ -0,0 +1,277 @@
+#include <string.h> // for memcpy, memcmp, memchr
+
+#include "dynamic_array.h"
+#include "error.h"
+#include "str.h"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME        0x100000001b3ULL
+
+// Pieces shorter than this are copied instead of getting a node of
+// their own, since the node would take more room than the copy
+#define ROPE_MIN_LENGTH 32
+
+typedef String* StringPtr;
+USE_DYNAMIC_ARRAY(StringPtr)
+
+size_t StringAllocationSize(int64_t length) {
+  return sizeof(String) + (size_t)length + 1;
+}
+
+String *InitString(void *memory, const char *chars, int64_t length) {
+  String *s = memory;
+  s->length = length;
+  s->hash = 0;
+  s->chars = s->data;
+  s->left = NULL;
+  s->right = NULL;
+  memcpy(s->data, chars, length);
+  s->data[length] = '\0';
+
+  return s;
+}
+
+String *NewStringFrom(const char *chars, int64_t length) {
+  return InitString(NewHeapObject(HEAP_STRING, StringAllocationSize(length)), chars, length);
+}
+
+/* === Concatenation === */
+bool StringIsFlat(const String *s) {
+  return s->chars != NULL;
+}
+
+static String *ConcatChars(const char *left, int64_t left_length,
+                           const char *right, int64_t right_length) {
+  String *s = NewHeapObject(HEAP_STRING, StringAllocationSize(left_length + right_length));
+
+  InitString(s, left, left_length);
+  memcpy(s->data + left_length, right, right_length);
+  s->length += right_length;
+  s->data[s->length] = '\0';
+
+  return s;
+}
+
+static String *NewConcatNode(String *left, String *right) {
+  String *s = NewHeapObject(HEAP_STRING, sizeof(String));
+  s->length = left->length + right->length;
+  s->hash = 0;
+  s->chars = NULL;
+  s->left = left;
+  s->right = right;
+
+  Retain(&left->header);
+  Retain(&right->header);
+
+  return s;
+}
+
+String *StringAppend(String *left, const char *chars, int64_t length) {
+  if (length == 0) return left;
+
+  if (StringIsFlat(left) && left->length + length < ROPE_MIN_LENGTH) {
+    return ConcatChars(left->chars, left->length, chars, length);
+  }
+
+  // Small pieces top up the last leaf rather than each getting a node
+  if (!StringIsFlat(left) && StringIsFlat(left->right) &&
+      left->right->length + length < ROPE_MIN_LENGTH) {
+    String *leaf = ConcatChars(left->right->chars, left->right->length, chars, length);
+    return NewConcatNode(left->left, leaf);
+  }
+
+  return NewConcatNode(left, NewStringFrom(chars, length));
+}
+
+String *StringConcat(String *left, String *right) {
+  if (left->length == 0) return right;
+
+  if (StringIsFlat(right) && right->length < ROPE_MIN_LENGTH) {
+    return StringAppend(left, right->chars, right->length);
+  }
+
+  return NewConcatNode(left, right);
+}
+
+/* === Slices === */
+static bool IsSlice(const String *s) {
+  return StringIsFlat(s) && s->left != NULL;
+}
+
+// A slice of a slice points into the same original
+String *StringSlice(String *s, int64_t offset, int64_t length) {
+  const char *chars = StringData(s) + offset;
+  String *original = (IsSlice(s)) ? s->left : s;
+
+  String *slice = NewHeapObject(HEAP_STRING, sizeof(String));
+  slice->length = length;
+  slice->hash = 0;
+  slice->chars = (char *)chars;
+  slice->left = original;
+  slice->right = NULL;
+
+  Retain(&original->header);
+  return slice;
+}
+
+/* Copies the pieces into one buffer, filling it from the back: the
+ * right half of each node is walked into directly and the left half
+ * is put aside for later. Strings built by appending in a loop lean
+ * to the left, so they only ever put aside one node at a time. */
+static void Flatten(String *s) {
+  char *buffer = HeapAlloc(s->length + 1);
+  buffer[s->length] = '\0';
+
+  DA(StringPtr) pending;
+  DA_INIT(StringPtr, pending);
+
+  int64_t end = s->length;
+  String *node = s;
+  for (;;) {
+    if (StringIsFlat(node)) {
+      end -= node->length;
+      memcpy(buffer + end, node->chars, node->length);
+
+      if (pending.count == 0) break;
+      node = pending.data[--pending.count];
+      continue;
+    }
+
+    DA_ADD(StringPtr, pending, node->left);
+    node = node->right;
+  }
+
+  DA_FREE(StringPtr, pending);
+
+  // The halves aren't needed anymore
+  Release(&s->left->header);
+  Release(&s->right->header);
+
+  s->chars = buffer;
+  s->left = NULL;
+  s->right = NULL;
+}
+
+void DropString(String *s) {
+  if (!StringIsFlat(s)) {
+    Release(&s->left->header);
+    Release(&s->right->header);
+  } else if (IsSlice(s)) {
+    Release(&s->left->header);
+  } else if (s->chars != s->data) {
+    HeapFree(s->chars, s->length + 1);
+  }
+}
+
+const char *StringData(String *s) {
+  if (!StringIsFlat(s)) Flatten(s);
+
+  return s->chars;
+}
+
+int64_t StringLength(const String *s) {
+  return s->length;
+}
+
+uint64_t HashChars(const char *chars, int64_t length) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (int64_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)chars[i];
+    hash *= FNV_PRIME;
+  }
+
+  // 0 means "not computed yet" in String.hash
+  return (hash == 0) ? 1 : hash;
+}
+
+uint64_t StringHash(String *s) {
+  if (s->hash != 0) return s->hash;
+
+  s->hash = HashChars(StringData(s), s->length);
+  return s->hash;
+}
+
+bool StringIsInterned(const String *s) {
+  return s->header.refcount == REFCOUNT_INTERNED;
+}
+
+/* The C library's memcmp() and memchr() are already vectorized, so the
+ * comparisons lean on them once lengths are known */
+bool StringsEqual(String *a, String *b) {
+  if (a == b) return true;
+  if (StringIsInterned(a) && StringIsInterned(b)) return false;
+  if (a->length != b->length) return false;
+  if (a->hash != 0 && b->hash != 0 && a->hash != b->hash) return false;
+
+  return memcmp(StringData(a), StringData(b), a->length) == 0;
+}
+
+int StringCompare(String *a, String *b) {
+  int64_t shorter = (a->length < b->length) ? a->length : b->length;
+
+  int result = memcmp(StringData(a), StringData(b), shorter);
+  if (result != 0) return result;
+
+  return (a->length > b->length) - (a->length < b->length);
+}
+
+/* === Search ===
+ *
+ * For needles of two or more bytes, 16 candidate positions are checked
+ * at once: a position can only match if both the first and the last
+ * byte of the needle line up, and only those positions are verified
+ * with memcmp().
+ */
+typedef unsigned char ByteVector __attribute__((vector_size(16)));
+
+static int64_t FindSingleByte(const char *haystack, int64_t length, char c) {
+  const char *found = memchr(haystack, c, length);
+  return (found == NULL) ? -1 : found - haystack;
+}
+
+int64_t FindChars(const char *haystack, int64_t n, const char *needle, int64_t m) {
+  if (m == 0) return 0;
+  if (m > n) return -1;
+  if (m == 1) return FindSingleByte(haystack, n, needle[0]);
+
+  ByteVector first = {0}, last = {0};
+  first += (unsigned char)needle[0];
+  last  += (unsigned char)needle[m - 1];
+
+  int64_t i = 0;
+  for (; i + 16 <= n - m + 1; i += 16) {
+    ByteVector block_first, block_last;
+    memcpy(&block_first, haystack + i, 16);
+    memcpy(&block_last, haystack + i + m - 1, 16);
+
+    ByteVector candidates = (ByteVector)((block_first == first) & (block_last == last));
+
+    uint64_t halves[2];
+    memcpy(halves, &candidates, 16);
+    if ((halves[0] | halves[1]) == 0) continue;
+
+    for (int j = 0; j < 16; j++) {
+      if (candidates[j] != 0 &&
+          memcmp(haystack + i + j + 1, needle + 1, m - 2) == 0) {
+        return i + j;
+      }
+    }
+  }
+
+  for (; i <= n - m; i++) {
+    if (haystack[i] == needle[0] &&
+        memcmp(haystack + i, needle, m) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+int64_t StringFind(String *haystack, String *needle) {
+  return FindChars(StringData(haystack), haystack->length, StringData(needle), needle->length);
+}
+
+bool StringContains(String *haystack, String *needle) {
+  return StringFind(haystack, needle) >= 0;
+}
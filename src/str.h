@@ -0,0 +1,65 @@
+/* Runtime string values.
+ *
+ * A String stores its length, so getting the length is O(1) and the
+ * contents may contain NUL bytes. The data is still NUL-terminated so
+ * it can be handed to C functions that expect one. The hash is
+ * computed on first use and cached.
+ *
+ * StringConcat() doesn't copy anything: it returns a node pointing at
+ * both halves, so appending to a string in a loop is linear. The
+ * pieces are copied into one buffer the first time the contents are
+ * read (StringData() and everything built on it), and that buffer is
+ * kept, so every later read is as cheap as for a plain string.
+ *
+ * StringSlice() doesn't copy either: the slice points into the
+ * original's bytes and holds a reference to it. A slice's data isn't
+ * NUL-terminated.
+ *
+ * Strings are reference counted (see heap.h). InitString() leaves the
+ * header alone so the caller decides where the memory comes from.
+ */
+
+#ifndef STR_H
+#define STR_H
+
+#include <stdbool.h>
+#include <stddef.h> // for size_t
+#include <stdint.h>
+
+#include "heap.h"
+
+typedef struct String {
+  HeapObject header;
+  int64_t length;
+  uint64_t hash; // 0 until StringHash() is called
+  char *chars;   // NULL until a concatenation is flattened
+  struct String *left, *right; // only set on unflattened concatenations,
+                               // except a slice's 'left', which is what it points into
+  char data[];
+} String;
+
+size_t StringAllocationSize(int64_t length);
+String *InitString(void *memory, const char *chars, int64_t length);
+String *NewStringFrom(const char *chars, int64_t length);
+
+String *StringConcat(String *left, String *right);
+String *StringAppend(String *left, const char *chars, int64_t length);
+String *StringSlice(String *s, int64_t offset, int64_t length);
+bool StringIsFlat(const String *s);
+void DropString(String *s);
+
+int64_t StringLength(const String *s);
+const char *StringData(String *s);
+uint64_t HashChars(const char *chars, int64_t length);
+uint64_t StringHash(String *s);
+bool StringIsInterned(const String *s); // see intern.h
+
+bool StringsEqual(String *a, String *b);
+int StringCompare(String *a, String *b);
+
+int64_t FindChars(const char *haystack, int64_t haystack_length,
+                  const char *needle, int64_t needle_length); // -1 if not found
+int64_t StringFind(String *haystack, String *needle); // -1 if not found
+bool StringContains(String *haystack, String *needle);
+
+#endif
@@ -6,7 +6,8 @@
 
 #include <stdio.h>
 
-static int symbol_guid = 0;
+// Per thread, so isolates running side by side don't share a counter (see isolate.h)
+static _Thread_local int symbol_guid = 0;
 static Symbol NOT_FOUND = {
   .symbol_id = -1,
   .data_type = {
@@ -48,6 +49,28 @@ void DeleteSymbolTable(SymbolTable *st) {
   free(st);
 }
 
+/* Appends the symbols 'from' has past the end of 'into', values and
+ * all. Values aren't retained, so 'from' must only hold uncounted ones
+ * (literals and constant data), as a table that has only been type
+ * checked does */
+void CopyNewSymbols(SymbolTable *into, SymbolTable *from) {
+  for (int i = into->symbols.count; i < from->symbols.count; i++) {
+    DA_ADD(Symbol, into->symbols, DA_GET(from->symbols, i));
+  }
+  into->count = into->symbols.count;
+}
+
+int64_t SymbolTableBytes(SymbolTable *st) {
+  return (int64_t)sizeof(SymbolTable) + (int64_t)st->symbols.capacity * (int64_t)sizeof(Symbol);
+}
+
+// Drops the references that the symbols' values hold (see heap.h)
+void ReleaseSymbolValues(SymbolTable *st) {
+  for (int i = 0; i < st->symbols.count; i++) {
+    ReleaseValue(DA_GET(st->symbols, i).value);
+  }
+}
+
 Symbol NewSymbol(Token token, Type type, enum DeclarationState d) {
   Symbol s = {
     .symbol_id = -1,
@@ -146,12 +169,14 @@ Symbol SetDecl(SymbolTable *st, Token t, enum DeclarationState ds) {
 Symbol SetSymbolValue(SymbolTable *st, Token t, Value v) {
   Symbol s = RetrieveFrom(st, t);
   if (s.token.type == ERROR) {
-    Print("SetValue(): Token '%.*s' not found in symbol table", t.length, t.position_in_source);
+    Print("SetSymbolValue(): Token '%.*s' not found in symbol table", t.length, t.position_in_source);
     return NOT_FOUND;
   }
 
+  // AddTo() only updates the declaration of a symbol that's already in
+  // the table, so the value is written in place
   s.value = v;
-  return AddTo(st, s);
+  return SetSymbol(st, s);
 }
 
 Symbol SetSymbolDataType(SymbolTable *st, Token t, Type type) {
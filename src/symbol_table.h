@@ -36,6 +36,9 @@ typedef struct SymbolTable SymbolTable;
 
 SymbolTable *NewSymbolTable();
 void DeleteSymbolTable(SymbolTable *st);
+void CopyNewSymbols(SymbolTable *into, SymbolTable *from);
+int64_t SymbolTableBytes(SymbolTable *st);
+void ReleaseSymbolValues(SymbolTable *st);
 Symbol NewSymbol(Token token, Type type, enum DeclarationState d);
 
 Symbol AddTo(SymbolTable *st, Symbol s);
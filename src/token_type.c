@@ -10,10 +10,16 @@ static const char* const _TokenTypeTranslation[] =
   [CHAR] = "CHAR", [STRING] = "STRING",
   [BOOL] = "BOOL",
   [VOID] = "VOID",
+  [VECTOR_TYPE] = "VECTOR_TYPE",
   [ENUM] = "ENUM",
   [STRUCT] = "STRUCT",
+  [MAP] = "MAP",
+  [VEC] = "VEC",
+  [ATOMIC] = "ATOMIC",
+  [CHAN] = "CHAN",
   [IF] = "IF", [ELSE] = "ELSE", [WHILE] = "WHILE", [FOR] = "FOR",
   [BREAK] = "BREAK", [CONTINUE] = "CONTINUE", [RETURN] = "RETURN",
+  [CONST] = "CONST", [REF] = "REF",
 
   [IDENTIFIER] = "IDENTIFIER",
 
@@ -26,11 +32,12 @@ static const char* const _TokenTypeTranslation[] =
   [CHAR_LITERAL] = "CHAR_LITERAL",
   [BOOL_LITERAL] = "BOOL_LITERAL",
   [STRING_LITERAL] = "STRING_LITERAL",
+  [MEMORY_ORDER_LITERAL] = "MEMORY_ORDER_LITERAL",
 
   [LCURLY] = "LCURLY", [RCURLY] = "RCURLY",
   [LPAREN] = "LPAREN", [RPAREN] = "RPAREN",
   [LBRACKET] = "LBRACKET", [RBRACKET] = "RBRACKET",
-  [PERIOD] = "PERIOD", [COMMA] = "COMMA", [COLON] = "COLON", [SEMICOLON] = "SEMICOLON", [COLON_SEPARATOR] = "COLON_SEPARATOR",
+  [PERIOD] = "PERIOD", [DOT_DOT] = "DOT_DOT", [COMMA] = "COMMA", [COLON] = "COLON", [SEMICOLON] = "SEMICOLON", [COLON_SEPARATOR] = "COLON_SEPARATOR",
   [QUESTION_MARK] = "QUESTION_MARK",
 
   [LOGICAL_NOT] = "LOGICAL_NOT", [LOGICAL_AND] = "LOGICAL_AND", [LOGICAL_OR] = "LOGICAL_OR",
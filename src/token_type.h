@@ -11,9 +11,11 @@ typedef enum {
   CHAR, STRING,
   BOOL,
   VOID,
-  ENUM, STRUCT,
+  VECTOR_TYPE, // 'f32x4', 'u8x16', ...
+  ENUM, STRUCT, MAP, VEC, ATOMIC, CHAN,
   IF, ELSE, WHILE, FOR,
   BREAK, CONTINUE, RETURN,
+  CONST, REF,
 
   IDENTIFIER,
 
@@ -27,12 +29,13 @@ typedef enum {
   CHAR_LITERAL,
   BOOL_LITERAL,
   STRING_LITERAL,
+  MEMORY_ORDER_LITERAL, // 'relaxed', 'acquire', 'release', 'seq_cst'
 
   // Punctuators
   LCURLY, RCURLY,
   LPAREN, RPAREN,
   LBRACKET, RBRACKET,
-  PERIOD, COMMA, COLON, SEMICOLON, COLON_SEPARATOR,
+  PERIOD, DOT_DOT, COMMA, COLON, SEMICOLON, COLON_SEPARATOR,
   QUESTION_MARK,
 
   LOGICAL_NOT, LOGICAL_AND, LOGICAL_OR,
@@ -0,0 +1,156 @@
+// For clock_gettime() and flockfile(), which -std=c11 leaves out
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>     // for errno
+#include <stdatomic.h> // for atomic_int
+#include <stdint.h>    // for int64_t
+#include <stdio.h>     // for fopen et al.
+#include <stdlib.h>    // for atexit
+#include <string.h>    // for strlen, strerror
+#include <time.h>      // for clock_gettime
+#include <unistd.h>    // for getpid
+
+#include "error.h"
+#include "trace.h"
+
+#define TRACE_BUFFER_CAPACITY 4096
+
+typedef struct {
+  char phase; // 'B'egin or 'E'nd
+  const char *category;
+  const char *name;
+  int name_length;
+  int on_line;
+  int64_t timestamp_us;
+} TraceEvent;
+
+typedef struct {
+  int count;
+  int thread_id;
+  TraceEvent events[TRACE_BUFFER_CAPACITY];
+} TraceBuffer;
+
+static FILE *trace_file = NULL;
+static int64_t trace_start_us = 0;
+static int process_id = 0;
+
+static atomic_int next_thread_id = 1;
+static atomic_int events_written = 0;
+
+static _Thread_local TraceBuffer buffer;
+
+static int64_t NowMicroseconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void WriteEscaped(const char *s, int length) {
+  for (int i = 0; i < length; i++) {
+    char c = s[i];
+
+    if (c == '"' || c == '\\') {
+      fputc('\\', trace_file);
+      fputc(c, trace_file);
+    } else if ((unsigned char)c >= 0x20) {
+      fputc(c, trace_file);
+    }
+  }
+}
+
+static void WriteEvent(TraceEvent *e, int thread_id) {
+  flockfile(trace_file);
+
+  fputs((atomic_fetch_add(&events_written, 1) == 0) ? "\n" : ",\n", trace_file);
+
+  fprintf(trace_file, "{\"ph\":\"%c\",\"cat\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%lld",
+          e->phase, e->category, process_id, thread_id, (long long)e->timestamp_us);
+
+  if (e->phase == 'B') {
+    fputs(",\"name\":\"", trace_file);
+    WriteEscaped(e->name, e->name_length);
+    fputc('"', trace_file);
+
+    if (e->on_line > 0) {
+      fprintf(trace_file, ",\"args\":{\"line\":%d}", e->on_line);
+    }
+  }
+
+  fputc('}', trace_file);
+
+  funlockfile(trace_file);
+}
+
+static void CloseTrace() {
+  if (trace_file == NULL) return;
+
+  FlushTrace();
+  fputs("\n]}\n", trace_file);
+  fclose(trace_file);
+
+  trace_file = NULL;
+}
+
+void InitTrace(const char *filename) {
+  trace_file = fopen(filename, "w");
+  if (trace_file == NULL) COMPILER_ERROR_FMTMSG("InitTrace(): Could not open file %s: %s", filename, strerror(errno));
+
+  trace_start_us = NowMicroseconds();
+  process_id = getpid();
+
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", trace_file);
+
+  atexit(CloseTrace);
+}
+
+bool TraceEnabled() {
+  return trace_file != NULL;
+}
+
+static void Record(char phase, const char *category, const char *name, int name_length, int on_line) {
+  if (buffer.thread_id == 0) {
+    buffer.thread_id = atomic_fetch_add(&next_thread_id, 1);
+  }
+
+  if (buffer.count == TRACE_BUFFER_CAPACITY) {
+    FlushTrace();
+  }
+
+  buffer.events[buffer.count++] = (TraceEvent){
+    .phase = phase,
+    .category = category,
+    .name = name,
+    .name_length = name_length,
+    .on_line = on_line,
+    .timestamp_us = NowMicroseconds() - trace_start_us,
+  };
+}
+
+void TraceBegin(const char *category, const char *name) {
+  if (trace_file == NULL) return;
+
+  Record('B', category, name, strlen(name), 0);
+}
+
+void TraceBeginToken(const char *category, Token name) {
+  if (trace_file == NULL) return;
+
+  Record('B', category, name.position_in_source, name.length, name.on_line);
+}
+
+void TraceEnd(const char *category) {
+  if (trace_file == NULL) return;
+
+  Record('E', category, NULL, 0, 0);
+}
+
+void FlushTrace() {
+  if (trace_file == NULL) return;
+
+  for (int i = 0; i < buffer.count; i++) {
+    WriteEvent(&buffer.events[i], buffer.thread_id);
+  }
+
+  buffer.count = 0;
+}
@@ -0,0 +1,31 @@
+/* Timeline tracing in the Chrome trace-event JSON format.
+ *
+ * Tracing is off until InitTrace() is given an output path (see the
+ * --trace=<file> command line option). While off, TraceBegin() and
+ * TraceEnd() return immediately.
+ *
+ * Events are appended to a fixed-size per-thread buffer and written
+ * out whenever that buffer fills up, and once more at exit. Threads
+ * other than the main thread should call FlushTrace() before they
+ * exit, otherwise their last buffered events are lost.
+ *
+ * The resulting file can be loaded in chrome://tracing or Perfetto.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+#include "token.h"
+
+void InitTrace(const char *filename);
+bool TraceEnabled();
+
+void TraceBegin(const char *category, const char *name);
+void TraceBeginToken(const char *category, Token name);
+void TraceEnd(const char *category);
+
+void FlushTrace();
+
+#endif
@@ -48,6 +48,8 @@ Type _NewType(TokenType t, int array_size) {
     case STRING:
     case STRING_LITERAL: return _Type(T_STRING, TC_ARRAY, array_size);
 
+    case MEMORY_ORDER_LITERAL: return _Type(T_MEMORY_ORDER, _, array_size);
+
     case VOID: return _Type(T_VOID, _, array_size);
     case ENUM: return _Type(T_ENUM, _, array_size);
     case STRUCT: return _Type(T_STRUCT, _, array_size);
@@ -92,6 +94,13 @@ Type NewArrayType(TokenType t, int size) {
   return type;
 }
 
+Type NewVectorType(Type element, int lanes) {
+  element.category = TC_VECTOR;
+  element.array_size = lanes;
+
+  return element;
+}
+
 Type NewFunctionType(TokenType t) {
   Type type = _NewType(t, 0);
   type.category = TC_FUNCTION;
@@ -99,6 +108,64 @@ Type NewFunctionType(TokenType t) {
   return type;
 }
 
+Type NewMapType(Type key, Type value) {
+  Type type = _Type(T_MAP, TC_NONE, 0);
+  type.key_specifier = key.specifier;
+  type.value_specifier = value.specifier;
+
+  return type;
+}
+
+// Strings are arrays of unknown length, like a function's string return type
+static Type ContainedType(enum TypeSpecifier specifier) {
+  return _Type(specifier, (specifier == T_STRING) ? TC_ARRAY : TC_NONE, 0);
+}
+
+Type MapKeyType(Type map) {
+  return ContainedType(map.key_specifier);
+}
+
+Type MapValueType(Type map) {
+  return ContainedType(map.value_specifier);
+}
+
+Type NewVecType(Type element) {
+  Type type = _Type(T_VEC, TC_NONE, 0);
+  type.value_specifier = element.specifier;
+
+  return type;
+}
+
+Type VecElementType(Type vec) {
+  return ContainedType(vec.value_specifier);
+}
+
+Type NewAtomicType(Type value) {
+  Type type = _Type(T_ATOMIC, TC_NONE, 0);
+  type.value_specifier = value.specifier;
+
+  return type;
+}
+
+Type AtomicValueType(Type atomic) {
+  return ContainedType(atomic.value_specifier);
+}
+
+Type NewChanType(Type element, int capacity) {
+  Type type = _Type(T_CHAN, TC_NONE, capacity);
+  type.value_specifier = element.specifier;
+
+  return type;
+}
+
+Type ChanElementType(Type chan) {
+  return ContainedType(chan.value_specifier);
+}
+
+Type NewSliceType(Type element) {
+  return _Type(element.specifier, TC_SLICE, 0);
+}
+
 void InlinePrintType(Type t) {
   if (t.category == TC_FUNCTION) {
     Print("Fn::");
@@ -126,12 +193,33 @@ void InlinePrintType(Type t) {
 
     case T_ENUM: Print("enum"); break;
     case T_STRUCT: Print("struct"); break;
+    case T_MAP: {
+      Print("map<%s, %s>", TypeTranslation(MapKeyType(t)), TypeTranslation(MapValueType(t)));
+    } break;
+    case T_VEC: {
+      Print("vec<%s>", TypeTranslation(VecElementType(t)));
+    } break;
+    case T_ATOMIC: {
+      Print("atomic<%s>", TypeTranslation(AtomicValueType(t)));
+    } break;
+    case T_CHAN: {
+      Print("chan<%s, %d>", TypeTranslation(ChanElementType(t)), t.array_size);
+    } break;
+    case T_MEMORY_ORDER: Print("memory_order"); break;
     case T_VOID: Print("void"); break;
   }
 
   if (t.category == TC_ARRAY) {
     Print("[%d]", t.array_size);
   }
+
+  if (t.category == TC_VECTOR) {
+    Print("x%d", t.array_size);
+  }
+
+  if (t.category == TC_SLICE) {
+    Print("[..]");
+  }
 }
 
 void PrintType(Type t) {
@@ -143,6 +231,8 @@ const char *TypeCategoryTranslation(Type t) {
   switch (t.category) {
     case TC_NONE: return "NONE";
     case TC_ARRAY: return "ARRAY";
+    case TC_VECTOR: return "VECTOR";
+    case TC_SLICE: return "SLICE";
     case TC_FUNCTION: return "FUNCTION";
     default: return "NOT FOUND";
   }
@@ -171,6 +261,11 @@ const char *TypeTranslation(Type t) {
 
     case T_ENUM: return "enum";
     case T_STRUCT: return "struct";
+    case T_MAP: return "map";
+    case T_VEC: return "vec";
+    case T_ATOMIC: return "atomic";
+    case T_CHAN: return "chan";
+    case T_MEMORY_ORDER: return "memory_order";
     case T_VOID: return "void";
   }
 
@@ -189,9 +284,33 @@ bool TypesAreFloat(Type t1, Type t2) {
   return TypeIs_Float(t1) && TypeIs_Float(t2);
 }
 
+static int LaneSize(Type element) {
+  switch (element.specifier) {
+    case T_I8:  case T_U8:  return 1;
+    case T_I16: case T_U16: return 2;
+    case T_I32: case T_U32: case T_F32: return 4;
+    case T_I64: case T_U64: case T_F64: return 8;
+    default: return 0;
+  }
+}
+
+/* Numeric vectors fill a 128 or 256 bit register exactly. Bool vectors
+ * are the masks that comparing two of those produces, so they come in
+ * the same lane counts */
+bool VectorShapeIsValid(Type element, int lanes) {
+  if (TypeIs_Bool(element)) {
+    return lanes == 2 || lanes == 4 || lanes == 8 || lanes == 16 || lanes == 32;
+  }
+
+  int width = LaneSize(element) * lanes;
+  return TypeIs_Numeric(element) && (width == 16 || width == 32);
+}
+
 bool TypesMatchExactly(Type t1, Type t2) {
   return t1.category  == t2.category &&
-         t1.specifier == t2.specifier;
+         t1.specifier == t2.specifier &&
+         t1.key_specifier   == t2.key_specifier &&
+         t1.value_specifier == t2.value_specifier;
 }
 
 bool TypeIs_None(Type t) {
@@ -199,7 +318,15 @@ bool TypeIs_None(Type t) {
 }
 
 bool TypeIs_Array(Type t) {
-  return t.category == TC_ARRAY;
+  return t.category == TC_ARRAY || t.category == TC_VECTOR;
+}
+
+bool TypeIs_Vector(Type t) {
+  return t.category == TC_VECTOR;
+}
+
+bool TypeIs_Slice(Type t) {
+  return t.category == TC_SLICE;
 }
 
 bool TypeIs_Function(Type t) {
@@ -292,6 +419,22 @@ bool TypeIs_Struct(Type t) {
   return t.specifier == T_STRUCT;
 }
 
+bool TypeIs_Map(Type t) {
+  return t.specifier == T_MAP;
+}
+
+bool TypeIs_Vec(Type t) {
+  return t.specifier == T_VEC;
+}
+
+bool TypeIs_Atomic(Type t) {
+  return t.specifier == T_ATOMIC;
+}
+
+bool TypeIs_Chan(Type t) {
+  return t.specifier == T_CHAN;
+}
+
 bool TypeIs_Void(Type t) {
   return t.specifier == T_VOID;
 }
@@ -437,13 +580,13 @@ FnParam *GetFunctionParam(Type function_type, Token param_name) {
                              check->token.length);
 
     if (strcmp(ident, name) == 0) {
-      matching_param = function_type.params.next;
-      break;
+      matching_param = check;
     }
 
     check = (*check).next;
 
     free(name);
+    if (matching_param != NULL) break;
   }
 
   free(ident);
@@ -9,6 +9,8 @@
 enum TypeCategory {
   TC_NONE,
   TC_ARRAY,
+  TC_VECTOR, // An array that fits one SIMD register, e.g. 'f32x4'
+  TC_SLICE,  // A read-only view of part of an array, e.g. 'u8[..]'
   TC_FUNCTION,
 };
 
@@ -24,9 +26,21 @@ enum TypeSpecifier {
 
   T_ENUM,
   T_STRUCT,
+  T_MAP,
+  T_VEC,
+  T_ATOMIC,
+  T_CHAN,
+  T_MEMORY_ORDER, // of 'relaxed', 'acquire', ...
   T_VOID,
 };
 
+// How a function parameter is bound to its argument
+enum ParamMode {
+  PARAM_VALUE,
+  PARAM_REF,       // 'ref T x', the caller's variable itself
+  PARAM_CONST_REF, // 'const ref T x', the same but read-only
+};
+
 struct FnParam;
 struct StructMember;
 
@@ -42,10 +56,16 @@ typedef struct Type {
   enum TypeCategory  category;
   enum TypeSpecifier specifier;
 
-  int array_size;
+  int array_size; // also a chan's capacity
+
+  // 'map<string, i64>' uses both, 'vec<i64>', 'atomic<i64>' and 'chan<i64, N>' only the value
+  enum TypeSpecifier key_specifier;
+  enum TypeSpecifier value_specifier;
 
   struct ParamList params;
   struct MemberList members;
+
+  enum ParamMode param_mode; // PARAM_VALUE for anything but a parameter
 } Type;
 
 typedef struct StructMember {
@@ -67,13 +87,26 @@ Type SmallestContainingFloatType(double d);
 Type NoType();
 Type NewType(TokenType t);
 Type NewArrayType(TokenType t, int size);
+Type NewVectorType(Type element, int lanes);
 Type NewFunctionType(TokenType t);
+Type NewMapType(Type key, Type value);
+Type MapKeyType(Type map);
+Type MapValueType(Type map);
+Type NewVecType(Type element);
+Type NewSliceType(Type element);
+Type VecElementType(Type vec);
+Type NewAtomicType(Type value);
+Type AtomicValueType(Type atomic);
+Type NewChanType(Type element, int capacity);
+Type ChanElementType(Type chan);
 
 void InlinePrintType(Type t);
 void PrintType(Type t);
 const char *TypeCategoryTranslation(Type t);
 const char *TypeTranslation(Type t);
 
+bool VectorShapeIsValid(Type element, int lanes);
+
 bool TypesMatchExactly(Type t1, Type t2);
 bool TypesAreInt(Type t1, Type t2);
 bool TypesAreUint(Type t1, Type t2);
@@ -81,7 +114,9 @@ bool TypesAreFloat(Type t1, Type t2);
 
 bool TypeIs_None(Type t);
 
-bool TypeIs_Array(Type t);
+bool TypeIs_Array(Type t); // also true for vectors
+bool TypeIs_Vector(Type t);
+bool TypeIs_Slice(Type t);
 bool TypeIs_Function(Type t);
 
 bool TypeIs_Numeric(Type t);
@@ -109,6 +144,10 @@ bool TypeIs_Bool(Type t);
 
 bool TypeIs_Enum(Type t);
 bool TypeIs_Struct(Type t);
+bool TypeIs_Map(Type t);
+bool TypeIs_Vec(Type t);
+bool TypeIs_Atomic(Type t);
+bool TypeIs_Chan(Type t);
 bool TypeIs_Void(Type t);
 
 bool StructContainsMember(Type struct_type, Token member_name);
@@ -2,9 +2,16 @@
 #include <float.h>    // for FLT_MIN, FLT_MAX, DBL_MIN, DBL_MAX
 #include <inttypes.h> // for INTX_MIN and INTX_MAX
 #include <stdlib.h>   // for strtol and friends
+#include <string.h>   // for strerror
 
+#include "atomic.h"
+#include "bits.h"
+#include "builtins.h"
 #include "common.h"
+#include "constant_data.h"
 #include "error.h"
+#include "io.h"
+#include "trace.h"
 #include "type_checker.h"
 
 #include <stdio.h>
@@ -117,7 +124,8 @@ bool TypeIsConvertible(AST_Node *from, AST_Node *target_type) {
 
   if (NodeIs_Identifier(from) ||
       NodeIs_Return(from) ||
-      NodeIs_TernaryIf(from)) {
+      NodeIs_TernaryIf(from) ||
+      NodeIs_BuiltinCall(from)) {
     return types_match;
   }
 
@@ -142,9 +150,100 @@ bool TypeIsConvertible(AST_Node *from, AST_Node *target_type) {
 
   return false;
 }
+
+// A whole array value, as opposed to a single element read through a
+// subscript. An array that's declared but not yet defined is parsed as
+// a declaration node, so the subscript is checked whatever the node is
+static bool IsWholeArray(AST_Node *n) {
+  bool is_element = (n->middle != NULL && NodeIs_ArraySubscript(n->middle));
+
+  return TypeIs_Array(n->data_type) &&
+         !TypeIs_String(n->data_type) &&
+         !is_element &&
+         !(NodeIs_Identifier(n) && n->middle != NULL);
+}
+
+static Type ElementType(Type t) {
+  t.category = TC_NONE;
+  t.array_size = 0;
+
+  return t;
+}
+
+// For element-wise operators: at least one side is a whole array, the
+// other is an array of the same type and size or a scalar that converts
+// to the element type. Returns the array operand.
+static AST_Node *ElementWiseOperands(AST_Node *node) {
+  AST_Node *array = IsWholeArray(node->left) ? node->left : node->right;
+  AST_Node *other = (array == node->left) ? node->right : node->left;
+
+  if (IsWholeArray(other)) {
+    if (TypeIs_Vector(array->data_type) != TypeIs_Vector(other->data_type)) {
+      ERROR_FMT(ERR_TYPE_DISAGREEMENT, other->token, "Can't mix a vector and an array, use %s() or %s()", BuiltinName(BUILTIN_LOAD), BuiltinName(BUILTIN_STORE));
+    }
+
+    if (array->data_type.specifier != other->data_type.specifier) {
+      ERROR_FMT(ERR_TYPE_DISAGREEMENT, other->token, "Element types differ: %s and %s", TypeTranslation(array->data_type), TypeTranslation(other->data_type));
+    }
+
+    if (array->data_type.array_size != other->data_type.array_size) {
+      ERROR_FMT(ERR_TYPE_DISAGREEMENT, other->token, "Array sizes differ: %d and %d", array->data_type.array_size, other->data_type.array_size);
+    }
+
+    return array;
+  }
+
+  AST_Node element = *array;
+  element.data_type = ElementType(array->data_type);
+  if (!TypeIsConvertible(other, &element)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, other->token, "Can't convert from %s to %s", TypeTranslation(other->data_type), TypeTranslation(element.data_type));
+  }
+
+  return array;
+}
+// Slices are read through their elements; operators don't apply to a whole one
+static void NoSliceOperands(AST_Node *node) {
+  AST_Node *slice = (TypeIs_Slice(node->left->data_type))  ? node->left
+                  : (TypeIs_Slice(node->right->data_type)) ? node->right
+                                                           : NULL;
+  if (slice != NULL) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, slice->token, "'%s' is not defined for slices", TokenTypeTranslation(node->token.type));
+  }
+}
+
+// Looked up by name, since node types get overwritten along the way. NULL unless 'n' is a ref param
+static FnParam *RefParam(AST_Node *n) {
+  if (in_function == NULL || n->token.type != IDENTIFIER) return NULL;
+
+  FnParam *param = GetFunctionParam(*in_function, n->token);
+  return (param != NULL && param->type.param_mode != PARAM_VALUE) ? param : NULL;
+}
+
+static void NotConstRef(AST_Node *target) {
+  FnParam *param = RefParam(target);
+  if (param != NULL && param->type.param_mode == PARAM_CONST_REF) {
+    ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, target->token, "'%.*s' is a const ref parameter, which is read-only", target->token.length, target->token.position_in_source);
+  }
+}
+
+// A ref param is the caller's variable, so all of it (or a slice of it) has to stay inside the call
+static void NotEscapingRef(AST_Node *value, const char *how) {
+  FnParam *param = RefParam(value);
+  if (param == NULL) return;
+
+  bool is_whole = (value->middle == NULL || NodeIs_ArraySlice(value->middle));
+  bool is_heap_backed = TypeIs_Array(param->type) || TypeIs_Slice(param->type) ||
+                        TypeIs_String(param->type) || TypeIs_Struct(param->type);
+  if (is_whole && is_heap_backed) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, value->token, "'%.*s' is a ref parameter and can't be %s", value->token.length, value->token.position_in_source, how);
+  }
+}
 /* === End Helpers === */
 
 static void InitializerList(AST_Node *list, AST_Node *target_type) {
+  // Number literal lists are checked as they're parsed, see DenseInitializerList() in parser.c
+  if (NodeHasFact(list, FACT_CONSTANT_DATA)) return;
+
   AST_Node **current = &list;
 
   int num_literals_in_list = 0;
@@ -168,8 +267,73 @@ static void InitializerList(AST_Node *list, AST_Node *target_type) {
   }
 }
 
+static void WholeArrayAssignment(AST_Node *identifier, AST_Node *value) {
+  if (!IsWholeArray(value)) {
+    ERROR_MSG(ERR_IMPROPER_ASSIGNMENT, identifier->token, "Arrays can only be assigned an initializer list or another array");
+  }
+
+  if (identifier->data_type.specifier != value->data_type.specifier) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, identifier->token, "Can't assign %s to %s", TypeTranslation(value->data_type), TypeTranslation(identifier->data_type));
+  }
+
+  if (TypeIs_Vector(identifier->data_type) != TypeIs_Vector(value->data_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, identifier->token, "Can't assign %s to %s, use %s() or %s()",
+              TypeCategoryTranslation(value->data_type), TypeCategoryTranslation(identifier->data_type),
+              BuiltinName(BUILTIN_LOAD), BuiltinName(BUILTIN_STORE));
+  }
+
+  if (identifier->data_type.array_size != value->data_type.array_size) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, identifier->token, "Array sizes differ: %d and %d", identifier->data_type.array_size, value->data_type.array_size);
+  }
+}
+
+// A whole array or vector converts to a slice of all of it
+static void SliceAssignment(AST_Node *identifier, AST_Node *value) {
+  if (identifier->middle != NULL) {
+    ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, identifier->token, "'%.*s' is a slice, which is read-only", identifier->token.length, identifier->token.position_in_source);
+  }
+
+  bool is_sliceable = TypeIs_Slice(value->data_type) || IsWholeArray(value);
+  if (NodeIs_TerseAssignment(identifier) || !is_sliceable ||
+      value->data_type.specifier != identifier->data_type.specifier) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, identifier->token, "Can't assign %s to %s", TypeTranslation(value->data_type), TypeTranslation(identifier->data_type));
+  }
+}
+
+// 'a + b' and 'a += b' on strings; anything else is a type error
+static void StringConcatenation(AST_Node *node, AST_Node *left, AST_Node *right) {
+  if (node->token.type != PLUS && node->token.type != PLUS_EQUALS) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, node->token, "'%s' is not defined for strings", TokenTypeTranslation(node->token.type));
+  }
+
+  if (!TypeIs_String(left->data_type) || !TypeIs_String(right->data_type)) {
+    AST_Node *culprit = (TypeIs_String(left->data_type)) ? right : left;
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, culprit->token, "Can only concatenate strings, got '%s'", TypeTranslation(culprit->data_type));
+  }
+
+  SetNodeDataType(node, NewArrayType(STRING, left->data_type.array_size + right->data_type.array_size));
+}
+
 static void Assignment(AST_Node *identifier) {
-  if (!TypeIs_Array(identifier->data_type) && identifier->middle != NULL) {
+  AST_Node *target = (NodeIs_TerseAssignment(identifier)) ? identifier->left : identifier;
+  NotConstRef(target);
+
+  if (TypeIs_Atomic(target->data_type)) {
+    ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, target->token, "'%.*s' is atomic, use %s()", target->token.length, target->token.position_in_source, BuiltinName(BUILTIN_STORE));
+  }
+
+  if (TypeIs_Chan(target->data_type)) {
+    ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, target->token, "'%.*s' is a chan, use %s()", target->token.length, target->token.position_in_source, BuiltinName(BUILTIN_SEND));
+  }
+
+  if (TypeIs_Slice(identifier->data_type)) {
+    SliceAssignment(identifier, identifier->left);
+    return;
+  }
+
+  if (TypeIs_Vec(identifier->data_type) && identifier->middle != NULL) {
+    SetNodeDataType(identifier, VecElementType(identifier->data_type));
+  } else if (!TypeIs_Array(identifier->data_type) && identifier->middle != NULL) {
     ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, identifier->token, "'%.*s' is not an array", identifier->token.length, identifier->token.position_in_source);
   }
 
@@ -185,7 +349,9 @@ static void Assignment(AST_Node *identifier) {
     ERROR_FMT(ERR_TYPE_DISAGREEMENT, value->token, "'%s' cannot be assigned to non-Uint types", TokenTypeTranslation(value->token.type));
   }
 
-  if (NodeIs_TerseAssignment(identifier)) {
+  if (NodeIs_TerseAssignment(identifier) && TypeIs_String(value->data_type)) {
+    StringConcatenation(identifier, value, identifier->right);
+  } else if (NodeIs_TerseAssignment(identifier)) {
     if (!TypeIs_Numeric(value->data_type)) {
       ERROR_MSG(ERR_TYPE_DISAGREEMENT, value->token, "Left hand side must be numeric");
     }
@@ -195,7 +361,9 @@ static void Assignment(AST_Node *identifier) {
       ERROR_MSG(ERR_TYPE_DISAGREEMENT, identifier->right->token, "Right hand side must be numeric");
     }
 
-    SetNodeDataType(identifier, value->data_type);
+    // 'a[i] += x' works on one element
+    bool on_element = value->middle != NULL && TypeIs_Array(value->data_type) && !TypeIs_String(value->data_type);
+    SetNodeDataType(identifier, (on_element) ? ElementType(value->data_type) : value->data_type);
   }
 
   if (NodeIs_ArrayInitializerList(value)) {
@@ -203,6 +371,17 @@ static void Assignment(AST_Node *identifier) {
     return;
   }
 
+  if (IsWholeArray(identifier) && identifier->middle == NULL) {
+    WholeArrayAssignment(identifier, value);
+    return;
+  }
+
+  // A whole array, e.g. 'a * 2', only fits in another whole array
+  AST_Node *assigned = (NodeIs_TerseAssignment(identifier)) ? identifier->right : value;
+  if (assigned != NULL && IsWholeArray(assigned)) {
+    ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, assigned->token, "Can't assign a whole array to '%.*s'", target->token.length, target->token.position_in_source);
+  }
+
   if (!TypeIsConvertible(value, identifier)) {
     if (TypeIs_Enum(value->data_type)) {
       ERROR(ERR_IMPROPER_ASSIGNMENT, identifier->token);
@@ -237,7 +416,57 @@ static void Assignment(AST_Node *identifier) {
   return;
 }
 
+// A literal bound past the end of a fixed-size array is caught here, anything else when it runs
+static void SliceBounds(AST_Node *identifier, AST_Node *lo, AST_Node *hi) {
+  bool lo_is_literal = (lo != NULL && lo->token.type == INT_LITERAL);
+  bool hi_is_literal = (hi != NULL && hi->token.type == INT_LITERAL);
+  int size = (TypeIs_Array(identifier->data_type) && !TypeIs_String(identifier->data_type))
+               ? identifier->data_type.array_size
+               : 0;
+
+  if (lo_is_literal && hi_is_literal && TokenToInt64(lo->token) > TokenToInt64(hi->token)) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, lo->token, "Slice of '%.*s' starts after it ends",
+              identifier->token.length, identifier->token.position_in_source);
+  }
+
+  AST_Node *last = (hi_is_literal) ? hi : (lo_is_literal) ? lo : NULL;
+  if (size > 0 && last != NULL && TokenToInt64(last->token) > size) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, last->token, "Slice of '%.*s' ends past its size (%d)",
+              identifier->token.length, identifier->token.position_in_source, size);
+  }
+}
+
+// 'a[lo..hi]' of an array, vector or slice is a slice; of a string, a string
+static void Slice(AST_Node *identifier) {
+  Type base = identifier->data_type;
+  if (!TypeIs_Array(base) && !TypeIs_Slice(base)) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, identifier->token, "'%.*s' can't be sliced", identifier->token.length, identifier->token.position_in_source);
+  }
+
+  SliceBounds(identifier, identifier->middle->left, identifier->middle->right);
+
+  Type result = (TypeIs_String(base)) ? NewArrayType(STRING, 0) : NewSliceType(ElementType(base));
+  SetNodeDataType(identifier->middle, result);
+  SetNodeDataType(identifier, result);
+}
+
 static void Identifier(AST_Node *identifier) {
+  if (identifier->middle != NULL && NodeIs_ArraySlice(identifier->middle)) {
+    Slice(identifier);
+    return;
+  }
+
+  // 'v[i]' is one element, checked against the count when it runs
+  if (TypeIs_Vec(identifier->data_type) && identifier->middle != NULL) {
+    SetNodeDataType(identifier, VecElementType(identifier->data_type));
+    return;
+  }
+
+  if (TypeIs_Slice(identifier->data_type) && identifier->middle != NULL) {
+    SetNodeDataType(identifier, ElementType(identifier->data_type));
+    return;
+  }
+
   if (!TypeIs_Array(identifier->data_type) && identifier->middle != NULL) {
     ERROR_FMT(ERR_IMPROPER_ACCESS, identifier->token, "'%.*s' is not an array", identifier->token.length, identifier->token.position_in_source);
   }
@@ -263,6 +492,8 @@ static void Return(AST_Node* node) {
     return;
   }
 
+  NotEscapingRef(node->left, "returned");
+
   SetNodeDataType(node, node->left->data_type);
 }
 
@@ -391,6 +622,49 @@ static void Function(AST_Node *node) {
   }
 }
 
+// A ref param needs a variable of its exact type to name, and a const ref can't be passed on as a writable one
+static void RefArguments(AST_Node *node) {
+  FnParam *param = node->data_type.params.next;
+
+  for (AST_Node *arg = node->middle; arg != NULL && param != NULL; arg = arg->right, param = param->next) {
+    if (TypeIs_Atomic(arg->data_type)) {
+      ERROR_FMT(ERR_IMPROPER_ACCESS, arg->token, "'%.*s' is atomic, use %s()", arg->token.length, arg->token.position_in_source, BuiltinName(BUILTIN_LOAD));
+    }
+
+    if (TypeIs_Chan(arg->data_type)) {
+      ERROR_FMT(ERR_IMPROPER_ACCESS, arg->token, "'%.*s' is a chan and can't be passed to a function", arg->token.length, arg->token.position_in_source);
+    }
+
+    if (param->type.param_mode == PARAM_VALUE) continue;
+
+    bool is_variable = (arg->node_type == FUNCTION_ARGUMENT_NODE && arg->token.type == IDENTIFIER && arg->left == NULL);
+    if (!is_variable) {
+      ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, arg->token, "%.*s(): '%.*s' is a ref parameter, pass it a variable",
+                node->token.length, node->token.position_in_source,
+                param->token.length, param->token.position_in_source);
+    }
+
+    bool same_shape = TypeIs_String(param->type) || arg->data_type.category == param->type.category;
+    if (!same_shape || arg->data_type.specifier != param->type.specifier) {
+      ERROR_FMT(ERR_TYPE_DISAGREEMENT, arg->token, "%.*s(): Can't pass %s as ref %s",
+                node->token.length, node->token.position_in_source,
+                TypeTranslation(arg->data_type), TypeTranslation(param->type));
+    }
+
+    if (param->type.param_mode != PARAM_REF) continue;
+    NotConstRef(arg);
+
+    // The variable is the ref param's for the call, so it can't go by another name as well
+    for (AST_Node *other = node->middle; other != NULL; other = other->right) {
+      if (other != arg && other->node_type == FUNCTION_ARGUMENT_NODE && TokenValuesMatch(other->token, arg->token)) {
+        ERROR_FMT(ERR_IMPROPER_ASSIGNMENT, other->token, "%.*s(): '%.*s' is passed by ref, it can't be passed twice",
+                  node->token.length, node->token.position_in_source,
+                  arg->token.length, arg->token.position_in_source);
+      }
+    }
+  }
+}
+
 /*
 static void FunctionCall(AST_Node *node) {
   AST_Node **current = &(node)->middle;
@@ -488,8 +762,37 @@ static void UnaryOp(AST_Node *node) {
   }
 }
 
+static void ElementWiseArithmeticOp(AST_Node *node) {
+  AST_Node *array = ElementWiseOperands(node);
+
+  if (!TypeIs_Numeric(array->data_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "Expected a numeric array, got '%s'", TypeTranslation(array->data_type));
+  }
+
+  if (node->token.type == MODULO && TypeIs_Float(array->data_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, node->token, "'%%' is not defined for '%s'", TypeTranslation(array->data_type));
+  }
+
+  SetNodeDataType(node, array->data_type);
+}
+
 static void BinaryArithmeticOp(AST_Node *node) {
-  node->data_type = node->left->data_type;
+  NoSliceOperands(node);
+
+  if (TypeIs_String(node->left->data_type) || TypeIs_String(node->right->data_type)) {
+    StringConcatenation(node, node->left, node->right);
+    return;
+  }
+
+  if (IsWholeArray(node->left) || IsWholeArray(node->right)) {
+    ElementWiseArithmeticOp(node);
+    return;
+  }
+
+  // An array operand here is a single element, e.g. 'nums[i] + 1'
+  node->data_type = (TypeIs_Array(node->left->data_type) && !TypeIs_String(node->left->data_type))
+                      ? ElementType(node->left->data_type)
+                      : node->left->data_type;
 
   if (!TypeIsConvertible(node->right, node)) {
     ERROR_FMT(ERR_TYPE_DISAGREEMENT, node->right->token, "Can't convert from type %s to %s", TypeTranslation(node->right->data_type), TypeTranslation(node->data_type));
@@ -498,7 +801,33 @@ static void BinaryArithmeticOp(AST_Node *node) {
   SetNodeDataType(node->right, node->data_type);
 }
 
+static void ElementWiseLogicalOp(AST_Node *node) {
+  AST_Node *array = ElementWiseOperands(node);
+  bool is_and_or = (node->token.type == LOGICAL_AND || node->token.type == LOGICAL_OR);
+
+  if (is_and_or && !TypeIs_Bool(array->data_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "Expected a BOOL array, got '%s'", TypeTranslation(array->data_type));
+  }
+
+  if (!is_and_or && !TypeIs_Numeric(array->data_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "Expected a numeric array, got '%s'", TypeTranslation(array->data_type));
+  }
+
+  // Comparing vectors gives a mask of the same lane count
+  Type result = (TypeIs_Vector(array->data_type))
+                  ? NewVectorType(NewType(BOOL), array->data_type.array_size)
+                  : NewArrayType(BOOL, array->data_type.array_size);
+  SetNodeDataType(node, result);
+}
+
 static void BinaryLogicalOp(AST_Node *node) {
+  NoSliceOperands(node);
+
+  if (IsWholeArray(node->left) || IsWholeArray(node->right)) {
+    ElementWiseLogicalOp(node);
+    return;
+  }
+
   switch(node->token.type) {
     case LESS_THAN:
     case GREATER_THAN:
@@ -555,6 +884,8 @@ static void BinaryLogicalOp(AST_Node *node) {
 }
 
 static void BinaryBitwiseOp(AST_Node *node) {
+  NoSliceOperands(node);
+
   AST_Node *left_value = node->left;
   AST_Node *right_value = node->right;
 
@@ -578,6 +909,622 @@ static void BinaryBitwiseOp(AST_Node *node) {
   }
 }
 
+// The file is mapped now, since its size is part of the type
+static void IncludeBytes(AST_Node *node, Token path) {
+  char *filename = ResolvePath(path.from_filename, path.position_in_source, path.length);
+
+  ArrayValue *bytes = MapConstantArray(filename);
+  if (bytes == NULL) {
+    ERROR_FMT(ERR_MISC, path, "%s(): Could not open '%s': %s", BuiltinName(BUILTIN_INCLUDE_BYTES), filename, strerror(errno));
+  }
+
+  if (bytes->count == 0) {
+    ERROR_FMT(ERR_EMPTY_BODY, path, "%s(): '%s' is empty", BuiltinName(BUILTIN_INCLUDE_BYTES), filename);
+  }
+
+  if (bytes->count > INT32_MAX) {
+    ERROR_FMT(ERR_OVERFLOW, path, "%s(): '%s' is too large for an array", BuiltinName(BUILTIN_INCLUDE_BYTES), filename);
+  }
+
+  free(filename);
+
+  Type t = NewArrayType(U8, (int)bytes->count);
+  SetNodeDataType(node, t);
+  node->value = (Value){ .type = t, .as.array = bytes };
+  AddNodeFact(node, FACT_CONSTANT_DATA);
+}
+
+static bool IsIntegerLiteral(AST_Node *n) {
+  return n->node_type == LITERAL_NODE &&
+         (n->token.type == INT_LITERAL || n->token.type == HEX_LITERAL || n->token.type == BINARY_LITERAL);
+}
+
+// Integer literals are taken as u64, anything else must be an unsigned integer
+static Type BitOperandType(AST_Node *arg, Builtin builtin) {
+  AST_Node *value = arg->left;
+
+  if (IsIntegerLiteral(value)) {
+    if (Uint64Overflow(value->token)) {
+      ERROR_FMT(ERR_OVERFLOW, value->token, "%s(): Literal value overflows 'u64'", BuiltinName(builtin));
+    }
+
+    return NewType(U64);
+  }
+
+  Type t = ElementType(value->data_type);
+  if (IsWholeArray(value) || !TypeIs_Uint(t)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, value->token, "%s() expects an unsigned integer, got '%s'",
+              BuiltinName(builtin), TypeTranslation(value->data_type));
+  }
+
+  return t;
+}
+
+// A literal next to a narrower operand takes its type, and must fit in it
+static Type BitLiteralAs(AST_Node *arg, Type t, Builtin builtin) {
+  uint64_t max = (TypeIs_U8(t))  ? UINT8_MAX
+               : (TypeIs_U16(t)) ? UINT16_MAX
+               : (TypeIs_U32(t)) ? UINT32_MAX
+               : UINT64_MAX;
+
+  if (TokenToUint64(arg->left->token) > max) {
+    ERROR_FMT(ERR_OVERFLOW, arg->left->token, "%s(): Literal value overflows '%s'", BuiltinName(builtin), TypeTranslation(t));
+  }
+
+  return t;
+}
+
+static void BitIntrinsic(AST_Node *node, Builtin builtin) {
+  AST_Node *first = node->middle;
+  AST_Node *second = first->right;
+
+  Type operand_type = BitOperandType(first, builtin);
+
+  if (second != NULL) {
+    Type second_type = BitOperandType(second, builtin);
+
+    // rotl() and rotr() take an unsigned amount of any width, pext() and
+    // pdep() a mask of the same type as the value
+    bool is_rotate = (builtin == BUILTIN_ROTL || builtin == BUILTIN_ROTR);
+    if (!is_rotate) {
+      if (IsIntegerLiteral(first->left)) {
+        operand_type = BitLiteralAs(first, second_type, builtin);
+      } else if (IsIntegerLiteral(second->left)) {
+        second_type = BitLiteralAs(second, operand_type, builtin);
+      } else if (operand_type.specifier != second_type.specifier) {
+        ERROR_FMT(ERR_TYPE_DISAGREEMENT, second->left->token, "%s() expects a '%s' mask, got '%s'",
+                  BuiltinName(builtin), TypeTranslation(operand_type), TypeTranslation(second_type));
+      }
+    }
+
+    SetNodeDataType(second, second_type);
+  }
+
+  SetNodeDataType(first, operand_type);
+
+  SetNodeDataType(node, (builtin == BUILTIN_PARITY) ? NewType(BOOL) : operand_type);
+
+  bool all_literals = IsIntegerLiteral(first->left) && (second == NULL || IsIntegerLiteral(second->left));
+  if (all_literals) {
+    uint64_t x = TokenToUint64(first->left->token);
+    uint64_t y = (second != NULL) ? TokenToUint64(second->left->token) : 0;
+
+    node->value = ApplyBitIntrinsic(builtin, operand_type, x, y);
+    AddNodeFact(node, FACT_CONSTANT_DATA);
+  }
+}
+
+static bool IsWholeVector(AST_Node *n) {
+  return IsWholeArray(n) && TypeIs_Vector(n->data_type);
+}
+
+static bool IsPlainArray(AST_Node *n) {
+  return IsWholeArray(n) && !TypeIs_Vector(n->data_type);
+}
+
+// An integer argument: an offset, an index or a count
+static void IntegerArgument(AST_Node *arg, Builtin builtin) {
+  AST_Node *value = arg->left;
+  Type t = ElementType(value->data_type);
+
+  if (IsWholeArray(value) || !(TypeIs_Int(t) || TypeIs_Uint(t))) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, value->token, "%s() expects an integer, got '%s'", BuiltinName(builtin), TypeTranslation(value->data_type));
+  }
+
+  SetNodeDataType(arg, t);
+}
+
+// A literal offset is checked against the array size here, anything else when it runs
+static void VectorLanesInBounds(AST_Node *array, AST_Node *offset, int lanes, Builtin builtin) {
+  if (offset->node_type != LITERAL_NODE || array->data_type.array_size == 0) return;
+
+  int64_t first = TokenToInt64(offset->token);
+  if (first < 0 || first + lanes > array->data_type.array_size) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, offset->token, "%s(): Lanes [%lld, %lld] are outside '%.*s' (size %d)",
+              BuiltinName(builtin), (long long)first, (long long)(first + lanes - 1),
+              array->token.length, array->token.position_in_source, array->data_type.array_size);
+  }
+}
+
+static void Shuffle(AST_Node *node) {
+  AST_Node *vector = node->middle->left;
+  AST_Node *indices = node->middle->right->left;
+
+  if (!IsWholeVector(vector)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, vector->token, "%s() expects a vector, got '%s'", BuiltinName(BUILTIN_SHUFFLE), TypeTranslation(vector->data_type));
+  }
+
+  if (!IsWholeVector(indices) || !(TypeIs_Int(indices->data_type) || TypeIs_Uint(indices->data_type))) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, indices->token, "%s() expects an integer vector of lane indices, got '%s'", BuiltinName(BUILTIN_SHUFFLE), TypeTranslation(indices->data_type));
+  }
+
+  if (vector->data_type.array_size != indices->data_type.array_size) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, indices->token, "Lane counts differ: %d and %d", vector->data_type.array_size, indices->data_type.array_size);
+  }
+
+  SetNodeDataType(node->middle, vector->data_type);
+  SetNodeDataType(node->middle->right, indices->data_type);
+  SetNodeDataType(node, vector->data_type);
+}
+
+// The lane count is a literal, since it's part of the result type
+static void Load(AST_Node *node) {
+  AST_Node *array = node->middle->left;
+  AST_Node *offset = node->middle->right->left;
+  AST_Node *lanes = node->middle->right->right->left;
+
+  if (!IsPlainArray(array)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects an array, got '%s'", BuiltinName(BUILTIN_LOAD), TypeTranslation(array->data_type));
+  }
+
+  IntegerArgument(node->middle->right, BUILTIN_LOAD);
+
+  if (lanes->node_type != LITERAL_NODE || lanes->token.type != INT_LITERAL) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, lanes->token, "%s() expects the lane count as an integer literal", BuiltinName(BUILTIN_LOAD));
+  }
+
+  Type element = ElementType(array->data_type);
+  int64_t lane_count = TokenToInt64(lanes->token);
+  if (lane_count > INT32_MAX || !VectorShapeIsValid(element, lane_count)) {
+    ERROR_FMT(ERR_IMPROPER_DECLARATION, lanes->token, "%s(): %lld lanes of %s don't fill a 128 or 256 bit register",
+              BuiltinName(BUILTIN_LOAD), (long long)lane_count, TypeTranslation(element));
+  }
+
+  VectorLanesInBounds(array, offset, lane_count, BUILTIN_LOAD);
+
+  SetNodeDataType(node->middle, array->data_type);
+  SetNodeDataType(node->middle->right->right, lanes->data_type);
+  SetNodeDataType(node, NewVectorType(element, lane_count));
+}
+
+// Writes back to the variable, so the array has to be one
+static void Store(AST_Node *node) {
+  AST_Node *array = node->middle->left;
+  AST_Node *offset = node->middle->right->left;
+  AST_Node *vector = node->middle->right->right->left;
+
+  if (!NodeIs_Identifier(array) || !IsPlainArray(array)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects an array variable, got '%s'", BuiltinName(BUILTIN_STORE), TypeTranslation(array->data_type));
+  }
+  NotConstRef(array);
+
+  IntegerArgument(node->middle->right, BUILTIN_STORE);
+
+  if (!IsWholeVector(vector)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, vector->token, "%s() expects a vector, got '%s'", BuiltinName(BUILTIN_STORE), TypeTranslation(vector->data_type));
+  }
+
+  if (vector->data_type.specifier != array->data_type.specifier) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, vector->token, "Element types differ: %s and %s", TypeTranslation(array->data_type), TypeTranslation(vector->data_type));
+  }
+
+  VectorLanesInBounds(array, offset, vector->data_type.array_size, BUILTIN_STORE);
+
+  SetNodeDataType(node->middle, array->data_type);
+  SetNodeDataType(node->middle->right->right, vector->data_type);
+  SetNodeDataType(node, NewType(VOID));
+}
+
+// insert(), remove() and reserve() write back to the variable, so the map has to be one
+static AST_Node *MapArgument(AST_Node *arg, Builtin builtin, bool written) {
+  AST_Node *map = arg->left;
+  bool is_variable = NodeIs_Identifier(map) && map->middle == NULL;
+
+  if (!TypeIs_Map(map->data_type) || (written && !is_variable)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, map->token, "%s() expects a map%s, got '%s'", BuiltinName(builtin), (written) ? " variable" : "", TypeTranslation(map->data_type));
+  }
+
+  if (written) NotConstRef(map);
+
+  SetNodeDataType(arg, map->data_type);
+  return map;
+}
+
+// Keys, values and vec elements convert the same way as when assigned to a variable of that type
+static void ContainedOperand(AST_Node *arg, Type expected, Builtin builtin) {
+  AST_Node *value = arg->left;
+  AST_Node target = *value;
+  target.data_type = expected;
+
+  if (IsWholeArray(value) || !TypeIsConvertible(value, &target)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, value->token, "%s(): Can't convert from %s to %s", BuiltinName(builtin), TypeTranslation(value->data_type), TypeTranslation(expected));
+  }
+
+  // A string keeps its own length
+  if (!TypeIs_String(expected)) SetNodeDataType(value, expected);
+  SetNodeDataType(arg, value->data_type);
+}
+
+static void MapBuiltin(AST_Node *node, Builtin builtin) {
+  AST_Node *first = node->middle;
+  AST_Node *second = first->right;
+
+  bool written = (builtin == BUILTIN_INSERT || builtin == BUILTIN_REMOVE || builtin == BUILTIN_RESERVE);
+  Type map_type = MapArgument(first, builtin, written)->data_type;
+
+  switch (builtin) {
+    case BUILTIN_INSERT: {
+      ContainedOperand(second, MapKeyType(map_type), builtin);
+      ContainedOperand(second->right, MapValueType(map_type), builtin);
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_GET: {
+      ContainedOperand(second, MapKeyType(map_type), builtin);
+      SetNodeDataType(node, MapValueType(map_type));
+    } break;
+    case BUILTIN_CONTAINS:
+    case BUILTIN_REMOVE: {
+      ContainedOperand(second, MapKeyType(map_type), builtin);
+      SetNodeDataType(node, NewType(BOOL));
+    } break;
+    case BUILTIN_RESERVE: {
+      IntegerArgument(second, builtin);
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_ELEMENT_COUNT: {
+      SetNodeDataType(node, NewType(I64));
+    } break;
+    case BUILTIN_KEY_AT:
+    case BUILTIN_VALUE_AT: {
+      IntegerArgument(second, builtin);
+      SetNodeDataType(node, (builtin == BUILTIN_KEY_AT) ? MapKeyType(map_type) : MapValueType(map_type));
+    } break;
+    default: {
+      COMPILER_ERROR_FMTMSG("MapBuiltin(): '%s' is not a map builtin", BuiltinName(builtin));
+    } break;
+  }
+}
+
+// push(), pop(), reserve() and shrink() write back to the variable, so the vec has to be one
+static AST_Node *VecArgument(AST_Node *arg, Builtin builtin, bool written) {
+  AST_Node *vec = arg->left;
+  bool is_variable = NodeIs_Identifier(vec) && vec->middle == NULL;
+
+  if (!TypeIs_Vec(vec->data_type) || (written && !is_variable)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, vec->token, "%s() expects a vec%s, got '%s'", BuiltinName(builtin), (written) ? " variable" : "", TypeTranslation(vec->data_type));
+  }
+
+  if (written) NotConstRef(vec);
+
+  SetNodeDataType(arg, vec->data_type);
+  return vec;
+}
+
+// The other half of to_vec(), so it has the same restrictions
+static void ToArray(AST_Node *node, Type vec_type) {
+  AST_Node *size = node->middle->right->left;
+  Type element = VecElementType(vec_type);
+
+  if (TypeIs_String(element)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, node->middle->left->token, "%s() doesn't take a vec of strings", BuiltinName(BUILTIN_TO_ARRAY));
+  }
+
+  if (size->node_type != LITERAL_NODE || size->token.type != INT_LITERAL || TokenToInt64(size->token) > INT32_MAX) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, size->token, "%s() expects the array size as an integer literal", BuiltinName(BUILTIN_TO_ARRAY));
+  }
+
+  Type array_type = element;
+  array_type.category = TC_ARRAY;
+  array_type.array_size = (int)TokenToInt64(size->token);
+
+  SetNodeDataType(node->middle->right, size->data_type);
+  SetNodeDataType(node, array_type);
+}
+
+static void VecBuiltin(AST_Node *node, Builtin builtin) {
+  AST_Node *first = node->middle;
+  AST_Node *second = first->right;
+
+  if (builtin == BUILTIN_TO_VEC) {
+    AST_Node *array = first->left;
+    if (!IsPlainArray(array)) {
+      ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects an array, got '%s'", BuiltinName(builtin), TypeTranslation(array->data_type));
+    }
+
+    SetNodeDataType(first, array->data_type);
+    SetNodeDataType(node, NewVecType(ElementType(array->data_type)));
+    return;
+  }
+
+  bool written = (builtin == BUILTIN_PUSH || builtin == BUILTIN_POP || builtin == BUILTIN_RESERVE || builtin == BUILTIN_SHRINK);
+  Type vec_type = VecArgument(first, builtin, written)->data_type;
+
+  switch (builtin) {
+    case BUILTIN_PUSH: {
+      ContainedOperand(second, VecElementType(vec_type), builtin);
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_POP: {
+      SetNodeDataType(node, VecElementType(vec_type));
+    } break;
+    case BUILTIN_RESERVE: {
+      IntegerArgument(second, builtin);
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_SHRINK: {
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_ELEMENT_COUNT:
+    case BUILTIN_CAPACITY: {
+      SetNodeDataType(node, NewType(I64));
+    } break;
+    case BUILTIN_TO_ARRAY: {
+      ToArray(node, vec_type);
+    } break;
+    default: {
+      COMPILER_ERROR_FMTMSG("VecBuiltin(): '%s' is not a vec builtin", BuiltinName(builtin));
+    } break;
+  }
+}
+
+// C11 leaves a load with release semantics and a store with acquire semantics undefined
+static void MemoryOrderArgument(AST_Node *arg, Builtin builtin) {
+  AST_Node *order = arg->left;
+  if (order->token.type != MEMORY_ORDER_LITERAL) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, order->token, "%s() expects a memory order last: relaxed, acquire, release or seq_cst", BuiltinName(builtin));
+  }
+
+  memory_order o = MemoryOrderOf(order->token);
+  if ((builtin == BUILTIN_LOAD && o == memory_order_release) ||
+      (builtin == BUILTIN_STORE && o == memory_order_acquire)) {
+    ERROR_FMT(ERR_IMPROPER_ACCESS, order->token, "%s() can't be '%.*s'", BuiltinName(builtin), order->token.length, order->token.position_in_source);
+  }
+
+  SetNodeDataType(arg, order->data_type);
+}
+
+// An atomic is only ever read or written through these, see atomic.h
+static void AtomicBuiltin(AST_Node *node, Builtin builtin) {
+  AST_Node *first = node->middle;
+  AST_Node *atomic = first->left;
+  bool is_variable = NodeIs_Identifier(atomic) && atomic->middle == NULL;
+
+  if (!TypeIs_Atomic(atomic->data_type) || !is_variable) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, atomic->token, "%s() expects an atomic variable, got '%s'", BuiltinName(builtin), TypeTranslation(atomic->data_type));
+  }
+
+  if (builtin != BUILTIN_LOAD) NotConstRef(atomic);
+  SetNodeDataType(first, atomic->data_type);
+
+  Type value_type = AtomicValueType(atomic->data_type);
+  if (builtin == BUILTIN_FETCH_ADD && TypeIs_Bool(value_type)) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, atomic->token, "%s() is not defined for atomic<bool>", BuiltinName(builtin));
+  }
+
+  AST_Node *arg = first->right;
+  for (; arg->right != NULL; arg = arg->right) {
+    ContainedOperand(arg, value_type, builtin);
+  }
+
+  MemoryOrderArgument(arg, builtin);
+  SetNodeDataType(node, (builtin == BUILTIN_STORE) ? NewType(VOID) : value_type);
+}
+
+// recv() and try_recv() write the element to a variable of exactly its type
+static void RecvTarget(AST_Node *arg, Type element, Builtin builtin) {
+  AST_Node *target = arg->left;
+  bool is_variable = NodeIs_Identifier(target) && target->middle == NULL;
+
+  if (!is_variable || TypeIs_Array(target->data_type) || target->data_type.specifier != element.specifier) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, target->token, "%s() expects a %s variable, got '%s'", BuiltinName(builtin), TypeTranslation(element), TypeTranslation(target->data_type));
+  }
+
+  NotConstRef(target);
+  SetNodeDataType(arg, target->data_type);
+}
+
+// A chan is only ever used through these, see chan.h
+static void ChanBuiltin(AST_Node *node, Builtin builtin) {
+  AST_Node *first = node->middle;
+  AST_Node *second = first->right;
+  AST_Node *chan = first->left;
+  bool is_variable = NodeIs_Identifier(chan) && chan->middle == NULL;
+
+  if (!TypeIs_Chan(chan->data_type) || !is_variable) {
+    ERROR_FMT(ERR_TYPE_DISAGREEMENT, chan->token, "%s() expects a chan variable, got '%s'", BuiltinName(builtin), TypeTranslation(chan->data_type));
+  }
+
+  SetNodeDataType(first, chan->data_type);
+  Type element = ChanElementType(chan->data_type);
+
+  switch (builtin) {
+    case BUILTIN_SEND:
+    case BUILTIN_TRY_SEND: {
+      ContainedOperand(second, element, builtin);
+      SetNodeDataType(node, NewType((builtin == BUILTIN_SEND) ? VOID : BOOL));
+    } break;
+    case BUILTIN_RECV:
+    case BUILTIN_TRY_RECV: {
+      RecvTarget(second, element, builtin);
+      SetNodeDataType(node, NewType(BOOL));
+    } break;
+    case BUILTIN_CLOSE: {
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_SEND_BATCH: {
+      AST_Node *array = second->left;
+      bool is_whole = IsPlainArray(array) || TypeIs_Slice(array->data_type);
+      if (!is_whole || array->data_type.specifier != element.specifier) {
+        ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects an array or slice of %s, got '%s'", BuiltinName(builtin), TypeTranslation(element), TypeTranslation(array->data_type));
+      }
+
+      SetNodeDataType(second, array->data_type);
+      SetNodeDataType(node, NewType(VOID));
+    } break;
+    case BUILTIN_RECV_BATCH: {
+      AST_Node *array = second->left;
+      if (!NodeIs_Identifier(array) || !IsPlainArray(array) || array->data_type.specifier != element.specifier) {
+        ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects an array variable of %s, got '%s'", BuiltinName(builtin), TypeTranslation(element), TypeTranslation(array->data_type));
+      }
+      NotConstRef(array);
+
+      SetNodeDataType(second, array->data_type);
+      SetNodeDataType(node, NewType(I64));
+    } break;
+    default: {
+      COMPILER_ERROR_FMTMSG("ChanBuiltin(): '%s' is not a chan builtin", BuiltinName(builtin));
+    } break;
+  }
+}
+
+static void BuiltinCall(AST_Node *node) {
+  Builtin builtin = LookupBuiltin(node->token);
+
+  int arg_count = 0;
+  for (AST_Node *arg = node->middle; arg != NULL; arg = arg->right) arg_count++;
+
+  // load() of an atomic takes no offset
+  bool on_atomic = (node->middle != NULL && TypeIs_Atomic(node->middle->left->data_type));
+  int arity = (builtin == BUILTIN_LOAD && on_atomic) ? 2 : BuiltinArity(builtin);
+
+  if (arg_count < arity) {
+    ERROR_FMT(ERR_TOO_FEW, node->token, "%s() expects %d argument(s), got %d", BuiltinName(builtin), arity, arg_count);
+  }
+
+  if (arg_count > arity) {
+    ERROR_FMT(ERR_TOO_MANY, node->token, "%s() expects %d argument(s), got %d", BuiltinName(builtin), arity, arg_count);
+  }
+
+  // What gets kept is the argument after the map or vec, or the array to_vec() takes over
+  if (BuiltinKeepsArguments(builtin)) {
+    AST_Node *kept = (builtin == BUILTIN_TO_VEC) ? node->middle : node->middle->right;
+    for (; kept != NULL; kept = kept->right) NotEscapingRef(kept->left, "stored");
+  }
+
+  switch (builtin) {
+    case BUILTIN_SUM:
+    case BUILTIN_MIN:
+    case BUILTIN_MAX: {
+      AST_Node *array = node->middle->left;
+      bool is_whole = IsWholeArray(array) || TypeIs_Slice(array->data_type);
+      if (!is_whole || !TypeIs_Numeric(array->data_type)) {
+        ERROR_FMT(ERR_TYPE_DISAGREEMENT, array->token, "%s() expects a numeric array, got '%s'", BuiltinName(builtin), TypeTranslation(array->data_type));
+      }
+
+      SetNodeDataType(node->middle, array->data_type);
+      SetNodeDataType(node, ElementType(array->data_type));
+    } break;
+    case BUILTIN_FIND:
+    case BUILTIN_CONTAINS: {
+      if (builtin == BUILTIN_CONTAINS && TypeIs_Map(node->middle->left->data_type)) {
+        MapBuiltin(node, builtin);
+        break;
+      }
+
+      for (AST_Node *arg = node->middle; arg != NULL; arg = arg->right) {
+        if (!TypeIs_String(arg->left->data_type) ||
+            (NodeIs_Identifier(arg->left) && arg->left->middle != NULL)) {
+          ERROR_FMT(ERR_TYPE_DISAGREEMENT, arg->left->token, "%s() expects strings, got '%s'", BuiltinName(builtin), TypeTranslation(arg->left->data_type));
+        }
+
+        SetNodeDataType(arg, arg->left->data_type);
+      }
+
+      SetNodeDataType(node, NewType((builtin == BUILTIN_FIND) ? I64 : BOOL));
+    } break;
+    case BUILTIN_INCLUDE_BYTES: {
+      AST_Node *path = node->middle->left;
+      if (path->token.type != STRING_LITERAL) {
+        ERROR_FMT(ERR_TYPE_DISAGREEMENT, path->token, "%s() expects a string literal, got '%s'", BuiltinName(builtin), TypeTranslation(path->data_type));
+      }
+
+      IncludeBytes(node, path->token);
+    } break;
+    case BUILTIN_POPCOUNT:
+    case BUILTIN_CLZ:
+    case BUILTIN_CTZ:
+    case BUILTIN_BSWAP:
+    case BUILTIN_PARITY:
+    case BUILTIN_ROTL:
+    case BUILTIN_ROTR:
+    case BUILTIN_PEXT:
+    case BUILTIN_PDEP: {
+      BitIntrinsic(node, builtin);
+    } break;
+    case BUILTIN_SHUFFLE: {
+      Shuffle(node);
+    } break;
+    case BUILTIN_LOAD: {
+      if (on_atomic) {
+        AtomicBuiltin(node, builtin);
+      } else {
+        Load(node);
+      }
+    } break;
+    case BUILTIN_STORE: {
+      if (on_atomic) {
+        AtomicBuiltin(node, builtin);
+      } else {
+        Store(node);
+      }
+    } break;
+    case BUILTIN_RESERVE:
+    case BUILTIN_ELEMENT_COUNT: {
+      AST_Node *first = node->middle->left;
+      if (builtin == BUILTIN_ELEMENT_COUNT && TypeIs_Slice(first->data_type)) {
+        SetNodeDataType(node->middle, first->data_type);
+        SetNodeDataType(node, NewType(I64));
+      } else if (TypeIs_Vec(first->data_type)) {
+        VecBuiltin(node, builtin);
+      } else {
+        MapBuiltin(node, builtin);
+      }
+    } break;
+    case BUILTIN_INSERT:
+    case BUILTIN_GET:
+    case BUILTIN_REMOVE:
+    case BUILTIN_KEY_AT:
+    case BUILTIN_VALUE_AT: {
+      MapBuiltin(node, builtin);
+    } break;
+    case BUILTIN_PUSH:
+    case BUILTIN_POP:
+    case BUILTIN_SHRINK:
+    case BUILTIN_CAPACITY:
+    case BUILTIN_TO_VEC:
+    case BUILTIN_TO_ARRAY: {
+      VecBuiltin(node, builtin);
+    } break;
+    case BUILTIN_FETCH_ADD:
+    case BUILTIN_FETCH_OR:
+    case BUILTIN_COMPARE_EXCHANGE: {
+      AtomicBuiltin(node, builtin);
+    } break;
+    case BUILTIN_SEND:
+    case BUILTIN_TRY_SEND:
+    case BUILTIN_RECV:
+    case BUILTIN_TRY_RECV:
+    case BUILTIN_CLOSE:
+    case BUILTIN_SEND_BATCH:
+    case BUILTIN_RECV_BATCH: {
+      ChanBuiltin(node, builtin);
+    } break;
+    default: {
+      COMPILER_ERROR_FMTMSG("BuiltinCall(): Unhandled builtin '%.*s'", node->token.length, node->token.position_in_source);
+    } break;
+  }
+}
+
 static void EnumListRecurse(AST_Node *node) {
   AST_Node *list_entry = (node)->left;
 
@@ -617,6 +1564,7 @@ static void StructMemberAccess(AST_Node *struct_identifier) {
 static void PrefixIncOrDec(AST_Node *node) {
   AST_Node *check_value = node->left;
   if (check_value == NULL) return;
+  NotConstRef(check_value);
   if (!TypeIs_Int(check_value->data_type) &&
       !TypeIs_Uint(check_value->data_type)) {
     ERROR(ERR_TYPE_DISAGREEMENT, check_value->token);
@@ -626,6 +1574,8 @@ static void PrefixIncOrDec(AST_Node *node) {
 }
 
 static void PostfixIncOrDec(AST_Node *node) {
+  NotConstRef(node);
+
   if (!TypeIs_Int(node->data_type) &&
       !TypeIs_Uint(node->data_type)) {
     ERROR(ERR_TYPE_DISAGREEMENT, node->token);
@@ -663,6 +1613,7 @@ static void CheckTypesRecurse(AST_Node *node) {
 
   if (NodeIs_Function(node)) {
     in_function = &node->data_type;
+    TraceBeginToken("type_checker", node->token);
   }
 
   if (node->left   != NULL) CheckTypesRecurse(node->left);
@@ -695,6 +1646,7 @@ static void CheckTypesRecurse(AST_Node *node) {
     } break;
     case FUNCTION_NODE: {
       Function(node);
+      TraceEnd("type_checker");
     } break;
     case FUNCTION_ARGUMENT_NODE:
     case FUNCTION_PARAM_NODE:
@@ -703,6 +1655,10 @@ static void CheckTypesRecurse(AST_Node *node) {
     } break;
     case FUNCTION_CALL_NODE: {
       //FunctionCall(node);
+      RefArguments(node);
+    } break;
+    case BUILTIN_CALL_NODE: {
+      BuiltinCall(node);
     } break;
     case IF_NODE: {
       IfStmt(node);
@@ -1,10 +1,15 @@
 #include <errno.h>
 #include <stdlib.h> // for malloc
-#include <string.h> // for strcmp
+#include <string.h> // for strcmp, memcpy, memset
 
+#include "atomic.h"
+#include "chan.h"
 #include "common.h"
 #include "error.h"
+#include "map.h"
+#include "str.h"
 #include "value.h"
+#include "vec.h"
 
 static char *ExtractString(Token token) {
   char *str = malloc(sizeof(char) * (token.length + ROOM_FOR_NULL_BYTE));
@@ -64,8 +69,7 @@ Value NewValue(Type type, Token token) {
     return c_return;
 
   } else if (TypeIs_String(type)) {
-    char *s = ExtractString(token);
-    return NewStringValue(s);
+    return NewStringValueFrom(token.position_in_source, token.length);
 
   } else {
     COMPILER_ERROR_FMTMSG("NewValue(): '%s' not implemented yet", TypeTranslation(type));
@@ -104,11 +108,96 @@ Value NewCharValue(char c) {
   };
 }
 
-Value NewStringValue(const char *s) {
-  return (Value){
-    .type = NewArrayType(STRING, strlen(s)),
-    .as.string = s,
-  };
+Value NewStringValue(String *s) {
+  Value v = { .type = NewArrayType(STRING, StringLength(s)) };
+  v.as.string = s;
+  v.as.small_string.tag = 0;
+
+  return v;
+}
+
+Value NewStringValueFrom(const char *chars, int64_t length) {
+  if (length > SMALL_STRING_CAPACITY) {
+    return NewStringValue(NewStringFrom(chars, length));
+  }
+
+  Value v = { .type = NewArrayType(STRING, length) };
+  memcpy(v.as.small_string.data, chars, length);
+  v.as.small_string.tag = SMALL_STRING_FLAG | length;
+
+  return v;
+}
+
+/* === Strings === */
+bool StringValueIsSmall(const Value *v) {
+  return (v->as.small_string.tag & SMALL_STRING_FLAG) != 0;
+}
+
+int64_t StringValueLength(const Value *v) {
+  if (StringValueIsSmall(v)) return v->as.small_string.tag & ~SMALL_STRING_FLAG;
+  if (v->as.string == NULL) return 0;
+
+  return StringLength(v->as.string);
+}
+
+const char *StringValueData(const Value *v) {
+  if (StringValueIsSmall(v)) return v->as.small_string.data;
+  if (v->as.string == NULL) return "";
+
+  return StringData(v->as.string);
+}
+
+String *HeapString(Value v) {
+  if (!StringValueIsSmall(&v)) return v.as.string;
+
+  return NewStringFrom(v.as.small_string.data, StringValueLength(&v));
+}
+
+int64_t StringValueFind(const Value *haystack, const Value *needle) {
+  return FindChars(StringValueData(haystack), StringValueLength(haystack),
+                   StringValueData(needle), StringValueLength(needle));
+}
+
+static int CompareStringValues(const Value *a, const Value *b) {
+  int64_t a_length = StringValueLength(a);
+  int64_t b_length = StringValueLength(b);
+  int64_t shorter = (a_length < b_length) ? a_length : b_length;
+
+  int result = memcmp(StringValueData(a), StringValueData(b), shorter);
+  if (result != 0) return result;
+
+  return (a_length > b_length) - (a_length < b_length);
+}
+
+static bool StringValuesEqual(const Value *a, const Value *b) {
+  if (!StringValueIsSmall(a) && !StringValueIsSmall(b)) {
+    return StringsEqual(a->as.string, b->as.string);
+  }
+
+  return StringValueLength(a) == StringValueLength(b) &&
+         CompareStringValues(a, b) == 0;
+}
+
+static Value ConcatStringValues(Value a, Value b) {
+  int64_t a_length = StringValueLength(&a);
+  int64_t b_length = StringValueLength(&b);
+
+  if (a_length == 0) return b;
+  if (b_length == 0) return a;
+
+  if (StringValueIsSmall(&a) && StringValueIsSmall(&b)) {
+    char chars[2 * SMALL_STRING_CAPACITY];
+    memcpy(chars, StringValueData(&a), a_length);
+    memcpy(chars + a_length, StringValueData(&b), b_length);
+
+    return NewStringValueFrom(chars, a_length + b_length);
+  }
+
+  if (StringValueIsSmall(&b)) {
+    return NewStringValue(StringAppend(HeapString(a), StringValueData(&b), b_length));
+  }
+
+  return NewStringValue(StringConcat(HeapString(a), HeapString(b)));
 }
 
 Value NewBoolValue(bool b)  {
@@ -118,7 +207,265 @@ Value NewBoolValue(bool b)  {
   };
 }
 
+/* === Arrays === */
+static int ElementSize(enum TypeSpecifier element_type) {
+  switch (element_type) {
+    case T_I8:  case T_U8:
+    case T_CHAR: case T_BOOL: return 1;
+
+    case T_I16: case T_U16:   return 2;
+
+    case T_I32: case T_U32:
+    case T_F32:               return 4;
+
+    case T_I64: case T_U64:
+    case T_F64: case T_ENUM:  return 8;
+
+    case T_STRING: case T_STRUCT: return sizeof(void*);
+
+    default: {
+      COMPILER_ERROR_FMTMSG("ElementSize(): No array element layout for %s", TypeTranslation((Type){ .specifier = element_type }));
+    }
+  }
+
+  return 0;
+}
+
+size_t ArrayValueSize(enum TypeSpecifier element_type, int64_t count) {
+  return sizeof(ArrayValue) + (size_t)ElementSize(element_type) * count;
+}
+
+ArrayValue *InitArrayValue(void *memory, enum TypeSpecifier element_type, int64_t count) {
+  ArrayValue *a = memory;
+  a->element_type = element_type;
+  a->element_size = ElementSize(element_type);
+  a->count = count;
+  memset(a->elements, 0, (size_t)a->element_size * count);
+
+  return a;
+}
+
+ArrayValue *NewArrayValue(enum TypeSpecifier element_type, int64_t count) {
+  size_t size = ArrayValueSize(element_type, count);
+  return InitArrayValue(NewHeapObject(HEAP_ARRAY, size), element_type, count);
+}
+
+static String *StringElement(ArrayValue *a, int64_t index) {
+  String *element;
+  memcpy(&element, a->elements + index * a->element_size, sizeof(String*));
+
+  return element;
+}
+
+ArrayValue *CopyArrayValue(ArrayValue *source) {
+  ArrayValue *copy = NewArrayValue(source->element_type, source->count);
+  memcpy(copy->elements, source->elements, (size_t)source->element_size * source->count);
+
+  if (source->element_type == T_STRING) {
+    for (int64_t i = 0; i < copy->count; i++) {
+      String *element = StringElement(copy, i);
+      if (element != NULL) Retain(&element->header);
+    }
+  }
+
+  return copy;
+}
+
+// Region arrays are never shared; escape analysis keeps them unique.
+// Constant arrays always are, since every declaration points at them
+bool ArrayIsShared(const ArrayValue *a) {
+  return a->header.refcount > 1 || a->header.refcount == REFCOUNT_CONSTANT;
+}
+
+void DropArrayValue(ArrayValue *a) {
+  if (a->element_type != T_STRING) return;
+
+  for (int64_t i = 0; i < a->count; i++) {
+    String *element = StringElement(a, i);
+    if (element != NULL) Release(&element->header);
+  }
+}
+
+#define LOAD(c_type, field) do {                         \
+    c_type element;                                      \
+    memcpy(&element, at, sizeof(c_type));                \
+    v.as.field = element;                                \
+  } while (0)
+
+#define STORE(c_type, field) do {                        \
+    c_type element = (c_type)v.as.field;                 \
+    memcpy(at, &element, sizeof(c_type));                \
+  } while (0)
+
+Value ArrayGet(ArrayValue *a, int64_t index) {
+  unsigned char *at = a->elements + index * a->element_size;
+  Value v = { .type = { .specifier = a->element_type } };
+
+  switch (a->element_type) {
+    case T_I8:  LOAD(int8_t,  integer); break;
+    case T_I16: LOAD(int16_t, integer); break;
+    case T_I32: LOAD(int32_t, integer); break;
+    case T_I64:
+    case T_ENUM: LOAD(int64_t, integer); break;
+
+    case T_U8:  LOAD(uint8_t,  uinteger); break;
+    case T_U16: LOAD(uint16_t, uinteger); break;
+    case T_U32: LOAD(uint32_t, uinteger); break;
+    case T_U64: LOAD(uint64_t, uinteger); break;
+
+    case T_F32: LOAD(float,  floating); break;
+    case T_F64: LOAD(double, floating); break;
+
+    case T_CHAR: LOAD(char, character); break;
+    case T_BOOL: LOAD(bool, boolean);   break;
+
+    case T_STRING: {
+      LOAD(String*, string);
+      v.as.small_string.tag = 0;
+    } break;
+    case T_STRUCT: LOAD(void*,       structure); break;
+
+    default: break;
+  }
+
+  return v;
+}
+
+void ArraySet(ArrayValue *a, int64_t index, Value v) {
+  unsigned char *at = a->elements + index * a->element_size;
+
+  switch (a->element_type) {
+    case T_I8:  STORE(int8_t,  integer); break;
+    case T_I16: STORE(int16_t, integer); break;
+    case T_I32: STORE(int32_t, integer); break;
+    case T_I64:
+    case T_ENUM: STORE(int64_t, integer); break;
+
+    case T_U8:  STORE(uint8_t,  uinteger); break;
+    case T_U16: STORE(uint16_t, uinteger); break;
+    case T_U32: STORE(uint32_t, uinteger); break;
+    case T_U64: STORE(uint64_t, uinteger); break;
+
+    case T_F32: STORE(float,  floating); break;
+    case T_F64: STORE(double, floating); break;
+
+    case T_CHAR: STORE(char, character); break;
+    case T_BOOL: STORE(bool, boolean);   break;
+
+    case T_STRING: {
+      String *element = HeapString(v);
+      String *previous = StringElement(a, index);
+
+      if (element != NULL) Retain(&element->header);
+      if (previous != NULL) Release(&previous->header);
+      memcpy(at, &element, sizeof(String*));
+    } break;
+    case T_STRUCT: STORE(void*,       structure); break;
+
+    default: break;
+  }
+}
+
+#undef LOAD
+#undef STORE
+
+/* === Slices === */
+int64_t SliceableLength(Value v) {
+  if (TypeIs_String(v.type)) return StringValueLength(&v);
+  if (TypeIs_Slice(v.type)) return v.as.slice.count;
+
+  return v.as.array->count;
+}
+
+static Value NewSliceValue(Type element, ArrayValue *base, int64_t offset, int64_t count) {
+  if (offset + count > UINT32_MAX) INTERPRETER_ERROR("Slices can only reach the first 2^32 elements of an array");
+
+  Value v = { .type = NewSliceType(element) };
+  v.as.slice.base = base;
+  v.as.slice.offset = (uint32_t)offset;
+  v.as.slice.count = (uint32_t)count;
+
+  return v;
+}
+
+Value SliceOf(Value v, int64_t lo, int64_t hi) {
+  if (lo < 0 || lo > hi || hi > SliceableLength(v)) {
+    INTERPRETER_ERROR("Slice bounds out of range");
+  }
+
+  if (TypeIs_String(v.type)) {
+    if (hi - lo <= SMALL_STRING_CAPACITY || StringValueIsSmall(&v)) {
+      return NewStringValueFrom(StringValueData(&v) + lo, hi - lo);
+    }
+
+    return NewStringValue(StringSlice(v.as.string, lo, hi - lo));
+  }
+
+  if (TypeIs_Slice(v.type)) {
+    return NewSliceValue(v.type, v.as.slice.base, v.as.slice.offset + lo, hi - lo);
+  }
+
+  return NewSliceValue(v.type, v.as.array, lo, hi - lo);
+}
+
+Value WholeSlice(Value array) {
+  return NewSliceValue(array.type, array.as.array, 0, array.as.array->count);
+}
+
+Value SliceGet(Value slice, int64_t index) {
+  return ArrayGet(slice.as.slice.base, slice.as.slice.offset + index);
+}
+
+/* === Reference Counting ===
+ *
+ * Only values stored somewhere (a variable, an array slot) hold a
+ * reference; see heap.h */
+static HeapObject *HeapObjectOf(Value v) {
+  if (TypeIs_String(v.type)) {
+    return (StringValueIsSmall(&v) || v.as.string == NULL) ? NULL : &v.as.string->header;
+  }
+
+  if (TypeIs_Array(v.type)) {
+    return (v.as.array == NULL) ? NULL : &v.as.array->header;
+  }
+
+  if (TypeIs_Map(v.type)) {
+    return (v.as.map == NULL) ? NULL : &v.as.map->header;
+  }
+
+  if (TypeIs_Vec(v.type)) {
+    return (v.as.vec == NULL) ? NULL : &v.as.vec->header;
+  }
+
+  if (TypeIs_Atomic(v.type)) {
+    return (v.as.atomic == NULL) ? NULL : &v.as.atomic->header;
+  }
+
+  if (TypeIs_Chan(v.type)) {
+    return (v.as.chan == NULL) ? NULL : &v.as.chan->header;
+  }
+
+  if (TypeIs_Slice(v.type)) {
+    return (v.as.slice.base == NULL) ? NULL : &v.as.slice.base->header;
+  }
+
+  return NULL;
+}
+
+void RetainValue(Value v) {
+  Retain(HeapObjectOf(v));
+}
+
+void ReleaseValue(Value v) {
+  Release(HeapObjectOf(v));
+}
+
+void ReleaseValueToTemporaries(Value v) {
+  ReleaseToTemporaries(HeapObjectOf(v));
+}
+
 Value AddValues(Value v1, Value v2) {
+  if (TypeIs_String(v1.type)) return ConcatStringValues(v1, v2);
   if (TypeIs_Int(v1.type)) return NewIntValue(v1.as.integer + v2.as.integer);
   if (TypeIs_Uint(v1.type)) return NewUintValue(v1.as.uinteger + v2.as.uinteger);
   if (TypeIs_Float(v1.type)) return NewFloatValue(v1.as.floating + v2.as.floating);
@@ -167,6 +514,7 @@ Value Equality(Value v1, Value v2) {
   if (TypeIs_Float(v1.type)) return NewBoolValue(v1.as.floating == v2.as.floating);
   if (TypeIs_Char(v1.type)) return NewBoolValue(v1.as.character == v2.as.character);
   if (TypeIs_Bool(v1.type)) return NewBoolValue(v1.as.boolean == v2.as.boolean);
+  if (TypeIs_String(v1.type)) return NewBoolValue(StringValuesEqual(&v1, &v2));
 
   return (Value){0};
 }
@@ -175,6 +523,7 @@ Value GreaterThan(Value v1, Value v2) {
   if (TypeIs_Int(v1.type)) return NewBoolValue(v1.as.integer > v2.as.integer);
   if (TypeIs_Uint(v1.type)) return NewBoolValue(v1.as.uinteger > v2.as.uinteger);
   if (TypeIs_Float(v1.type)) return NewBoolValue(v1.as.floating > v2.as.floating);
+  if (TypeIs_String(v1.type)) return NewBoolValue(CompareStringValues(&v1, &v2) > 0);
 
   return (Value){0};
 }
@@ -183,6 +532,7 @@ Value LessThan(Value v1, Value v2) {
   if (TypeIs_Int(v1.type)) return NewBoolValue(v1.as.integer < v2.as.integer);
   if (TypeIs_Uint(v1.type)) return NewBoolValue(v1.as.uinteger < v2.as.uinteger);
   if (TypeIs_Float(v1.type)) return NewBoolValue(v1.as.floating < v2.as.floating);
+  if (TypeIs_String(v1.type)) return NewBoolValue(CompareStringValues(&v1, &v2) < 0);
 
   return (Value){0};
 }
@@ -201,12 +551,79 @@ Value LogicalOR(Value v1, Value v2) {
   return NewBoolValue(v1.as.boolean || v2.as.boolean);
 }
 
+// Embedded files and dense tables can hold millions of elements
+#define PRINTED_ELEMENTS_LIMIT 32
+
+static void InlinePrintElements(ArrayValue *a) {
+  int64_t printed = (a->count > PRINTED_ELEMENTS_LIMIT) ? PRINTED_ELEMENTS_LIMIT : a->count;
+
+  Print("{");
+  for (int64_t i = 0; i < printed; i++) {
+    Value element = ArrayGet(a, i);
+
+    if (i > 0) Print(", ");
+    if (TypeIs_Int(element.type))   Print("%ld", element.as.integer);
+    if (TypeIs_Uint(element.type))  Print("%lu", element.as.uinteger);
+    if (TypeIs_Float(element.type)) Print("%g", element.as.floating);
+    if (TypeIs_Char(element.type))  Print("'%c'", element.as.character);
+    if (TypeIs_Bool(element.type))  Print("%s", (element.as.boolean) ? "true" : "false");
+    if (TypeIs_String(element.type)) {
+      Print("\"%.*s\"", (int)StringValueLength(&element), StringValueData(&element));
+    }
+  }
+  if (printed < a->count) Print(", ... %lld more", (long long)(a->count - printed));
+  Print("}");
+}
+
 void InlinePrintValue(Value v) {
   if (TypeIs_None(v.type)) {
     Print("NONE");
     return;
   }
 
+  if (TypeIs_Array(v.type) && !TypeIs_String(v.type)) {
+    InlinePrintType(v.type);
+    if (v.as.array == NULL) {
+      Print(": (null)");
+    } else {
+      Print(": ");
+      InlinePrintElements(v.as.array);
+    }
+    return;
+  }
+
+  if (TypeIs_Map(v.type)) {
+    InlinePrintType(v.type);
+    Print(": %lld entries", (long long)MapCount(v.as.map));
+    return;
+  }
+
+  if (TypeIs_Vec(v.type)) {
+    InlinePrintType(v.type);
+    Print(": %lld elements", (long long)VecCount(v.as.vec));
+    return;
+  }
+
+  if (TypeIs_Atomic(v.type)) {
+    InlinePrintType(v.type);
+    if (v.as.atomic != NULL) {
+      Print(": ");
+      InlinePrintValue(AtomicLoad(v.as.atomic, memory_order_seq_cst));
+    }
+    return;
+  }
+
+  if (TypeIs_Chan(v.type)) {
+    InlinePrintType(v.type);
+    return;
+  }
+
+  if (TypeIs_Slice(v.type)) {
+    InlinePrintType(v.type);
+    Print(": %lld elements", (long long)SliceableLength(v));
+    return;
+  }
+
   if (TypeIs_Int(v.type)) {
     InlinePrintType(v.type);
     Print(": %ld", v.as.integer);
@@ -233,7 +650,11 @@ void InlinePrintValue(Value v) {
 
   if (TypeIs_String(v.type)) {
     InlinePrintType(v.type);
-    Print(": %s", v.as.string);
+    if (!StringValueIsSmall(&v) && v.as.string == NULL) {
+      Print(": (null)");
+    } else {
+      Print(": %.*s", (int)StringValueLength(&v), StringValueData(&v));
+    }
     return;
   }
 
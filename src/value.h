@@ -1,11 +1,29 @@
 #ifndef VALUE_H
 #define VALUE_H
 
+#include <stdbool.h>
+#include <stddef.h> // for size_t
 #include <stdint.h>
 
+#include "heap.h"
 #include "token.h"
 #include "type.h"
 
+struct ArrayValue;
+struct MapValue;
+struct VecValue;
+struct AtomicValue;
+struct ChanValue;
+struct String;
+
+/* Strings of up to SMALL_STRING_CAPACITY bytes are stored inline in
+ * the value itself, with the length and SMALL_STRING_FLAG in the last
+ * byte. Longer strings live on the heap and are reached through
+ * 'string', which leaves that byte at 0. Inline strings are not
+ * NUL-terminated; go through StringValueData()/StringValueLength(). */
+#define SMALL_STRING_CAPACITY 15
+#define SMALL_STRING_FLAG     0x80
+
 typedef struct Value {
   Type type;
   union {
@@ -13,21 +31,87 @@ typedef struct Value {
     int64_t     integer;
     double     floating;
     char      character;
-    const char*  string;
+    struct String* string;
     bool        boolean;
     void*     structure;
-    struct Value* array;
+    struct ArrayValue* array;
+    struct MapValue*     map;
+    struct VecValue*     vec;
+    struct AtomicValue*  atomic;
+    struct ChanValue*    chan;
+    struct {
+      struct ArrayValue *base;
+      uint32_t offset;
+      uint32_t count;
+    } slice;
+    struct {
+      char data[SMALL_STRING_CAPACITY];
+      uint8_t tag;
+    } small_string;
   } as;
 } Value;
 
+/* Arrays keep their elements packed at native width (1 byte per u8,
+ * 8 per f64, ...), with the element type stored once in the header.
+ * Strings and structs are stored as pointers. Arrays are reference
+ * counted like strings (see heap.h), and hold a reference to each of
+ * their string elements.
+ *
+ * Arrays have value semantics but are copied lazily: assignment and
+ * argument passing share one ArrayValue, and the first write through
+ * a shared one copies it (ArrayIsShared(), CopyArrayValue()). Strings
+ * can't be written to, so sharing them is always safe. */
+typedef struct ArrayValue {
+  HeapObject header;
+  enum TypeSpecifier element_type;
+  int element_size;
+  int64_t count;
+  _Alignas(8) unsigned char elements[];
+} ArrayValue;
+
 Value NewValue(Type type, Token token);
 Value NewIntValue(int64_t i);
 Value NewUintValue(uint64_t u);
 Value NewFloatValue(double d);
 Value NewCharValue(char c);
-Value NewStringValue(const char *s);
+Value NewStringValue(struct String *s);
+Value NewStringValueFrom(const char *chars, int64_t length);
 Value NewBoolValue(bool b);
 
+bool StringValueIsSmall(const Value *v);
+int64_t StringValueLength(const Value *v);
+const char *StringValueData(const Value *v);
+struct String *HeapString(Value v); // copies an inline string out to the heap
+int64_t StringValueFind(const Value *haystack, const Value *needle); // -1 if not found
+
+size_t ArrayValueSize(enum TypeSpecifier element_type, int64_t count);
+ArrayValue *InitArrayValue(void *memory, enum TypeSpecifier element_type, int64_t count);
+ArrayValue *NewArrayValue(enum TypeSpecifier element_type, int64_t count);
+ArrayValue *CopyArrayValue(ArrayValue *source);
+bool ArrayIsShared(const ArrayValue *a);
+void DropArrayValue(ArrayValue *a);
+Value ArrayGet(ArrayValue *a, int64_t index);
+void ArraySet(ArrayValue *a, int64_t index, Value v);
+
+/* A slice 'a[lo..hi]' is the array it views plus an offset and a
+ * count, held in the value itself, so making one never allocates.
+ * Stored slices hold a reference to the whole array, which keeps it
+ * alive; writing to the array through another variable copies it
+ * first, so a slice never sees its elements change. Slices are
+ * read-only.
+ *
+ * Slicing a string gives a string. One that fits inline is copied,
+ * a longer one shares the original's bytes (see StringSlice()).
+ * Bounds are checked when the slice is made. */
+int64_t SliceableLength(Value v);          // of an array, vector, slice or string
+Value SliceOf(Value v, int64_t lo, int64_t hi);
+Value WholeSlice(Value array);             // an array or vector as a slice
+Value SliceGet(Value slice, int64_t index); // 'index' must be below the count
+
+void RetainValue(Value v);
+void ReleaseValue(Value v);
+void ReleaseValueToTemporaries(Value v);
+
 Value AddValues(Value v1, Value v2);
 Value SubValues(Value v1, Value v2);
 Value MulValues(Value v1, Value v2);
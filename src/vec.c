@@ -0,0 +1,187 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h> // for memcpy, memset
+
+#include "error.h"
+#include "str.h"
+#include "vec.h"
+
+#define VEC_MIN_CAPACITY 8
+
+/* === Storage === */
+static unsigned char *Slot(ArrayValue *a, int64_t index) {
+  return a->elements + index * a->element_size;
+}
+
+static String *StringSlot(ArrayValue *a, int64_t index) {
+  String *s;
+  memcpy(&s, Slot(a, index), sizeof(String*));
+
+  return s;
+}
+
+/* Gives the vec storage for 'capacity' elements that only it holds.
+ * Storage nothing else refers to is resized in place; anything else
+ * is copied, and the vec's reference to the old storage released */
+static void Reallocate(VecValue *v, int64_t capacity) {
+  ArrayValue *old = v->storage;
+
+  if (old != NULL && !ArrayIsShared(old)) {
+    ArrayValue *resized = ResizeHeapObject(&old->header, ArrayValueSize(v->element_type, capacity));
+    if (resized != NULL) {
+      if (capacity > resized->count) {
+        memset(Slot(resized, resized->count), 0, (size_t)resized->element_size * (capacity - resized->count));
+      }
+
+      resized->count = capacity;
+      v->storage = resized;
+      return;
+    }
+  }
+
+  ArrayValue *fresh = NewArrayValue(v->element_type, capacity);
+  if (old != NULL && v->count > 0) {
+    memcpy(fresh->elements, old->elements, (size_t)old->element_size * v->count);
+
+    if (v->element_type == T_STRING) {
+      for (int64_t i = 0; i < v->count; i++) {
+        String *element = StringSlot(fresh, i);
+        if (element != NULL) Retain(&element->header);
+      }
+    }
+  }
+
+  Retain(&fresh->header);
+  if (old != NULL) Release(&old->header);
+  v->storage = fresh;
+}
+
+static void MakeWritable(VecValue *v) {
+  if (v->storage != NULL && ArrayIsShared(v->storage)) {
+    Reallocate(v, v->storage->count);
+  }
+}
+
+static void CheckIndex(const VecValue *v, int64_t index) {
+  if (index < 0 || index >= VecCount(v)) {
+    INTERPRETER_ERROR("Vec index out of bounds");
+  }
+}
+
+/* === Vecs === */
+VecValue *NewVecValue(Type vec_type) {
+  VecValue *v = NewHeapObject(HEAP_VEC, sizeof(VecValue));
+  v->element_type = vec_type.value_specifier;
+  v->count = 0;
+  v->storage = NULL;
+
+  return v;
+}
+
+VecValue *CopyVecValue(VecValue *source) {
+  VecValue *copy = NewVecValue((Type){ .value_specifier = source->element_type });
+  copy->count = source->count;
+  copy->storage = source->storage;
+  if (copy->storage != NULL) Retain(&copy->storage->header);
+
+  return copy;
+}
+
+bool VecIsShared(const VecValue *v) {
+  return v->header.refcount > 1;
+}
+
+void DropVecValue(VecValue *v) {
+  if (v->storage != NULL) Release(&v->storage->header);
+}
+
+int64_t VecCount(const VecValue *v) {
+  return (v == NULL) ? 0 : v->count;
+}
+
+int64_t VecCapacity(const VecValue *v) {
+  return (v == NULL || v->storage == NULL) ? 0 : v->storage->count;
+}
+
+Value VecGet(VecValue *v, int64_t index) {
+  CheckIndex(v, index);
+
+  return ArrayGet(v->storage, index);
+}
+
+void VecSet(VecValue *v, int64_t index, Value element) {
+  CheckIndex(v, index);
+  MakeWritable(v);
+
+  ArraySet(v->storage, index, element);
+}
+
+void VecPush(VecValue *v, Value element) {
+  int64_t capacity = VecCapacity(v);
+
+  if (v->count == capacity) {
+    Reallocate(v, (capacity < VEC_MIN_CAPACITY / 2) ? VEC_MIN_CAPACITY : capacity * 2);
+  } else {
+    MakeWritable(v);
+  }
+
+  ArraySet(v->storage, v->count++, element);
+}
+
+// The popped slot is cleared so spare capacity stays zeroed
+Value VecPop(VecValue *v) {
+  if (VecCount(v) == 0) INTERPRETER_ERROR("pop() from an empty vec");
+  MakeWritable(v);
+
+  int64_t last = --v->count;
+  Value element = ArrayGet(v->storage, last);
+
+  if (v->element_type == T_STRING) {
+    // The vec's reference is the only thing keeping it alive
+    element = NewStringValueFrom(StringValueData(&element), StringValueLength(&element));
+
+    String *previous = StringSlot(v->storage, last);
+    if (previous != NULL) Release(&previous->header);
+  }
+
+  memset(Slot(v->storage, last), 0, v->storage->element_size);
+  return element;
+}
+
+void VecReserve(VecValue *v, int64_t capacity) {
+  if (capacity > VecCapacity(v)) Reallocate(v, capacity);
+}
+
+void VecShrink(VecValue *v) {
+  if (VecCapacity(v) == v->count) return;
+
+  if (v->count == 0) {
+    Release(&v->storage->header);
+    v->storage = NULL;
+    return;
+  }
+
+  Reallocate(v, v->count);
+}
+
+/* === Conversions === */
+VecValue *ArrayToVec(ArrayValue *array) {
+  VecValue *v = NewVecValue((Type){ .value_specifier = array->element_type });
+  v->count = array->count;
+  v->storage = array;
+  Retain(&array->header);
+
+  return v;
+}
+
+// Shares the storage when it's exactly full, otherwise copies the used part
+ArrayValue *VecToArray(VecValue *v, Type vec_type) {
+  if (VecCount(v) > 0 && VecCapacity(v) == v->count) return v->storage;
+
+  ArrayValue *array = NewArrayValue(vec_type.value_specifier, VecCount(v));
+  for (int64_t i = 0; i < VecCount(v); i++) {
+    ArraySet(array, i, ArrayGet(v->storage, i));
+  }
+
+  return array;
+}
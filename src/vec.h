@@ -0,0 +1,56 @@
+/* Runtime values of 'vec<T>', a growable array.
+ *
+ * The elements live in an ordinary ArrayValue (see value.h) whose
+ * count is the vec's capacity; only [0, count) is in use and the rest
+ * is kept zeroed. Elements are packed at native width like any array.
+ * push() doubles the capacity when it runs out, so appending is
+ * amortized O(1). When the vec is the only holder of its storage the
+ * storage is grown with realloc(), which usually extends the block in
+ * place instead of copying (ResizeHeapObject() in heap.h).
+ *
+ * to_vec() and to_array() hand the same storage back and forth
+ * without copying. Whichever side writes first while it is shared
+ * copies it, the same as assigning one array variable to another.
+ *
+ * Vecs are reference counted and copied on write like maps. A vec
+ * variable that was declared but never written to holds NULL, which
+ * every read treats as an empty vec.
+ */
+
+#ifndef VEC_H
+#define VEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "heap.h"
+#include "value.h"
+
+typedef struct VecValue {
+  HeapObject header;
+  enum TypeSpecifier element_type;
+  int64_t count;
+  ArrayValue *storage; // NULL until the first element, holds a reference
+} VecValue;
+
+VecValue *NewVecValue(Type vec_type);
+VecValue *CopyVecValue(VecValue *source); // shares the storage
+bool VecIsShared(const VecValue *v);
+void DropVecValue(VecValue *v);
+
+int64_t VecCount(const VecValue *v);
+int64_t VecCapacity(const VecValue *v);
+
+// 'index' is checked against VecCount()
+Value VecGet(VecValue *v, int64_t index);
+void VecSet(VecValue *v, int64_t index, Value element);
+
+void VecPush(VecValue *v, Value element);
+Value VecPop(VecValue *v);
+void VecReserve(VecValue *v, int64_t capacity);
+void VecShrink(VecValue *v);
+
+VecValue *ArrayToVec(ArrayValue *array);
+ArrayValue *VecToArray(VecValue *v, Type vec_type);
+
+#endif
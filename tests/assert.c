@@ -54,6 +54,19 @@ void Assert(int expected_code, int actual_code, char *file_name, char *group_nam
   LogResults(predicate, group_name);
 }
 
+void AssertTrue(bool predicate, const char *description, const char *file_name, int line, char *group_name) {
+  if (ht == NULL) ht = NewHashTable();
+
+  if (!predicate) {
+    LogError(MSG_SPACER "[%s:%d]\n" MSG_SPACER "    Expected '%s'",
+             file_name,
+             line,
+             description);
+  }
+
+  LogResults(predicate, group_name);
+}
+
 void PrintAssertionResults(char *group_name) {
   if (ht == NULL) return;
 
@@ -1,12 +1,18 @@
 #ifndef ASSERT_H
 #define ASSERT_H
 
+#include <stdbool.h>
+
+// For the unit tests, see unit_tests.h
+#define ASSERT(predicate, group_name) AssertTrue((predicate), #predicate, __FILE__, __LINE__, group_name)
+
 typedef struct {
   int succeeded;
   int failed;
 } TestResults;
 
 void Assert(int expected_code, int actual_code, char *file_name, char *group_name);
+void AssertTrue(bool predicate, const char *description, const char *file_name, int line, char *group_name);
 void PrintAssertionResults(char *group_name);
 void PrintResults(TestResults t, const char *test_group_name);
 
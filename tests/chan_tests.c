@@ -0,0 +1,159 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../src/chan.h"
+#include "../src/heap.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "chan.c"
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define PER_PRODUCER 20000
+#define BATCH 3
+
+static ChanValue *NewI64Chan(int capacity) {
+  ChanValue *c = NewChanValue(NewChanType(NewType(I64), capacity));
+  Retain(&c->header);
+
+  return c;
+}
+
+static void SingleThreaded() {
+  ChanValue *c = NewI64Chan(4);
+  ASSERT(ChanCapacity(c) == 4, GROUP);
+
+  Value v = {0};
+  ASSERT(ChanTryRecv(c, &v) == CHAN_EMPTY, GROUP);
+
+  for (int i = 0; i < 4; i++) ASSERT(ChanTrySend(c, NewIntValue(i)) == CHAN_OK, GROUP);
+  ASSERT(ChanTrySend(c, NewIntValue(4)) == CHAN_FULL, GROUP);
+
+  // Many times around the ring, one element behind the sends
+  bool in_order = true;
+  for (int64_t i = 4; i < 1000; i++) {
+    in_order &= ChanTryRecv(c, &v) == CHAN_OK && v.as.integer == i - 4;
+    in_order &= ChanTrySend(c, NewIntValue(i)) == CHAN_OK;
+  }
+  ASSERT(in_order, GROUP);
+
+  // Closed: no more sends, but what was sent can still be received
+  ChanClose(c);
+  ASSERT(ChanTrySend(c, NewIntValue(0)) == CHAN_CLOSED, GROUP);
+
+  ArrayValue *into = NewArrayValue(T_I64, 8);
+  ASSERT(ChanRecvBatch(c, into, 8) == 4, GROUP);
+  ASSERT(ArrayGet(into, 0).as.integer == 996 && ArrayGet(into, 3).as.integer == 999, GROUP);
+  ASSERT(ChanRecvBatch(c, into, 8) == 0, GROUP);
+  ASSERT(!ChanRecv(c, &v), GROUP);
+
+  Release(&c->header);
+}
+
+typedef struct {
+  ChanValue *chan;
+  int id;
+  ArrayValue *batch; // allocated up front, the heap isn't shared between threads
+  _Atomic uint8_t *seen;
+  bool in_order;
+} Worker;
+
+// Every other group of elements goes out as one batch
+static void *Produce(void *arg) {
+  Worker *w = arg;
+  int64_t base = (int64_t)w->id * PER_PRODUCER;
+
+  for (int64_t i = 0; i < PER_PRODUCER;) {
+    if ((i / BATCH) % 2 == 0 && i + BATCH <= PER_PRODUCER) {
+      for (int64_t j = 0; j < BATCH; j++) ArraySet(w->batch, j, NewIntValue(base + i + j));
+      ChanSendBatch(w->chan, w->batch, 0, BATCH);
+      i += BATCH;
+    } else {
+      ChanSend(w->chan, NewIntValue(base + i));
+      i++;
+    }
+  }
+
+  return NULL;
+}
+
+// Elements from one producer arrive in the order it sent them
+static void Receive(Worker *w, int64_t *last, int64_t element) {
+  atomic_fetch_add(&w->seen[element], 1);
+
+  int64_t producer = element / PER_PRODUCER;
+  if (element <= last[producer]) w->in_order = false;
+  last[producer] = element;
+}
+
+static void *Consume(void *arg) {
+  Worker *w = arg;
+
+  int64_t last[PRODUCERS];
+  for (int i = 0; i < PRODUCERS; i++) last[i] = -1;
+
+  if (w->id % 2 == 0) {
+    Value v;
+    while (ChanRecv(w->chan, &v)) Receive(w, last, v.as.integer);
+  } else {
+    int64_t received;
+    while ((received = ChanRecvBatch(w->chan, w->batch, w->batch->count)) > 0) {
+      for (int64_t i = 0; i < received; i++) Receive(w, last, ArrayGet(w->batch, i).as.integer);
+    }
+  }
+
+  return NULL;
+}
+
+static void ManyProducersAndConsumers() {
+  // Small, so every thread wraps around the ring thousands of times
+  ChanValue *c = NewI64Chan(4);
+
+  static _Atomic uint8_t seen[PRODUCERS * PER_PRODUCER];
+  for (int i = 0; i < PRODUCERS * PER_PRODUCER; i++) atomic_init(&seen[i], 0);
+
+  Worker producers[PRODUCERS];
+  Worker consumers[CONSUMERS];
+  pthread_t producer_threads[PRODUCERS];
+  pthread_t consumer_threads[CONSUMERS];
+
+  for (int i = 0; i < CONSUMERS; i++) {
+    consumers[i] = (Worker){ .chan = c, .id = i, .batch = NewArrayValue(T_I64, 5), .seen = seen, .in_order = true };
+    pthread_create(&consumer_threads[i], NULL, Consume, &consumers[i]);
+  }
+  for (int i = 0; i < PRODUCERS; i++) {
+    producers[i] = (Worker){ .chan = c, .id = i, .batch = NewArrayValue(T_I64, BATCH), .seen = seen, .in_order = true };
+    pthread_create(&producer_threads[i], NULL, Produce, &producers[i]);
+  }
+
+  for (int i = 0; i < PRODUCERS; i++) pthread_join(producer_threads[i], NULL);
+  ChanClose(c);
+  for (int i = 0; i < CONSUMERS; i++) pthread_join(consumer_threads[i], NULL);
+
+  bool once_each = true;
+  for (int i = 0; i < PRODUCERS * PER_PRODUCER; i++) once_each &= atomic_load(&seen[i]) == 1;
+  ASSERT(once_each, GROUP);
+
+  bool in_order = true;
+  for (int i = 0; i < CONSUMERS; i++) in_order &= consumers[i].in_order;
+  ASSERT(in_order, GROUP);
+
+  Release(&c->header);
+}
+
+void ChanTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  SingleThreaded();
+  ManyProducersAndConsumers();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
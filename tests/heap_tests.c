@@ -0,0 +1,186 @@
+#include <pthread.h>
+#include <string.h> // for memset
+
+#include "../src/heap.h"
+#include "../src/str.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "heap.c"
+
+// Holds nothing, so it can stand in for any object that doesn't refer to others
+static HeapObject *NewObject() {
+  return NewHeapObject(HEAP_ATOMIC, sizeof(HeapObject) + sizeof(int64_t));
+}
+
+static void Temporaries() {
+  HeapObject *kept = NewObject();
+  Retain(kept);
+
+  int mark = TemporariesMark();
+  HeapObject *held = NewObject();
+  NewObject();
+  NewObject();
+  Retain(held);
+
+  int64_t frees = GetHeapStats().frees;
+  ReleaseTemporaries(mark);
+
+  // The two nothing refers to are freed; the table entry from before the mark stays
+  ASSERT(GetHeapStats().frees == frees + 2, GROUP);
+  ASSERT(TemporariesMark() == mark, GROUP);
+  ASSERT(kept->in_zero_count_table && !held->in_zero_count_table, GROUP);
+
+  // Out of the table, the last release frees right away
+  Release(held);
+  ASSERT(GetHeapStats().frees == frees + 3, GROUP);
+
+  // In it, freeing waits for the statement's end
+  Release(kept);
+  ASSERT(GetHeapStats().frees == frees + 3, GROUP);
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().frees == frees + 4, GROUP);
+}
+
+static void ReleasingToTemporaries() {
+  HeapObject *result = NewObject();
+  Retain(result);
+  ReleaseTemporaries(0);
+
+  ReleaseToTemporaries(result);
+  ASSERT(result->refcount == 0 && result->in_zero_count_table, GROUP);
+
+  // A caller can still take it over before the statement ends
+  Retain(result);
+  ReleaseTemporaries(0);
+  ASSERT(result->refcount == 1 && !result->in_zero_count_table, GROUP);
+
+  Release(result);
+}
+
+static void Resizing() {
+  HeapObject *object = NewObject();
+  Retain(object);
+
+  // The table still points at it
+  ASSERT(ResizeHeapObject(object, 4096) == NULL, GROUP);
+  ReleaseTemporaries(0);
+
+  Retain(object);
+  ASSERT(ResizeHeapObject(object, 4096) == NULL, GROUP);
+  Release(object);
+
+  int64_t live = GetHeapStats().live_bytes;
+  object = ResizeHeapObject(object, 4096);
+  ASSERT(object != NULL && object->size == 4096, GROUP);
+  ASSERT(GetHeapStats().live_bytes == live + 4096 - (int64_t)(sizeof(HeapObject) + sizeof(int64_t)), GROUP);
+
+  Release(object);
+}
+
+static void Uncounted() {
+  Arena region = {0};
+  HeapObject *object = NewRegionObject(&region, HEAP_ATOMIC, sizeof(HeapObject));
+
+  Retain(object);
+  Release(object);
+  Release(object);
+  ASSERT(object->refcount == REFCOUNT_UNCOUNTED, GROUP);
+  ASSERT(!object->in_zero_count_table, GROUP);
+
+  FreeArena(&region);
+}
+
+// Releasing the root of a rope this deep would overflow the stack if freeing recursed
+static void LongChains() {
+  char piece[64];
+  memset(piece, 'x', sizeof(piece));
+
+  String *s = NewStringFrom(piece, sizeof(piece));
+  Retain(&s->header);
+
+  for (int i = 0; i < 200000; i++) {
+    String *longer = StringAppend(s, piece, sizeof(piece));
+    Retain(&longer->header);
+    Release(&s->header);
+    s = longer;
+
+    ReleaseTemporaries(0);
+  }
+
+  ASSERT(StringLength(s) == 200001 * (int64_t)sizeof(piece), GROUP);
+
+  Release(&s->header);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+}
+
+static void States() {
+  HeapState *other = NewHeapState();
+  HeapState *previous = UseHeapState(other);
+
+  HeapObject *object = NewObject();
+  ASSERT(GetHeapStats().allocations == 1, GROUP);
+
+  UseHeapState(previous);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  // Deleting a state frees what's left in its table
+  ASSERT(object->in_zero_count_table, GROUP);
+  DeleteHeapState(other);
+}
+
+typedef struct {
+  HeapStats after_allocating;
+  HeapStats after_releasing;
+} ThreadResult;
+
+// Runs in the thread's own default state, without an isolate
+static void *AllocateInDefault(void *arg) {
+  ThreadResult *result = arg;
+
+  for (int i = 0; i < 1000; i++) NewObject();
+  result->after_allocating = GetHeapStats();
+
+  ReleaseTemporaries(0);
+  result->after_releasing = GetHeapStats();
+
+  return NULL;
+}
+
+static void ThreadDefaults() {
+  enum { THREADS = 4 };
+  ThreadResult results[THREADS] = {0};
+  pthread_t threads[THREADS];
+
+  for (int i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, AllocateInDefault, &results[i]);
+  for (int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+
+  // No thread sees another's allocations
+  for (int i = 0; i < THREADS; i++) {
+    ASSERT(results[i].after_allocating.allocations == 1000, GROUP);
+    ASSERT(results[i].after_releasing.frees == 1000, GROUP);
+    ASSERT(results[i].after_releasing.live_bytes == 0, GROUP);
+  }
+}
+
+void HeapTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  Temporaries();
+  ReleasingToTemporaries();
+  Resizing();
+  Uncounted();
+  LongChains();
+  States();
+  ThreadDefaults();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+  ASSERT(GetHeapStats().allocations == GetHeapStats().frees, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>  // for snprintf
+#include <string.h> // for strlen
+
+#include "../src/compiler.h"
+#include "../src/intern.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "intern.c"
+
+static void Pool() {
+  const char *chars = "interned once, however often it appears";
+  int64_t length = strlen(chars);
+
+  String *s = InternString(chars, length);
+  ASSERT(InternString(chars, length) == s, GROUP);
+  ASSERT(InternString(chars, length - 1) != s, GROUP);
+
+  ASSERT(StringIsInterned(s), GROUP);
+  ASSERT(s->hash == HashChars(chars, length), GROUP);
+
+  // Never counted, so never freed
+  Retain(&s->header);
+  Release(&s->header);
+  Release(&s->header);
+  ASSERT(s->header.refcount == REFCOUNT_INTERNED, GROUP);
+}
+
+static void Growth() {
+  String *first[1000];
+  char chars[32];
+
+  for (int i = 0; i < 1000; i++) {
+    int length = snprintf(chars, sizeof(chars), "literal number %d", i);
+    first[i] = InternString(chars, length);
+  }
+
+  bool same = true;
+  for (int i = 0; i < 1000; i++) {
+    int length = snprintf(chars, sizeof(chars), "literal number %d", i);
+    same &= InternString(chars, length) == first[i];
+  }
+  ASSERT(same, GROUP);
+}
+
+static void FindLiterals(AST_Node *n, Value *found, int *count) {
+  if (n == NULL) return;
+
+  if (n->token.type == STRING_LITERAL && n->node_type == LITERAL_NODE) found[(*count)++] = n->value;
+
+  FindLiterals(n->left, found, count);
+  FindLiterals(n->middle, found, count);
+  FindLiterals(n->right, found, count);
+}
+
+static void Literals() {
+  SymbolTable *st = NewSymbolTable();
+  AST_Node *root = Compile("intern_tests.c",
+                           "string a = \"a literal too long to be inline\";\n"
+                           "string b = \"a literal too long to be inline\";\n"
+                           "string c = \"inline\";\n",
+                           st);
+
+  Value found[3];
+  int count = 0;
+  FindLiterals(root, found, &count);
+  ASSERT(count == 3, GROUP);
+
+  ASSERT(!StringValueIsSmall(&found[0]) && StringIsInterned(found[0].as.string), GROUP);
+  ASSERT(found[0].as.string == found[1].as.string, GROUP);
+  ASSERT(StringValueIsSmall(&found[2]), GROUP);
+  ASSERT(StringValueLength(&found[2]) == 6, GROUP);
+
+  FreeAST(root);
+  DeleteSymbolTable(st);
+}
+
+void InternTests() {
+  Pool();
+  Growth();
+  Literals();
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,382 @@
+#include <stdio.h>  // for sprintf
+#include <string.h> // for memcmp, strlen
+
+#include "../src/compiler.h"
+#include "../src/interpreter.h"
+#include "../src/map.h"
+#include "../src/vec.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "interpreter.c"
+
+/* Compiles and runs 'source', leaving the run current so its globals
+ * can be read until Finish(). Any compile or runtime error exits, like
+ * it does for crom itself */
+static SymbolTable *Run(const char *source) {
+  SymbolTable *st = NewSymbolTable();
+  Interpret(Compile("interpreter_tests.c", source, st), st);
+
+  return st;
+}
+
+static Value Global(const char *name) {
+  Token t = { .type = IDENTIFIER, .position_in_source = name, .length = strlen(name) };
+  return RetrieveFrom(CurrentIsolate()->globals, t).value;
+}
+
+static void Finish(SymbolTable *st) {
+  FinishInterpreting(st);
+  DeleteSymbolTable(st);
+}
+
+static void Assignments() {
+  SymbolTable *st = Run(
+    "i64 x = 5;\n"
+    "i64 y = x * 3;\n"
+    "y += 1;\n"
+    "u8 wrapped = 255;\n"
+    "wrapped++;\n"
+    "i64[4] a = { 1, 2, 3, 4 };\n"
+    "a[2] = 30;\n"
+    "a[3] += 10;\n"
+    "i64 third = a[2];\n"
+    "i64 fourth = a[3];\n");
+
+  ASSERT(Global("x").as.integer == 5, GROUP);
+  ASSERT(Global("y").as.integer == 16, GROUP);
+  ASSERT(Global("wrapped").as.uinteger == 0, GROUP);
+  ASSERT(Global("third").as.integer == 30, GROUP);
+  ASSERT(Global("fourth").as.integer == 14, GROUP);
+
+  Finish(st);
+}
+
+static void SharedArrays() {
+  SymbolTable *st = Run(
+    "i64[3] a = { 1, 2, 3 };\n"
+    "i64[3] b = a;\n"
+    "b[0] = 10;\n"
+    "i64 a0 = a[0];\n"
+    "i64 b0 = b[0];\n");
+
+  ASSERT(Global("a0").as.integer == 1, GROUP);
+  ASSERT(Global("b0").as.integer == 10, GROUP);
+  ASSERT(Global("a").as.array != Global("b").as.array, GROUP);
+
+  Finish(st);
+}
+
+static void ControlFlow() {
+  SymbolTable *st = Run(
+    "i64 sum = 0;\n"
+    "for (i64 i = 0; i < 10; i++) {\n"
+    "  if (i == 3) { continue; }\n"
+    "  if (i == 8) { break; }\n"
+    "  sum += i;\n"
+    "}\n"
+    "i64 n = 0;\n"
+    "while (n < 100) {\n"
+    "  n += 7;\n"
+    "}\n"
+    "Square(i64 v) :: i64 {\n"
+    "  return v * v;\n"
+    "}\n"
+    "i64 squared = Square(n);\n");
+
+  ASSERT(Global("sum").as.integer == 0 + 1 + 2 + 4 + 5 + 6 + 7, GROUP);
+  ASSERT(Global("n").as.integer == 105, GROUP);
+  ASSERT(Global("squared").as.integer == 105 * 105, GROUP);
+
+  Finish(st);
+}
+
+static void Containers() {
+  SymbolTable *st = Run(
+    "map<i64, i64> squares;\n"
+    "for (i64 i = 0; i < 100; i++) {\n"
+    "  insert(squares, i, i * i);\n"
+    "}\n"
+    "bool removed = remove(squares, 10);\n"
+    "i64 nine = get(squares, 3);\n"
+    "vec<i64> v;\n"
+    "for (i64 i = 0; i < 50; i++) {\n"
+    "  push(v, i);\n"
+    "}\n"
+    "i64 last = pop(v);\n");
+
+  ASSERT(MapCount(Global("squares").as.map) == 99, GROUP);
+  ASSERT(Global("removed").as.boolean, GROUP);
+  ASSERT(Global("nine").as.integer == 9, GROUP);
+  ASSERT(VecCount(Global("v").as.vec) == 49, GROUP);
+  ASSERT(Global("last").as.integer == 49, GROUP);
+
+  Finish(st);
+}
+
+static void Strings() {
+  SymbolTable *st = Run(
+    "string s = \"\";\n"
+    "for (i64 i = 0; i < 100; i++) {\n"
+    "  s += \"ab\";\n"
+    "}\n"
+    "string greeting = \"hello\" + \", \" + \"world\";\n");
+
+  Value s = Global("s");
+  ASSERT(StringValueLength(&s) == 200, GROUP);
+  ASSERT(memcmp(StringValueData(&s), "abab", 4) == 0 && memcmp(StringValueData(&s) + 196, "abab", 4) == 0, GROUP);
+
+  Value greeting = Global("greeting");
+  ASSERT(StringValueLength(&greeting) == 12, GROUP);
+  ASSERT(memcmp(StringValueData(&greeting), "hello, world", 12) == 0, GROUP);
+
+  Finish(st);
+}
+
+static void Slices() {
+  SymbolTable *st = Run(
+    "Total(i64[] values) :: i64 {\n"
+    "  i64 total = 0;\n"
+    "  for (i64 i = 0; i < count(values); i++) {\n"
+    "    total += values[i];\n"
+    "  }\n"
+    "  return total;\n"
+    "}\n"
+    "i64[8] nums = { 1, 2, 3, 4, 5, 6, 7, 8 };\n"
+    "i64[..] middle = nums[2..6];\n"
+    "i64[..] inner = middle[1..3];\n"
+    "i64 first = inner[0];\n"
+    "i64 n = count(middle);\n"
+    "i64 middle_total = Total(middle);\n"
+    "i64 all_total = Total(nums);\n"
+    "nums[3] = 40;\n"
+    "i64 still = middle[1];\n"
+    "string greeting = \"hello, world\";\n"
+    "string word = greeting[7..];\n");
+
+  ASSERT(Global("first").as.integer == 4, GROUP);
+  ASSERT(Global("n").as.integer == 4, GROUP);
+  ASSERT(Global("middle_total").as.integer == 3 + 4 + 5 + 6, GROUP);
+  ASSERT(Global("all_total").as.integer == 36, GROUP);
+
+  // Writing to the array copies it, so the slice keeps the old elements
+  ASSERT(Global("still").as.integer == 4, GROUP);
+
+  Value word = Global("word");
+  ASSERT(StringValueLength(&word) == 5 && memcmp(StringValueData(&word), "world", 5) == 0, GROUP);
+
+  Finish(st);
+}
+
+static void RefParams() {
+  SymbolTable *st = Run(
+    "Scale(ref i64[] values, const ref i64 factor) :: void {\n"
+    "  values[0] = values[0] * factor;\n"
+    "  values[1] *= factor;\n"
+    "}\n"
+    "Bump(ref i64 counter) :: void {\n"
+    "  counter++;\n"
+    "  counter += 2;\n"
+    "}\n"
+    "Ignore(i64 copy) :: void {\n"
+    "  copy = 100;\n"
+    "}\n"
+    "i64[4] nums = { 1, 2, 3, 4 };\n"
+    "i64 k = 3;\n"
+    "Scale(nums, k);\n"
+    "Bump(k);\n"
+    "Ignore(k);\n"
+    "i64 n0 = nums[0];\n"
+    "i64 n1 = nums[1];\n"
+    "i64 n2 = nums[2];\n");
+
+  ASSERT(Global("n0").as.integer == 3, GROUP);
+  ASSERT(Global("n1").as.integer == 6, GROUP);
+  ASSERT(Global("n2").as.integer == 3, GROUP);
+  ASSERT(Global("k").as.integer == 6, GROUP);
+
+  Finish(st);
+}
+
+static void Atomics() {
+  SymbolTable *st = Run(
+    "atomic<i64> hits;\n"
+    "atomic<u32> flags;\n"
+    "i64 before = fetch_add(hits, 5, relaxed);\n"
+    "i64 after = load(hits, acquire);\n"
+    "store(hits, 10, release);\n"
+    "i64 seen = compare_exchange(hits, 10, 11, seq_cst);\n"
+    "i64 failed = compare_exchange(hits, 10, 12, seq_cst);\n"
+    "i64 now = load(hits, seq_cst);\n"
+    "u32 old = fetch_or(flags, 4, release);\n"
+    "u32 bits = load(flags, relaxed);\n");
+
+  ASSERT(Global("before").as.integer == 0, GROUP);
+  ASSERT(Global("after").as.integer == 5, GROUP);
+  ASSERT(Global("seen").as.integer == 10, GROUP);
+  ASSERT(Global("failed").as.integer == 11, GROUP);
+  ASSERT(Global("now").as.integer == 11, GROUP);
+  ASSERT(Global("old").as.uinteger == 0, GROUP);
+  ASSERT(Global("bits").as.uinteger == 4, GROUP);
+
+  Finish(st);
+}
+
+// Counts the nodes of one type in 'n', and how many of them have 'fact'
+static void CountFacts(AST_Node *n, NodeType type, NodeFact fact, int *nodes, int *with_fact) {
+  if (n == NULL) return;
+
+  if (n->node_type == type) {
+    (*nodes)++;
+    if (NodeHasFact(n, fact)) (*with_fact)++;
+  }
+
+  CountFacts(n->left, type, fact, nodes, with_fact);
+  CountFacts(n->middle, type, fact, nodes, with_fact);
+  CountFacts(n->right, type, fact, nodes, with_fact);
+}
+
+// Subscripts with FACT_IN_BOUNDS skip the runtime check, see CheckedSubscript()
+
+static void BoundsChecks() {
+  SymbolTable *st = NewSymbolTable();
+  AST_Node *root = Compile("interpreter_tests.c",
+    "i64[4] a = { 1, 2, 3, 4 };\n"
+    "i64 total = 0;\n"
+    "for (i64 i = 0; i < 4; i++) {\n"
+    "  total += a[i];\n"
+    "}\n"
+    "u8 w = 254;\n"
+    "u8 four = 4;\n"
+    "for (i64 n = 0; n < 3; n++) {\n"
+    "  w++;\n"
+    "}\n"
+    "i64 wrapped = 0;\n"
+    "if (w < four) {\n"
+    "  wrapped = a[w];\n"
+    "}\n", st);
+
+  // Only a[i] is proven, w could have wrapped around
+  int subscripts = 0, in_bounds = 0;
+  CountFacts(root, ARRAY_SUBSCRIPT_NODE, FACT_IN_BOUNDS, &subscripts, &in_bounds);
+  ASSERT(subscripts == 2, GROUP);
+  ASSERT(in_bounds == 1, GROUP);
+
+  Interpret(root, st);
+  ASSERT(Global("total").as.integer == 10, GROUP);
+  ASSERT(Global("wrapped").as.integer == 2, GROUP);
+
+  Finish(st);
+}
+
+// Local arrays go in the call frame, except ones made on every pass of a loop
+static void CallFrames() {
+  SymbolTable *st = NewSymbolTable();
+  AST_Node *root = Compile("interpreter_tests.c",
+    "Total(i64 passes) :: i64 {\n"
+    "  i64[4] first = { 1, 2, 3, 4 };\n"
+    "  i64 total = first[0];\n"
+    "  for (i64 i = 0; i < passes; i++) {\n"
+    "    i64[4] each = { 1, 2, 3, 4 };\n"
+    "    total += each[3];\n"
+    "  }\n"
+    "  return total;\n"
+    "}\n"
+    "i64 total = Total(1000);\n", st);
+
+  int assignments = 0, in_frame = 0;
+  CountFacts(root, ASSIGNMENT_NODE, FACT_NO_ESCAPE, &assignments, &in_frame);
+  ASSERT(in_frame == 1, GROUP);
+
+  Interpret(root, st);
+  ASSERT(Global("total").as.integer == 4001, GROUP);
+
+  Finish(st);
+}
+
+// More nested scopes and functions than isolates used to have room for
+static void ManyScopesAndFunctions() {
+  enum { DEPTH = 40, FUNCTIONS = 300 };
+  static char source[64 * (DEPTH + FUNCTIONS)];
+  int length = 0;
+
+  for (int i = 0; i < FUNCTIONS; i++) {
+    length += sprintf(&source[length], "F%d(i64 v) :: i64 { return v + %d; }\n", i, i);
+  }
+
+  length += sprintf(&source[length], "i64 last = F%d(1);\n", FUNCTIONS - 1);
+  length += sprintf(&source[length], "i64 deepest = 0;\n");
+  for (int i = 0; i < DEPTH; i++) length += sprintf(&source[length], "if (true) {\n");
+  length += sprintf(&source[length], "deepest = last;\n");
+  for (int i = 0; i < DEPTH; i++) length += sprintf(&source[length], "}\n");
+
+  SymbolTable *st = Run(source);
+  ASSERT(Global("deepest").as.integer == FUNCTIONS, GROUP);
+  ASSERT(CurrentIsolate()->function_count == FUNCTIONS, GROUP);
+
+  Finish(st);
+}
+
+// Declared without a value, arrays start out zero-filled
+static void DeclaredArrays() {
+  SymbolTable *st = Run(
+    "i64[4] a;\n"
+    "a[0] = 1;\n"
+    "i64 first = a[0];\n"
+    "i64 last = a[3];\n"
+    "u8[3] b;\n"
+    "i64 sum = 0;\n"
+    "for (i64 i = 0; i < 3; i++) {\n"
+    "  i64[2] local;\n"
+    "  local[1] = i;\n"
+    "  sum += local[1];\n"
+    "}\n");
+
+  ASSERT(Global("first").as.integer == 1, GROUP);
+  ASSERT(Global("last").as.integer == 0, GROUP);
+  ASSERT(Global("b").as.array->count == 3, GROUP);
+  ASSERT(Global("sum").as.integer == 0 + 1 + 2, GROUP);
+
+  Finish(st);
+}
+
+// A write through a 'ref' param lands in the caller's array, so the
+// calls allocate nothing the same program without them doesn't
+static void RefParamsWriteInPlace() {
+  const char *scale =
+    "Scale(ref i64[] values, const ref i64 factor) :: void {\n"
+    "  values[0] = values[0] * factor;\n"
+    "}\n"
+    "i64 k = 3;\n"
+    "i64[4] nums = { k, 2, 3, 4 };\n";
+  char source[512];
+
+  SymbolTable *st = Run(scale);
+  int64_t without_calls = GetHeapStats().allocations;
+  Finish(st);
+
+  sprintf(source, "%s%s", scale, "Scale(nums, k);\nScale(nums, k);\ni64 n0 = nums[0];\n");
+  st = Run(source);
+  ASSERT(Global("n0").as.integer == 27, GROUP);
+  ASSERT(TypeIs_Array(Global("nums").type) && !TypeIs_Slice(Global("nums").type), GROUP);
+  ASSERT(GetHeapStats().allocations == without_calls, GROUP);
+  Finish(st);
+}
+
+void InterpreterTests() {
+  Assignments();
+  SharedArrays();
+  ControlFlow();
+  Containers();
+  Strings();
+  Slices();
+  RefParams();
+  Atomics();
+  BoundsChecks();
+  CallFrames();
+  ManyScopesAndFunctions();
+  DeclaredArrays();
+  RefParamsWriteInPlace();
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,109 @@
+#include <pthread.h>
+#include <string.h> // for strlen
+
+#include "../src/compiler.h"
+#include "../src/interpreter.h"
+#include "../src/isolate.h"
+#include "../src/vec.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "isolate.c"
+
+#define THREADS 8
+#define RUNS_PER_THREAD 20
+
+// Writes globals and allocates on every run, so runs sharing anything would show
+static const char *source =
+  "i64 total = 0;\n"
+  "vec<i64> squares;\n"
+  "string s = \"a string long enough for the heap\";\n"
+  "for (i64 i = 0; i < 200; i++) {\n"
+  "  push(squares, i * i);\n"
+  "  total += i;\n"
+  "  s = s + \"!\";\n"
+  "}\n"
+  "i64 last = pop(squares);\n";
+
+static Value Global(Isolate *isolate, const char *name) {
+  Token t = { .type = IDENTIFIER, .position_in_source = name, .length = strlen(name) };
+  return RetrieveFrom(isolate->globals, t).value;
+}
+
+static bool RanToCompletion(Isolate *isolate) {
+  return Global(isolate, "total").as.integer == 199 * 200 / 2 &&
+         Global(isolate, "last").as.integer == 199 * 199 &&
+         VecCount(Global(isolate, "squares").as.vec) == 199;
+}
+
+static void Independent(const Program *program) {
+  Isolate *a = NewIsolate(program);
+  Isolate *b = NewIsolate(program);
+
+  ASSERT(a->globals != b->globals && a->heap != b->heap, GROUP);
+
+  RunIsolate(a);
+  ASSERT(RanToCompletion(a), GROUP);
+  ASSERT(CurrentIsolate() == NULL, GROUP);
+
+  // b hasn't run, so it still has the compile-time globals
+  ASSERT(Global(b, "total").as.integer == 0, GROUP);
+  ASSERT(Global(b, "squares").as.vec == NULL, GROUP);
+  ASSERT(IsolateBytes(a) > (int64_t)sizeof(Isolate), GROUP);
+
+  DeleteIsolate(a);
+
+  RunIsolate(b);
+  ASSERT(RanToCompletion(b), GROUP);
+  DeleteIsolate(b);
+}
+
+typedef struct {
+  const Program *program;
+  int completed;
+} Runner;
+
+static void *RunMany(void *arg) {
+  Runner *r = arg;
+
+  for (int i = 0; i < RUNS_PER_THREAD; i++) {
+    Isolate *isolate = NewIsolate(r->program);
+    RunIsolate(isolate);
+    if (RanToCompletion(isolate)) r->completed++;
+    DeleteIsolate(isolate);
+  }
+
+  return NULL;
+}
+
+static void Concurrent(const Program *program) {
+  Runner runners[THREADS];
+  pthread_t threads[THREADS];
+
+  for (int i = 0; i < THREADS; i++) {
+    runners[i] = (Runner){ .program = program };
+    pthread_create(&threads[i], NULL, RunMany, &runners[i]);
+  }
+
+  int completed = 0;
+  for (int i = 0; i < THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    completed += runners[i].completed;
+  }
+
+  ASSERT(completed == THREADS * RUNS_PER_THREAD, GROUP);
+}
+
+void IsolateTests() {
+  SymbolTable *st = NewSymbolTable();
+  Program program = NewProgram(Compile("isolate_tests.c", source, st), st);
+  ASSERT(program.node_count > 0, GROUP);
+
+  Independent(&program);
+  Concurrent(&program);
+
+  FreeAST(program.root);
+  DeleteSymbolTable(st);
+
+  PrintAssertionResults(GROUP);
+}
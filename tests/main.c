@@ -7,17 +7,21 @@
 #include "../src/common.h"
 #include "assert.h"
 #include "test_io.h"
+#include "unit_tests.h"
 
 void RunTest(char *compiler_path, char *test_path, char *file_name, char *group_name) {
-  char *partial_command = Concat(compiler_path, " ");
-  char *full_command = Concat(partial_command, test_path);
+  StringBuilder command = NewStringBuilder(0);
+  AppendString(&command, compiler_path);
+  AppendChar(&command, ' ');
+  AppendString(&command, test_path);
 
   errno = 0;
-  int result = system(full_command);
+  int result = system(command.data);
   if (errno != 0) {
     printf("RunTest(): Non-zero ERRNO running test '%s': %s\n", test_path, strerror(errno));
     exit(256);
   }
+  FreeStringBuilder(&command);
 
   if (result == -1) {
     printf("RunTest(): Child process could not be created\n");
@@ -50,4 +54,16 @@ int main() {
 
     PrintAssertionResults(group_name);
   }
+
+  SymbolTableTests();
+  HeapTests();
+  ValueTests();
+  StrTests();
+  InternTests();
+  SimdTests();
+  MapTests();
+  VecTests();
+  ChanTests();
+  InterpreterTests();
+  IsolateTests();
 }
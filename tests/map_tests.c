@@ -0,0 +1,158 @@
+#include "../src/heap.h"
+#include "../src/map.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "map.c"
+
+static int64_t GetInt(MapValue *m, int64_t key) {
+  Value value = {0};
+  if (!MapGet(m, NewIntValue(key), &value)) return -1;
+
+  return value.as.integer;
+}
+
+static void InsertAndGet() {
+  MapValue *m = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&m->header);
+
+  ASSERT(MapCount(m) == 0, GROUP);
+  ASSERT(!MapContains(m, NewIntValue(1)), GROUP);
+
+  MapInsert(m, NewIntValue(1), NewIntValue(10));
+  MapInsert(m, NewIntValue(2), NewIntValue(20));
+  ASSERT(MapCount(m) == 2, GROUP);
+  ASSERT(GetInt(m, 1) == 10, GROUP);
+  ASSERT(GetInt(m, 2) == 20, GROUP);
+  ASSERT(GetInt(m, 3) == -1, GROUP);
+
+  // Inserting a key that's there replaces its value in place
+  MapInsert(m, NewIntValue(1), NewIntValue(11));
+  ASSERT(MapCount(m) == 2, GROUP);
+  ASSERT(GetInt(m, 1) == 11, GROUP);
+
+  // Entries stay in insertion order
+  ASSERT(MapKeyAt(m, 0).as.integer == 1, GROUP);
+  ASSERT(MapValueAt(m, 1).as.integer == 20, GROUP);
+
+  Release(&m->header);
+}
+
+static void Remove() {
+  MapValue *m = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&m->header);
+
+  for (int64_t i = 0; i < 5; i++) MapInsert(m, NewIntValue(i), NewIntValue(i * 10));
+
+  ASSERT(MapRemove(m, NewIntValue(1)), GROUP);
+  ASSERT(!MapRemove(m, NewIntValue(1)), GROUP);
+  ASSERT(MapCount(m) == 4, GROUP);
+  ASSERT(!MapContains(m, NewIntValue(1)), GROUP);
+
+  // The last entry moved into the hole and can still be found
+  ASSERT(MapKeyAt(m, 1).as.integer == 4, GROUP);
+  ASSERT(GetInt(m, 4) == 40, GROUP);
+  ASSERT(GetInt(m, 3) == 30, GROUP);
+
+  ASSERT(!MapRemove(NULL, NewIntValue(1)), GROUP);
+
+  Release(&m->header);
+}
+
+static void Growth() {
+  MapValue *m = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&m->header);
+
+  const int64_t count = 10000;
+  for (int64_t i = 0; i < count; i++) MapInsert(m, NewIntValue(i * 7), NewIntValue(i));
+
+  ASSERT(MapCount(m) == count, GROUP);
+  ASSERT(m->capacity - m->capacity / 8 >= count, GROUP);
+  ASSERT(m->capacity % MAP_GROUP_WIDTH == 0, GROUP);
+
+  bool all_found = true;
+  for (int64_t i = 0; i < count; i++) all_found &= GetInt(m, i * 7) == i;
+  ASSERT(all_found, GROUP);
+  ASSERT(!MapContains(m, NewIntValue(count * 7)), GROUP);
+
+  // Reserving up front means inserting never rehashes
+  MapValue *reserved = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&reserved->header);
+
+  MapReserve(reserved, 1000);
+  int64_t capacity = reserved->capacity;
+  for (int64_t i = 0; i < 1000; i++) MapInsert(reserved, NewIntValue(i), NewIntValue(i));
+  ASSERT(reserved->capacity == capacity, GROUP);
+
+  Release(&reserved->header);
+  Release(&m->header);
+}
+
+static void TombstoneReuse() {
+  MapValue *m = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&m->header);
+
+  // Under half full, so a table of mostly deleted slots is rebuilt in place
+  const int64_t live = 100;
+  MapReserve(m, 2 * live);
+  int64_t capacity = m->capacity;
+
+  for (int64_t i = 0; i < live; i++) MapInsert(m, NewIntValue(i), NewIntValue(i));
+
+  // Always the same number of keys, but never the same key twice: the
+  // deleted slots have to be cleaned up instead of growing the table
+  for (int64_t i = live; i < 100 * live; i++) {
+    MapRemove(m, NewIntValue(i - live));
+    MapInsert(m, NewIntValue(i), NewIntValue(i));
+  }
+
+  ASSERT(MapCount(m) == live, GROUP);
+  ASSERT(m->capacity == capacity, GROUP);
+
+  bool all_found = true;
+  for (int64_t i = 99 * live; i < 100 * live; i++) all_found &= GetInt(m, i) == i;
+  ASSERT(all_found, GROUP);
+  ASSERT(!MapContains(m, NewIntValue(0)), GROUP);
+
+  Release(&m->header);
+}
+
+static void CopyOnWrite() {
+  MapValue *m = NewMapValue(NewMapType(NewType(I64), NewType(I64)));
+  Retain(&m->header);
+  MapInsert(m, NewIntValue(1), NewIntValue(1));
+
+  Retain(&m->header);
+  ASSERT(MapIsShared(m), GROUP);
+
+  MapValue *copy = CopyMapValue(m);
+  Retain(&copy->header);
+  Release(&m->header);
+
+  MapInsert(copy, NewIntValue(2), NewIntValue(2));
+  ASSERT(MapCount(copy) == 2, GROUP);
+  ASSERT(MapCount(m) == 1, GROUP);
+  ASSERT(!MapIsShared(m), GROUP);
+
+  Release(&copy->header);
+  Release(&m->header);
+}
+
+void MapTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  InsertAndGet();
+  Remove();
+  Growth();
+  TombstoneReuse();
+  CopyOnWrite();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,144 @@
+#include "../src/heap.h"
+#include "../src/simd.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "simd.c"
+
+// Enough for every kernel's vector loop and its scalar tail
+#define MAX_COUNT 67
+
+static Value NewArray(TokenType element, int64_t count) {
+  Type type = NewArrayType(element, count);
+  return (Value){ .type = type, .as.array = NewArrayValue(type.specifier, count) };
+}
+
+static Value Ints(int64_t count, int64_t scale, int64_t offset) {
+  Value v = NewArray(I32, count);
+  for (int64_t i = 0; i < count; i++) ArraySet(v.as.array, i, NewIntValue(i * scale + offset));
+
+  return v;
+}
+
+static Value Bytes(int64_t count, uint64_t scale) {
+  Value v = NewArray(U8, count);
+  for (int64_t i = 0; i < count; i++) ArraySet(v.as.array, i, NewUintValue((uint64_t)i * scale));
+
+  return v;
+}
+
+static Value Floats(int64_t count, double scale) {
+  Value v = NewArray(F64, count);
+  for (int64_t i = 0; i < count; i++) ArraySet(v.as.array, i, NewFloatValue(i * scale));
+
+  return v;
+}
+
+static int64_t IntAt(Value v, int64_t i) {
+  return ArrayGet(v.as.array, i).as.integer;
+}
+
+static uint64_t UintAt(Value v, int64_t i) {
+  return ArrayGet(v.as.array, i).as.uinteger;
+}
+
+// Every count up to MAX_COUNT, checked against plain C arithmetic
+static bool KernelsAgree() {
+  bool agree = true;
+
+  for (int64_t n = 1; n <= MAX_COUNT; n++) {
+    Value a = Ints(n, 3, -50);
+    Value b = Ints(n, 1, 1);
+
+    Value sum = ElementWise(PLUS, a, b);
+    Value difference = ElementWise(MINUS, a, b);
+    Value product = ElementWise(ASTERISK, a, b);
+    Value quotient = ElementWise(DIVIDE, a, b);
+    Value remainder = ElementWise(MODULO, a, b);
+    Value less = ElementWise(LESS_THAN, a, b);
+    Value scaled = ElementWise(ASTERISK, NewIntValue(2), a);
+    for (int64_t i = 0; i < n; i++) {
+      int32_t x = IntAt(a, i), y = IntAt(b, i);
+      agree &= IntAt(sum, i) == x + y;
+      agree &= IntAt(difference, i) == x - y;
+      agree &= IntAt(product, i) == x * y;
+      agree &= IntAt(quotient, i) == x / y;
+      agree &= IntAt(remainder, i) == x % y;
+      agree &= ArrayGet(less.as.array, i).as.boolean == (x < y);
+      agree &= IntAt(scaled, i) == 2 * x;
+    }
+
+    // u8 lanes wrap
+    Value bytes = Bytes(n, 37);
+    Value wrapped = ElementWise(PLUS, bytes, bytes);
+    for (int64_t i = 0; i < n; i++) agree &= UintAt(wrapped, i) == (uint8_t)(2 * (uint8_t)(i * 37));
+
+    Value f = Floats(n, 0.5);
+    Value halved = ElementWise(DIVIDE, f, NewFloatValue(2.0));
+    for (int64_t i = 0; i < n; i++) agree &= ArrayGet(halved.as.array, i).as.floating == i * 0.25;
+
+    int64_t expected = 0;
+    for (int64_t i = 0; i < n; i++) expected += i * 3 - 50;
+    agree &= Reduce(BUILTIN_SUM, a).as.integer == expected;
+    agree &= Reduce(BUILTIN_MIN, a).as.integer == -50;
+    agree &= Reduce(BUILTIN_MAX, a).as.integer == (n - 1) * 3 - 50;
+
+    ReleaseTemporaries(0);
+  }
+
+  return agree;
+}
+
+static void Levels() {
+  SimdLevel supported = ActiveSimdLevel();
+
+  for (SimdLevel level = SIMD_SCALAR; level < SIMD_LEVEL_COUNT; level++) {
+    SetSimdLevel(level);
+    ASSERT(ActiveSimdLevel() == ((level < supported) ? level : supported), GROUP);
+    ASSERT(KernelsAgree(), GROUP);
+  }
+
+  SetSimdLevel(supported);
+}
+
+static void Slices() {
+  Value a = Ints(10, 1, 0);
+  Value slice = { .type = NewSliceType(NewType(I32)), .as.slice = { .base = a.as.array, .offset = 2, .count = 5 } };
+
+  ASSERT(Reduce(BUILTIN_SUM, slice).as.integer == 2 + 3 + 4 + 5 + 6, GROUP);
+  ASSERT(Reduce(BUILTIN_MIN, slice).as.integer == 2, GROUP);
+  ASSERT(Reduce(BUILTIN_MAX, slice).as.integer == 6, GROUP);
+}
+
+static void Vectors() {
+  Type i32x4 = NewVectorType(NewType(I32), 4);
+  Value a = Ints(10, 10, 0);
+
+  Value lanes = LoadVector(a, 3, i32x4);
+  ASSERT(lanes.as.array->count == 4, GROUP);
+  ASSERT(IntAt(lanes, 0) == 30 && IntAt(lanes, 3) == 60, GROUP);
+
+  Value order = Ints(4, -1, 3);
+  Value reversed = Shuffle(lanes, order);
+  ASSERT(IntAt(reversed, 0) == 60 && IntAt(reversed, 3) == 30, GROUP);
+
+  StoreVector(a.as.array, 0, reversed);
+  ASSERT(IntAt(a, 0) == 60 && IntAt(a, 3) == 30 && IntAt(a, 4) == 40, GROUP);
+}
+
+void SimdTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  Levels();
+  Slices();
+  Vectors();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,109 @@
+#include <string.h> // for memcmp, memset
+
+#include "../src/heap.h"
+#include "../src/str.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "str.c"
+
+static bool HasContents(String *s, const char *chars, int64_t length) {
+  return StringLength(s) == length && memcmp(StringData(s), chars, length) == 0;
+}
+
+static void Lengths() {
+  String *s = NewStringFrom("a\0b", 3);
+  ASSERT(StringLength(s) == 3, GROUP);
+  ASSERT(StringData(s)[1] == '\0' && StringData(s)[3] == '\0', GROUP);
+
+  ASSERT(s->hash == 0, GROUP);
+  ASSERT(StringHash(s) == HashChars("a\0b", 3), GROUP);
+  ASSERT(s->hash == HashChars("a\0b", 3), GROUP);
+}
+
+static void Concatenation() {
+  // Appending in a loop builds a rope, read back in order
+  char expected[2000];
+  String *s = NewStringFrom("", 0);
+  for (int i = 0; i < 2000; i++) {
+    expected[i] = 'a' + i % 26;
+    s = StringAppend(s, &expected[i], 1);
+  }
+
+  ASSERT(StringLength(s) == 2000, GROUP);
+  ASSERT(!StringIsFlat(s), GROUP);
+  ASSERT(HasContents(s, expected, 2000), GROUP);
+  ASSERT(StringIsFlat(s), GROUP);
+
+  String *left = NewStringFrom(expected, 100);
+  String *right = NewStringFrom(expected + 100, 100);
+  ASSERT(HasContents(StringConcat(left, right), expected, 200), GROUP);
+  ASSERT(StringConcat(NewStringFrom("", 0), right) == right, GROUP);
+}
+
+static void Slices() {
+  String *s = NewStringFrom("hello, world", 12);
+  String *world = StringSlice(s, 7, 5);
+  ASSERT(HasContents(world, "world", 5), GROUP);
+  ASSERT(world->left == s, GROUP);
+
+  // A slice of a slice points into the same original
+  String *orl = StringSlice(world, 1, 3);
+  ASSERT(HasContents(orl, "orl", 3), GROUP);
+  ASSERT(orl->left == s, GROUP);
+}
+
+static void Comparisons() {
+  String *a = NewStringFrom("apple", 5);
+  String *b = NewStringFrom("apples", 6);
+  String *c = NewStringFrom("apple", 5);
+
+  ASSERT(StringsEqual(a, c), GROUP);
+  ASSERT(!StringsEqual(a, b), GROUP);
+  ASSERT(StringCompare(a, b) < 0 && StringCompare(b, a) > 0, GROUP);
+  ASSERT(StringCompare(a, c) == 0, GROUP);
+}
+
+// Needles and matches on either side of the 16 byte blocks the search compares
+static void Find() {
+  char haystack[100];
+  memset(haystack, '.', sizeof(haystack));
+
+  bool all_found = true;
+  for (int at = 0; at + 3 <= 100; at++) {
+    memcpy(haystack + at, "abc", 3);
+    all_found &= FindChars(haystack, 100, "abc", 3) == at;
+    all_found &= FindChars(haystack, 100, "c", 1) == at + 2;
+    memset(haystack + at, '.', 3);
+  }
+  ASSERT(all_found, GROUP);
+
+  ASSERT(FindChars(haystack, 100, "abc", 3) == -1, GROUP);
+  ASSERT(FindChars(haystack, 100, "", 0) == 0, GROUP);
+  ASSERT(FindChars("ab", 2, "abc", 3) == -1, GROUP);
+
+  String *s = NewStringFrom("the cat sat on the mat", 22);
+  ASSERT(StringFind(s, NewStringFrom("mat", 3)) == 19, GROUP);
+  ASSERT(StringContains(s, NewStringFrom("sat", 3)), GROUP);
+  ASSERT(!StringContains(s, NewStringFrom("dog", 3)), GROUP);
+}
+
+void StrTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  Lengths();
+  Concatenation();
+  Slices();
+  Comparisons();
+  Find();
+
+  // Nothing above was retained, so it's all temporaries
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,38 @@
+#include <string.h> // for strlen
+
+#include "../src/symbol_table.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "symbol_table.c"
+
+static Token Identifier(const char *name) {
+  return (Token){ .type = IDENTIFIER, .position_in_source = name, .length = strlen(name) };
+}
+
+void SymbolTableTests() {
+  SymbolTable *st = NewSymbolTable();
+  Token x = Identifier("x");
+
+  AddTo(st, NewSymbol(x, NewType(I64), DECL_DECLARED));
+  ASSERT(RetrieveFrom(st, x).value.as.integer == 0, GROUP);
+
+  SetSymbolValue(st, x, NewIntValue(5));
+  ASSERT(RetrieveFrom(st, x).value.as.integer == 5, GROUP);
+
+  // Redeclaring it keeps the value it was given
+  AddTo(st, NewSymbol(x, NewType(I64), DECL_DEFINED));
+  ASSERT(RetrieveFrom(st, x).value.as.integer == 5, GROUP);
+  ASSERT(DEFINED(RetrieveFrom(st, x)), GROUP);
+
+  SetSymbolValue(st, x, NewIntValue(-7));
+  ASSERT(RetrieveFrom(st, x).value.as.integer == -7, GROUP);
+
+  Symbol missing = SetSymbolValue(st, Identifier("y"), NewIntValue(1));
+  ASSERT(!IN_SYMBOL_TABLE(missing), GROUP);
+  ASSERT(!IsIn(st, Identifier("y")), GROUP);
+
+  DeleteSymbolTable(st);
+
+  PrintAssertionResults(GROUP);
+}
@@ -42,11 +42,12 @@ static char *BuildTestsFullPath() {
 }
 
 static char *ConcatPath(char *a, char *b) {
-  char *path = Concat(a, "/");
-  char *full_path = Concat(path, b);
+  StringBuilder sb = NewStringBuilder(strlen(a) + strlen(b) + 2);
+  AppendString(&sb, a);
+  AppendChar(&sb, '/');
+  AppendString(&sb, b);
 
-  free(path);
-  return full_path;
+  return BuildString(&sb);
 }
 
 static struct Filepaths Folders(char *dir_path) {
@@ -0,0 +1,19 @@
+#ifndef UNIT_TESTS_H
+#define UNIT_TESTS_H
+
+/* Tests that call into the runtime directly instead of running a .crom
+ * file. Each runs its assertions under its own group, named after the
+ * file it tests, and prints the results */
+void SymbolTableTests();
+void HeapTests();
+void ValueTests();
+void StrTests();
+void InternTests();
+void SimdTests();
+void MapTests();
+void VecTests();
+void ChanTests();
+void InterpreterTests();
+void IsolateTests();
+
+#endif
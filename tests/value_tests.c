@@ -0,0 +1,127 @@
+#include <string.h> // for memcmp
+
+#include "../src/heap.h"
+#include "../src/str.h"
+#include "../src/value.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "value.c"
+
+static void PackedArrays() {
+  ArrayValue *bytes = NewArrayValue(T_U8, 5);
+  ASSERT(bytes->element_size == 1, GROUP);
+  ASSERT(ArrayValueSize(T_U8, 5) == sizeof(ArrayValue) + 5, GROUP);
+
+  ArraySet(bytes, 4, NewUintValue(255));
+  ASSERT(bytes->elements[4] == 255, GROUP);
+  ASSERT(ArrayGet(bytes, 4).as.uinteger == 255, GROUP);
+  ASSERT(ArrayGet(bytes, 3).as.uinteger == 0, GROUP);
+
+  // Stored at the element's width, so it wraps the same way the type does
+  ArraySet(bytes, 0, NewUintValue(257));
+  ASSERT(ArrayGet(bytes, 0).as.uinteger == 1, GROUP);
+
+  ArrayValue *shorts = NewArrayValue(T_I16, 3);
+  ASSERT(shorts->element_size == 2, GROUP);
+  ArraySet(shorts, 1, NewIntValue(-2));
+  ASSERT(ArrayGet(shorts, 1).as.integer == -2, GROUP);
+
+  ArrayValue *doubles = NewArrayValue(T_F64, 2);
+  ASSERT(doubles->element_size == 8, GROUP);
+  ArraySet(doubles, 1, NewFloatValue(0.125));
+  ASSERT(ArrayGet(doubles, 1).as.floating == 0.125, GROUP);
+
+  ArrayValue *bools = NewArrayValue(T_BOOL, 2);
+  ArraySet(bools, 0, NewBoolValue(true));
+  ASSERT(ArrayGet(bools, 0).as.boolean && !ArrayGet(bools, 1).as.boolean, GROUP);
+
+  // String elements are held by the array
+  ArrayValue *strings = NewArrayValue(T_STRING, 2);
+  Retain(&strings->header);
+  String *s = NewStringFrom("held by the array", 17);
+  ArraySet(strings, 0, NewStringValue(s));
+  ASSERT(s->header.refcount == 1, GROUP);
+  ASSERT(ArrayGet(strings, 1).as.string == NULL, GROUP);
+  Release(&strings->header);
+}
+
+static void SmallStrings() {
+  Value inline_value = NewStringValueFrom("fifteen bytes!!", 15);
+  ASSERT(StringValueIsSmall(&inline_value), GROUP);
+  ASSERT(StringValueLength(&inline_value) == 15, GROUP);
+  ASSERT(memcmp(StringValueData(&inline_value), "fifteen bytes!!", 15) == 0, GROUP);
+
+  int64_t allocations = GetHeapStats().allocations;
+  Value empty = NewStringValueFrom("", 0);
+  ASSERT(StringValueIsSmall(&empty) && StringValueLength(&empty) == 0, GROUP);
+  ASSERT(GetHeapStats().allocations == allocations, GROUP);
+
+  Value heap_value = NewStringValueFrom("sixteen bytes!!!", 16);
+  ASSERT(!StringValueIsSmall(&heap_value), GROUP);
+  ASSERT(StringValueLength(&heap_value) == 16, GROUP);
+
+  // Copied out when something needs a String
+  String *s = HeapString(inline_value);
+  ASSERT(StringLength(s) == 15 && memcmp(StringData(s), "fifteen bytes!!", 15) == 0, GROUP);
+  ASSERT(HeapString(heap_value) == heap_value.as.string, GROUP);
+
+  Value needle = NewStringValueFrom("bytes", 5);
+  ASSERT(StringValueFind(&inline_value, &needle) == 8, GROUP);
+  ASSERT(StringValueFind(&heap_value, &needle) == 8, GROUP);
+}
+
+static void CopyOnWrite() {
+  ArrayValue *a = NewArrayValue(T_I64, 3);
+  Retain(&a->header);
+  ASSERT(!ArrayIsShared(a), GROUP);
+
+  // A second variable shares it
+  Retain(&a->header);
+  ASSERT(ArrayIsShared(a), GROUP);
+
+  // and the first write through either one copies it
+  ArrayValue *b = CopyArrayValue(a);
+  Retain(&b->header);
+  Release(&a->header);
+  ArraySet(b, 0, NewIntValue(10));
+
+  ASSERT(!ArrayIsShared(a) && !ArrayIsShared(b), GROUP);
+  ASSERT(ArrayGet(a, 0).as.integer == 0 && ArrayGet(b, 0).as.integer == 10, GROUP);
+
+  // Copies hold their own reference to each string element
+  ArrayValue *strings = NewArrayValue(T_STRING, 1);
+  Retain(&strings->header);
+  String *s = NewStringFrom("shared by both copies", 21);
+  ArraySet(strings, 0, NewStringValue(s));
+
+  ArrayValue *copy = CopyArrayValue(strings);
+  Retain(&copy->header);
+  ASSERT(s->header.refcount == 2, GROUP);
+
+  // Still a temporary of this statement until it ends
+  Release(&strings->header);
+  ReleaseTemporaries(0);
+  ASSERT(s->header.refcount == 1, GROUP);
+
+  Release(&copy->header);
+  Release(&b->header);
+  Release(&a->header);
+}
+
+void ValueTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  PackedArrays();
+  SmallStrings();
+  CopyOnWrite();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}
@@ -0,0 +1,144 @@
+#include <string.h> // for memcmp
+
+#include "../src/heap.h"
+#include "../src/vec.h"
+#include "assert.h"
+#include "unit_tests.h"
+
+#define GROUP "vec.c"
+
+static VecValue *NewI64Vec() {
+  VecValue *v = NewVecValue(NewVecType(NewType(I64)));
+  Retain(&v->header);
+
+  return v;
+}
+
+static void PushAndPop() {
+  VecValue *v = NewI64Vec();
+  ASSERT(VecCount(v) == 0, GROUP);
+  ASSERT(VecCapacity(v) == 0, GROUP);
+
+  VecPush(v, NewIntValue(1));
+  VecPush(v, NewIntValue(2));
+  VecPush(v, NewIntValue(3));
+  ASSERT(VecCount(v) == 3, GROUP);
+  ASSERT(VecGet(v, 0).as.integer == 1, GROUP);
+  ASSERT(VecGet(v, 2).as.integer == 3, GROUP);
+
+  VecSet(v, 1, NewIntValue(20));
+  ASSERT(VecGet(v, 1).as.integer == 20, GROUP);
+
+  ASSERT(VecPop(v).as.integer == 3, GROUP);
+  ASSERT(VecPop(v).as.integer == 20, GROUP);
+  ASSERT(VecCount(v) == 1, GROUP);
+
+  // Popped slots are zeroed, so pushing again starts clean
+  VecPush(v, NewIntValue(4));
+  ASSERT(VecGet(v, 1).as.integer == 4, GROUP);
+
+  // Never written to, which every read treats as empty
+  ASSERT(VecCount(NULL) == 0, GROUP);
+  ASSERT(VecCapacity(NULL) == 0, GROUP);
+
+  Release(&v->header);
+}
+
+static void Growth() {
+  VecValue *v = NewI64Vec();
+
+  const int64_t count = 10000;
+  int64_t reallocations = 0;
+  int64_t capacity = 0;
+  for (int64_t i = 0; i < count; i++) {
+    VecPush(v, NewIntValue(i));
+
+    if (VecCapacity(v) != capacity) {
+      ASSERT(capacity == 0 || VecCapacity(v) == 2 * capacity, GROUP);
+      capacity = VecCapacity(v);
+      reallocations++;
+    }
+  }
+
+  ASSERT(VecCount(v) == count, GROUP);
+  ASSERT(VecCapacity(v) >= count && VecCapacity(v) < 2 * count, GROUP);
+  ASSERT(reallocations < 16, GROUP);
+
+  bool all_kept = true;
+  for (int64_t i = 0; i < count; i++) all_kept &= VecGet(v, i).as.integer == i;
+  ASSERT(all_kept, GROUP);
+
+  VecShrink(v);
+  ASSERT(VecCapacity(v) == count, GROUP);
+  ASSERT(VecGet(v, count - 1).as.integer == count - 1, GROUP);
+
+  while (VecCount(v) > 0) VecPop(v);
+  VecShrink(v);
+  ASSERT(VecCapacity(v) == 0, GROUP);
+
+  VecReserve(v, 100);
+  ASSERT(VecCapacity(v) == 100, GROUP);
+  ASSERT(VecCount(v) == 0, GROUP);
+
+  Release(&v->header);
+}
+
+static void SharedStorage() {
+  ArrayValue *array = NewArrayValue(T_I64, 3);
+  for (int64_t i = 0; i < 3; i++) ArraySet(array, i, NewIntValue(i));
+  Retain(&array->header);
+
+  // to_vec() hands over the array's storage without copying
+  VecValue *v = ArrayToVec(array);
+  Retain(&v->header);
+  ASSERT(v->storage == array, GROUP);
+
+  // and the first write copies it, so the array keeps its elements
+  VecSet(v, 0, NewIntValue(100));
+  ASSERT(v->storage != array, GROUP);
+  ASSERT(ArrayGet(array, 0).as.integer == 0, GROUP);
+  ASSERT(VecGet(v, 0).as.integer == 100, GROUP);
+
+  // A vec that's exactly full gives its storage back to to_array()
+  ASSERT(VecToArray(v, NewVecType(NewType(I64))) == v->storage, GROUP);
+
+  VecPush(v, NewIntValue(3));
+  ArrayValue *copy = VecToArray(v, NewVecType(NewType(I64)));
+  ASSERT(copy != v->storage && copy->count == 4, GROUP);
+  ASSERT(ArrayGet(copy, 3).as.integer == 3, GROUP);
+
+  Release(&v->header);
+  Release(&array->header);
+}
+
+static void Strings() {
+  VecValue *v = NewVecValue(NewVecType(NewType(STRING)));
+  Retain(&v->header);
+
+  for (int i = 0; i < 100; i++) VecPush(v, NewStringValueFrom("a string that isn't small", 25));
+
+  Value popped = VecPop(v);
+  ASSERT(StringValueLength(&popped) == 25, GROUP);
+  ASSERT(memcmp(StringValueData(&popped), "a string that isn't small", 25) == 0, GROUP);
+  ASSERT(VecCount(v) == 99, GROUP);
+
+  Release(&v->header);
+}
+
+void VecTests() {
+  HeapState *heap = NewHeapState();
+  HeapState *previous = UseHeapState(heap);
+
+  PushAndPop();
+  Growth();
+  SharedStorage();
+  Strings();
+
+  ReleaseTemporaries(0);
+  ASSERT(GetHeapStats().live_bytes == 0, GROUP);
+
+  UseHeapState(previous);
+  DeleteHeapState(heap);
+
+  PrintAssertionResults(GROUP);
+}